@@ -59,6 +59,9 @@ extern "C" {
 /** A hash of the component identifiers in a type. */
 typedef uint32_t ecs_type_t;
 
+/** Handle to a system that runs asynchronously on worker threads. */
+typedef uint32_t ecs_async_t;
+
 /** Id component type */
 typedef const char *EcsId;
 
@@ -111,10 +114,50 @@ typedef struct ecs_rows_t {
     ecs_entity_t interrupted_by; /* When set, system execution is interrupted */
 } ecs_rows_t;
 
+/** A query iterates the entities that match a signature, without a system */
+typedef struct ecs_query_t ecs_query_t;
+
+/** Iterator for the entities matched by a query */
+typedef struct ecs_query_iter_t {
+    ecs_query_t *query;       /* Query that is iterated */
+    uint32_t table;           /* Current table (index + 1) */
+    uint32_t row;             /* Next row to yield in current table */
+    uint32_t end;             /* Number of rows in current table */
+    bool sorted;              /* Iterate in the sorted order of the query */
+    ecs_rows_t rows;          /* Rows yielded by ecs_query_next */
+} ecs_query_iter_t;
+
 /** System action callback type */
 typedef void (*ecs_system_action_t)(
     ecs_rows_t *data);
 
+/** Compare callback used for sorting. Returns a negative number, zero or a
+ * positive number if the first value is less than, equal to or greater than
+ * the second value. */
+typedef int (*ecs_compare_action_t)(
+    ecs_entity_t e1,
+    void *ptr1,
+    ecs_entity_t e2,
+    void *ptr2);
+
+/** Callback that submits the jobs of worker threads to an external scheduler */
+typedef void (*ecs_scheduler_submit_t)(
+    ecs_world_t *world,
+    uint32_t thread_count,
+    void *ctx);
+
+/** Callback that waits until an external scheduler has ran submitted jobs */
+typedef void (*ecs_scheduler_wait_t)(
+    ecs_world_t *world,
+    void *ctx);
+
+/** External scheduler that runs jobs instead of the builtin worker threads. */
+typedef struct ecs_scheduler_t {
+    ecs_scheduler_submit_t submit; /* Schedule ecs_run_scheduled per thread */
+    ecs_scheduler_wait_t wait;     /* Optional, block until jobs have finished */
+    void *ctx;                     /* Passed to submit and wait */
+} ecs_scheduler_t;
+
 /** Initialization function signature of modules */
 typedef void (*ecs_module_init_action_t)(
     ecs_world_t *world,
@@ -358,6 +401,42 @@ void ecs_set_automerge(
     ecs_world_t *world,
     bool auto_merge);
 
+/** Set whether OnAdd and OnSet notifications should be deferred.
+ * By default, OnAdd and OnSet row systems are invoked as soon as a component is
+ * added or set. When adding or setting components on many entities outside of
+ * ecs_progress, this invokes row systems once per entity.
+ *
+ * When deferring is enabled, notifications are queued until ecs_flush_events is
+ * called, or until the next call to ecs_progress. Notifications that are
+ * queued by systems while in progress are delivered after the stages of the
+ * phase are merged, before the next phase runs. When automerging is disabled,
+ * they are queued when ecs_merge is called. A notification is queued
+ * once per entity, so an entity that is set multiple times is only passed to
+ * OnSet systems once. Upon delivery, entities are sorted by table, and adjacent
+ * entities are passed to row systems in a single invocation.
+ *
+ * Notifications for entities that have been deleted are not delivered. When
+ * deferring is disabled, queued notifications are delivered.
+ *
+ * @param world The world.
+ * @param defer When true, OnAdd and OnSet notifications are deferred.
+ */
+FLECS_EXPORT
+void ecs_set_defer_events(
+    ecs_world_t *world,
+    bool defer);
+
+/** Deliver deferred OnAdd and OnSet notifications.
+ * This operation invokes row systems for the notifications that were queued
+ * while deferring was enabled. OnAdd systems are invoked before OnSet systems.
+ * This operation may not be called while the world is being progressed.
+ *
+ * @param world The world.
+ */
+FLECS_EXPORT
+void ecs_flush_events(
+    ecs_world_t *world);
+
 /** Set number of worker threads.
  * This operation sets the number of worker threads to which to distribute the
  * processing load. If this function is called multiple times, the total number
@@ -378,6 +457,44 @@ void ecs_set_threads(
     ecs_world_t *world,
     uint32_t threads);
 
+/** Run jobs on an external scheduler instead of the builtin worker threads.
+ * Applications that already have a job system can use this operation to let
+ * flecs submit its jobs to it, so that flecs does not create threads of its
+ * own. The threads parameter specifies how many jobs may run concurrently, and
+ * has the same meaning as the number of threads passed to ecs_set_threads.
+ *
+ * When flecs has jobs to run, it invokes the submit callback of the scheduler
+ * with the number of threads. The scheduler must then call ecs_run_scheduled
+ * once for every thread index, from any thread. Different thread indices may
+ * run concurrently. Flecs then waits until all threads have finished, by
+ * calling the wait callback if provided, or by blocking until ecs_run_scheduled
+ * has been called for every thread.
+ *
+ * Passing NULL for the scheduler removes the scheduler. This operation should
+ * only be called before or after calling ecs_progress.
+ *
+ * @param world The world.
+ * @param threads The number of jobs that may run concurrently.
+ * @param scheduler The scheduler, or NULL to remove the scheduler.
+ */
+FLECS_EXPORT
+void ecs_set_scheduler(
+    ecs_world_t *world,
+    uint32_t threads,
+    const ecs_scheduler_t *scheduler);
+
+/** Run the jobs of a thread on an external scheduler.
+ * This operation must be called by an external scheduler for every thread index
+ * that is passed to its submit callback. See ecs_set_scheduler.
+ *
+ * @param world The world.
+ * @param thread The index of the thread, smaller than the number of threads.
+ */
+FLECS_EXPORT
+void ecs_run_scheduled(
+    ecs_world_t *world,
+    uint32_t thread);
+
 /** Set target frames per second (FPS) for application.
  * Setting the target FPS ensures that ecs_progress is not invoked faster than
  * the specified FPS. When enabled, ecs_progress tracks the time passed since
@@ -393,7 +510,8 @@ void ecs_set_threads(
  *
  * Note that ecs_progress only sleeps if there is time left in the frame. Both
  * time spent in flecs as time spent outside of flecs are taken into
- * account.
+ * account. As sleeping is not precise, ecs_progress sleeps until shortly
+ * before the end of the frame, and busy-waits for the last few milliseconds.
  *
  * Setting a target FPS can be more efficient than letting the application do it
  * manually, as the feature can reuse clock measurements that are taken for
@@ -404,6 +522,52 @@ void ecs_set_target_fps(
     ecs_world_t *world,
     float fps);
 
+/** Set the time budget of a frame.
+ * When the time spent in the current frame exceeds the budget, ecs_progress
+ * skips the systems that are marked as deferrable with ecs_set_deferrable.
+ * Other systems always run. The budget is measured from the start of
+ * ecs_progress, and is checked before each deferrable system. With worker
+ * threads it is checked before the jobs of a system are handed out.
+ *
+ * A deferrable system that is also time sliced (see ecs_set_time_slice)
+ * continues with its next slice when it runs again, so that a skipped frame
+ * only delays its rows.
+ *
+ * This feature depends upon frame profiling, which is enabled when a budget is
+ * set.
+ *
+ * @param world The world.
+ * @param budget Time in seconds. 0 disables the budget (default).
+ */
+FLECS_EXPORT
+void ecs_set_frame_budget(
+    ecs_world_t *world,
+    float budget);
+
+/** Overlap the store phases of a frame with the next frame.
+ * When enabled, ecs_progress copies the rows read by the PreStore and OnStore
+ * systems after the PostUpdate phase, and runs these systems on a separate
+ * thread. ecs_progress then returns, and the next frame can start while the
+ * previous frame is stored. The next frame waits for the store thread before
+ * it copies its own data, so at most one frame is stored at a time.
+ *
+ * Systems that run on the store thread only see the copied rows, and must not
+ * call operations on the world other than reading the world context. The
+ * frame is stored on the main thread instead if one of the store systems has a
+ * CONTAINER or CASCADE column, is sorted or is time sliced.
+ *
+ * The store thread is created when pipelined frames are enabled, and is reused
+ * by every frame. This operation may only be called outside ecs_progress.
+ * Disabling pipelined frames waits for the store thread, and stops it.
+ *
+ * @param world The world.
+ * @param enable Whether to overlap store phases with the next frame.
+ */
+FLECS_EXPORT
+void ecs_set_pipelined(
+    ecs_world_t *world,
+    bool enable);
+
 /** Get last used delta time from world */
 FLECS_EXPORT
 float ecs_get_delta_time(
@@ -484,6 +648,99 @@ void _ecs_dim_type(
 #define ecs_dim_type(world, type, entity_count)\
     _ecs_dim_type(world, T##type, entity_count)
 
+/** Enable garbage collection of tables.
+ * Tables are never deleted by default, and a table releases its memory as soon
+ * as its last entity is removed. This causes applications that create many
+ * short-lived archetypes to slowly accumulate tables, and tables that oscillate
+ * around empty to reallocate their columns over and over.
+ *
+ * When garbage collection is enabled, tables keep their capacity when they
+ * become empty. Every 'frames' frames, ecs_progress visits the tables that
+ * have not been modified for at least 'frames' frames. Empty tables are
+ * deleted and unregistered from the systems they matched with. Unused memory
+ * is released from the columns of the remaining tables.
+ *
+ * Note that this also releases memory that was preallocated with ecs_dim_type
+ * and that was not used for 'frames' frames.
+ *
+ * @param world The world.
+ * @param frames The number of frames after which a table is collected. 0
+ *        disables garbage collection (default).
+ */
+FLECS_EXPORT
+void ecs_set_table_gc(
+    ecs_world_t *world,
+    uint32_t frames);
+
+/** Collect tables.
+ * This operation deletes all empty tables, and releases unused memory from the
+ * columns of the remaining tables, regardless of when they were last
+ * modified. This operation cannot be called while the world is progressing.
+ *
+ * @param world The world.
+ */
+FLECS_EXPORT
+void ecs_gc(
+    ecs_world_t *world);
+
+/** Defragment tables.
+ * Deleting an entity moves the last row of its table into the deleted row, so
+ * over time entities that are created together end up scattered across the
+ * table. This operation restores the order of rows in a table. Rows are
+ * ordered by entity id, or by the component set with
+ * ecs_set_defragment_order. Rows of tables with a parent column stay ordered
+ * by depth and parent, and children of the same parent are ordered by id.
+ * Tables sorted by a system (see ecs_set_order_by) are not reordered.
+ *
+ * Tables are visited round-robin, starting from the table where the previous
+ * call stopped. The operation stops when all tables have been visited once,
+ * or when the time budget is exceeded. Tables that are already in order are
+ * only checked, which is cheap compared to moving rows.
+ *
+ * This operation cannot be called while the world is progressing.
+ *
+ * @param world The world.
+ * @param time_budget Time in seconds after which the operation stops. 0 visits
+ *        all tables.
+ * @return The number of tables of which rows were moved.
+ */
+FLECS_EXPORT
+uint32_t ecs_defragment(
+    ecs_world_t *world,
+    float time_budget);
+
+/** Defragment tables while progressing.
+ * When set, ecs_progress calls ecs_defragment at the end of each frame with
+ * the specified time budget, so that tables are defragmented a few at a time.
+ * Frames in which systems run asynchronously are skipped.
+ *
+ * @param world The world.
+ * @param time_budget Time in seconds spent on defragmenting per frame. 0
+ *        disables defragmenting (default).
+ */
+FLECS_EXPORT
+void ecs_set_defragment(
+    ecs_world_t *world,
+    float time_budget);
+
+/** Set the component that ecs_defragment orders rows by.
+ * Rows of tables that have the component are ordered by its value, rows of
+ * other tables are ordered by entity id. This can for example be used to store
+ * entities that are close to each other in space next to each other.
+ *
+ * @param world The world.
+ * @param component The component to order rows by. 0 orders by entity id.
+ * @param compare Function that compares two values of the component.
+ */
+FLECS_EXPORT
+void _ecs_set_defragment_order(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    ecs_compare_action_t compare);
+
+#define ecs_set_defragment_order(world, component, compare)\
+    _ecs_set_defragment_order(world, ecs_to_entity(component), compare)
+
 /* -- Entity API -- */
 
 /** Create a new entity.
@@ -586,6 +843,25 @@ ecs_entity_t ecs_clone(
     ecs_entity_t entity,
     bool copy_value);
 
+/** Create a set of entities with the same components as specified entity.
+ * This operation creates the number of specified clones with one API call,
+ * which is a more efficient alternative to calling ecs_clone in a loop. The
+ * clones are created with consecutive handles, and OnAdd and OnSet systems are
+ * invoked once for all clones.
+ *
+ * @param world The world.
+ * @param entity The source entity.
+ * @param count The number of clones to create.
+ * @param copy_value Whether to copy the entity value.
+ * @returns The handle to the first clone.
+ */
+FLECS_EXPORT
+ecs_entity_t ecs_clone_w_count(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    uint32_t count,
+    bool copy_value);
+
 /** Delete an existing entity.
  * Deleting an entity in most cases causes the data of another entity to be
  * copied. This happens to prevent memory fragmentation. It means that for
@@ -645,6 +921,95 @@ void ecs_orphan(
     ecs_entity_t child,
     ecs_entity_t parent);
 
+/** Set the parent of an entity without changing its type.
+ * Unlike ecs_adopt, which adds the parent to the type of the child, this
+ * operation stores the parent in a component. Children of different
+ * parents that have the same components are therefore stored in the same table,
+ * which prevents a table from being created for each parent.
+ *
+ * Systems with CONTAINER and CASCADE columns resolve these columns for each
+ * run of rows that share the same parent. Rows of tables that store parents
+ * are kept sorted by depth and parent to keep these runs long, and
+ * CASCADE systems visit these rows in depth order.
+ *
+ * Passing 0 for parent removes the parent from the entity. When a parent is
+ * deleted, its children become root entities. This operation cannot be invoked
+ * while the world is iterating.
+ *
+ * @param world The world.
+ * @param child The entity for which to set the parent.
+ * @param parent The parent entity, or 0 to remove the parent.
+ */
+FLECS_EXPORT
+void ecs_set_parent(
+    ecs_world_t *world,
+    ecs_entity_t child,
+    ecs_entity_t parent);
+
+/** Get the parent of an entity.
+ * This operation returns the parent set by ecs_set_parent. Parents added with
+ * ecs_adopt are not returned by this operation.
+ *
+ * @param world The world.
+ * @param child The entity for which to get the parent.
+ * @returns The parent entity, or 0 if the entity has no parent.
+ */
+FLECS_EXPORT
+ecs_entity_t ecs_parent_of(
+    ecs_world_t *world,
+    ecs_entity_t child);
+
+/** Get the children of an entity.
+ * This operation returns the children for which the entity was set as parent
+ * with ecs_set_parent. The returned array is owned by the world, and is
+ * invalidated when the children of the entity change.
+ *
+ * @param world The world.
+ * @param parent The entity for which to get the children.
+ * @param count_out Out parameter for the number of children.
+ * @returns An array with the children, or NULL if the entity has no children.
+ */
+FLECS_EXPORT
+ecs_entity_t* ecs_children_of(
+    ecs_world_t *world,
+    ecs_entity_t parent,
+    uint32_t *count_out);
+
+/** Enable or disable an entity.
+ * This operation excludes an entity from being processed by column systems
+ * without changing its type. Unlike adding or removing a tag component, no
+ * component data is moved, and the entity stays in the same table. Disabled
+ * rows are skipped when a system iterates a table, which may cause the system
+ * action to be invoked multiple times for a single table, once for each run of
+ * enabled entities.
+ *
+ * When this operation is invoked while the world is iterating, the change is
+ * staged and applied when the stage is merged. The enabled state is preserved
+ * when components are added to or removed from the entity.
+ *
+ * @param world The world.
+ * @param entity The entity to enable or disable.
+ * @param enabled true to enable the entity, false to disable it.
+ */
+FLECS_EXPORT
+void ecs_enable_entity(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    bool enabled);
+
+/** Test if an entity is enabled.
+ * This operation returns false if the entity was disabled with
+ * ecs_enable_entity, and true otherwise.
+ *
+ * @param world The world.
+ * @param entity The entity to test.
+ * @returns true if the entity is enabled, false if it is disabled.
+ */
+FLECS_EXPORT
+bool ecs_is_entity_enabled(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
 /** Get pointer to component data.
  * This operation obtains a pointer to the component data of an entity. If the
  * component was not added for the specified entity, the operation will return
@@ -710,6 +1075,13 @@ ecs_entity_t _ecs_set_ptr(
     size_t size,
     void *ptr);
 
+/* Set value of singleton component.
+ * Singleton components are stored on entity 0, unless singleton slots are
+ * enabled with ecs_set_singleton_slots.
+ *
+ * @param world The world.
+ * @param component The component to set.
+ */
 FLECS_EXPORT
 ecs_entity_t _ecs_set_singleton_ptr(
     ecs_world_t *world,
@@ -734,6 +1106,30 @@ ecs_entity_t _ecs_set_singleton_ptr(
 #define ecs_set_singleton_ptr(world, type, ptr)\
     _ecs_set_singleton_ptr(world, T##type, sizeof(type), ptr)
 
+/** Store singleton components in slots of the world.
+ * By default singleton components are stored on entity 0 like the components
+ * of any other entity. With singleton slots enabled, the world stores the
+ * values in an array indexed by component, so that getting a singleton or
+ * resolving a $Component column is a single array lookup. A pointer to a
+ * singleton value remains valid until the world is deleted. When set while the
+ * world is in progress, the value is staged and copied to the world when the
+ * stage is merged.
+ *
+ * Singletons in slots are not stored in a table: they don't invoke OnAdd, OnSet
+ * or OnRemove systems, they are not part of ecs_get_type for entity 0, and they
+ * can't be removed. ecs_add and ecs_has on entity 0 add and test singleton
+ * values.
+ *
+ * This setting must be changed before any singleton is set.
+ *
+ * @param world The world.
+ * @param enable Whether to store singletons in slots.
+ */
+FLECS_EXPORT
+void ecs_set_singleton_slots(
+    ecs_world_t *world,
+    bool enable);
+
 /** Check if entity has the specified type.
  * This operation checks if the entity has the components associated with the
  * specified type. It accepts component handles, families and prefabs.
@@ -1093,6 +1489,113 @@ void ecs_set_period(
     ecs_entity_t system,
     float period);
 
+/** Spread the rows of a system over multiple frames.
+ * A periodic system runs all of its rows in the frame in which its period
+ * expires, which causes a spike in frame time. A time sliced system instead
+ * runs a slice of its rows each time it is invoked, so that every row is
+ * visited once in 'frames' invocations, and the load is spread evenly.
+ *
+ * The size of a slice is computed from the number of rows in the matched
+ * tables each time the system runs, so slices follow tables as they grow and
+ * shrink. Rows added or removed during a cycle may be visited twice or
+ * skipped once in that cycle, as the slice is an offset in the matched rows.
+ * The delta_time passed to the system is the time of a single frame.
+ *
+ * Systems with a CASCADE column cannot be time sliced. This operation may only
+ * be called outside ecs_progress.
+ *
+ * @param world The world.
+ * @param system The system to time slice.
+ * @param frames The number of invocations in which all rows are visited. 0 or
+ *        1 runs all rows in each invocation (default).
+ */
+FLECS_EXPORT
+void ecs_set_time_slice(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    uint32_t frames);
+
+/** Mark a system as deferrable.
+ * Deferrable systems are skipped by ecs_progress when the frame budget set
+ * with ecs_set_frame_budget is exhausted. Systems are mandatory by default.
+ * A skipped system does not receive the delta_time of the frame it skipped.
+ *
+ * @param world The world.
+ * @param system The column system.
+ * @param deferrable Whether the system may be skipped.
+ */
+FLECS_EXPORT
+void ecs_set_deferrable(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    bool deferrable);
+
+/** Iterate the rows of a system in the order of a component value.
+ * The rows of each table that the system matched are sorted in place, and the
+ * system visits the rows of all its tables in a single sorted order. Rows of a
+ * table are only sorted again when rows were added, removed or enabled, or
+ * when the component was written by ecs_set, by a merge or by a system or query
+ * that has the component in its signature.
+ *
+ * Rows of tables that store parents with ecs_set_parent stay ordered by their
+ * depth in the hierarchy. A system with a CASCADE column cannot be sorted.
+ * Passing 0 for the component disables sorting.
+ *
+ * @param world The world.
+ * @param system The system to sort.
+ * @param component The component to sort on.
+ * @param compare The function that compares two component values.
+ */
+FLECS_EXPORT
+void _ecs_set_order_by(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_entity_t component,
+    ecs_compare_action_t compare);
+
+#define ecs_set_order_by(world, system, component, compare)\
+    _ecs_set_order_by(world, system, ecs_to_entity(component), compare)
+
+/** Allow a task to run on a worker thread.
+ * Tasks are systems that are not matched with any entities. By default tasks
+ * run one after another on the main thread. When an application has set the
+ * number of threads with ecs_set_threads, tasks that are marked as parallel
+ * are distributed over the worker threads and run concurrently.
+ *
+ * A parallel task must only write to the world through the world pointer it
+ * receives in ecs_rows_t. Its changes are merged after all tasks have finished,
+ * in the same way as the changes of column systems.
+ *
+ * This operation may only be invoked on tasks, outside of ecs_progress.
+ *
+ * @param world The world.
+ * @param task The task.
+ * @param parallel Whether the task may run on a worker thread.
+ */
+FLECS_EXPORT
+void ecs_set_task_parallel(
+    ecs_world_t *world,
+    ecs_entity_t task,
+    bool parallel);
+
+/** Prevent two tasks from running at the same time.
+ * Parallel tasks that access the same data outside of the world can be marked
+ * as conflicting. A task is never ran concurrently with a task it conflicts
+ * with, and conflicting tasks run in the order in which they were created.
+ * Tasks that are not parallel implicitly conflict with all other tasks.
+ *
+ * This operation may only be invoked on tasks, outside of ecs_progress.
+ *
+ * @param world The world.
+ * @param task_1 The first task.
+ * @param task_2 The second task.
+ */
+FLECS_EXPORT
+void ecs_set_task_conflict(
+    ecs_world_t *world,
+    ecs_entity_t task_1,
+    ecs_entity_t task_2);
+
 /** Returns the enabled status for a system / entity.
  * This operation will return whether a system is enabled or disabled. Currently
  * only systems can be enabled or disabled, but this operation does not fail
@@ -1166,6 +1669,142 @@ ecs_entity_t _ecs_run_w_filter(
 #define ecs_run_w_filter(world, system, delta_time, offset, limit, type, param)\
     _ecs_run_w_filter(world, system, delta_time, offset, limit, T##type, param)
 
+/** Run a system asynchronously on the worker threads.
+ * This operation splits the entities of a system over the worker threads and
+ * returns without waiting for the workers to finish. This lets an application
+ * start expensive on demand systems early, and use their results later. If no
+ * worker threads are created with ecs_set_threads, the system is ran before
+ * this operation returns.
+ *
+ * The system writes its changes to the stages of the worker threads. These
+ * changes are merged by ecs_async_wait, or by the next merge when the system
+ * is started while the world is in progress. Workers can only run one system
+ * at a time: starting another async system, running a multithreaded phase or
+ * merging first waits until the async system has finished.
+ *
+ * When started outside of ecs_progress, the world is staged until the system
+ * has finished, as if it were in progress. Changes made by the application in
+ * the meantime are merged together with the changes of the system.
+ *
+ * @param world The world.
+ * @param system The system to run.
+ * @param delta_time: The time passed since the last system invocation.
+ * @param param A user-defined parameter to pass to the system.
+ * @returns A handle that can be passed to ecs_async_done and ecs_async_wait.
+ */
+FLECS_EXPORT
+ecs_async_t ecs_run_async(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    float delta_time,
+    void *param);
+
+/** Test whether an asynchronously ran system has finished.
+ * This operation does not block, and does not merge the results of the system.
+ *
+ * @param world The world.
+ * @param handle The handle returned by ecs_run_async.
+ * @returns True if the system has finished, false if it is still running.
+ */
+FLECS_EXPORT
+bool ecs_async_done(
+    ecs_world_t *world,
+    ecs_async_t handle);
+
+/** Wait for an asynchronously ran system to finish.
+ * When called outside of ecs_progress and automerging is enabled, this
+ * operation also merges the results of the system.
+ *
+ * @param world The world.
+ * @param handle The handle returned by ecs_run_async.
+ */
+FLECS_EXPORT
+void ecs_async_wait(
+    ecs_world_t *world,
+    ecs_async_t handle);
+
+/** Create a query.
+ * A query matches tables with a signature in the same way as a system, and
+ * keeps its list of matched tables up to date when tables are created or
+ * deleted. Unlike a system, a query is not an entity and is not part of a
+ * phase, which makes it cheap to create queries that are only used for a short
+ * time or that are iterated rarely.
+ *
+ * The signature has the same format as a system signature, except that it
+ * cannot contain SYSTEM columns. The signature string must stay valid for the
+ * lifetime of the query.
+ *
+ * @param world The world.
+ * @param sig The signature of the query.
+ * @returns The new query.
+ */
+FLECS_EXPORT
+ecs_query_t* ecs_query_new(
+    ecs_world_t *world,
+    const char *sig);
+
+/** Free a query.
+ *
+ * @param query The query to free.
+ */
+FLECS_EXPORT
+void ecs_query_free(
+    ecs_query_t *query);
+
+/** Iterate the rows of a query in the order of a component value.
+ * This operation is equivalent to ecs_set_order_by, but for queries. Tables
+ * are sorted when an iterator for the query is created outside of a frame.
+ * While the world is in progress, the order of the last sort is used, or the
+ * rows are returned unsorted if tables changed since then.
+ *
+ * @param query The query to sort.
+ * @param component The component to sort on.
+ * @param compare The function that compares two component values.
+ */
+FLECS_EXPORT
+void _ecs_query_order_by(
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_compare_action_t compare);
+
+#define ecs_query_order_by(query, component, compare)\
+    _ecs_query_order_by(query, ecs_to_entity(component), compare)
+
+/** Create an iterator for a query.
+ * The rows member of the iterator is filled by ecs_query_next, and can be
+ * passed to ecs_column, ecs_shared and other functions that operate on the
+ * rows of a system:
+ *
+ * ecs_query_iter_t it = ecs_query_iter(query);
+ * while (ecs_query_next(&it)) {
+ *     Position *p = ecs_column(&it.rows, Position, 1);
+ *     for (int i = 0; i < it.rows.count; i ++) { ... }
+ * }
+ *
+ * Entities should not move to other tables while a query is iterated outside
+ * of a frame. The references of a query are stored in the query, so a query
+ * can only be iterated by one iterator at a time.
+ *
+ * Outside of a frame, the rows of the query are registered as changed, as the
+ * application may write to them. While in progress, the world is not modified
+ * by this operation, so that it can be used by systems on worker threads.
+ *
+ * @param query The query to iterate.
+ * @returns An iterator positioned before the first result.
+ */
+FLECS_EXPORT
+ecs_query_iter_t ecs_query_iter(
+    ecs_query_t *query);
+
+/** Progress a query iterator to the next result.
+ *
+ * @param it The iterator.
+ * @returns True if there is a next result, false if iteration has finished.
+ */
+FLECS_EXPORT
+bool ecs_query_next(
+    ecs_query_iter_t *it);
+
 /* Obtain a column from inside a system */
 FLECS_EXPORT
 void* _ecs_column(
@@ -1367,6 +2006,7 @@ void _ecs_assert(
 #define ECS_COLUMN_IS_NOT_SET (23)
 #define ECS_UNRESOLVED_REFERENCE (24)
 #define ECS_THREAD_ERROR (25)
+#define ECS_INVALID_WHILE_ITERATING (26)
 
 
 /* -- Convenience macro's for wrapping around generated types and entities -- */
@@ -32,6 +32,12 @@ void ecs_set_watching(
     ecs_entity_t entity,
     bool watching);
 
+/* Enable or disable entity in main stage (doesn't stage) */
+void ecs_set_entity_enabled(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    bool enabled);
+
 /* Does one of the entity containers has specified component */
 bool ecs_components_contains_component(
     ecs_world_t *world,
@@ -39,6 +45,48 @@ bool ecs_components_contains_component(
     ecs_entity_t component,
     ecs_entity_t *entity_out);
 
+/* -- Hierarchy API -- */
+
+/* Get parent stored in parent column of entity (0 if none) */
+ecs_entity_t ecs_hierarchy_get_parent(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Add entity stored in table row to the children of the parent in the row */
+void ecs_hierarchy_add_row(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_table_column_t *columns,
+    int32_t index,
+    ecs_entity_t entity);
+
+/* Remove entity stored in table row from the children of its parent */
+void ecs_hierarchy_remove_row(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_table_column_t *columns,
+    int32_t index,
+    ecs_entity_t entity);
+
+/* Clear the parent of all children of a parent that is deleted */
+void ecs_hierarchy_orphan_children(
+    ecs_world_t *world,
+    ecs_entity_t parent);
+
+/* Sort rows of table with parent column by depth and parent */
+void ecs_hierarchy_sort_table(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Order rows of table with parent column by depth, parent and entity id */
+bool ecs_hierarchy_defragment_table(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Sort all tables with parent column that changed since the last sort */
+void ecs_hierarchy_sort(
+    ecs_world_t *world);
+
 /* -- World API -- */
 
 /* Get (or create) table from type */
@@ -54,6 +102,14 @@ void ecs_world_activate_system(
     EcsSystemKind kind,
     bool active);
 
+/* Refresh pointers to system data if tables that store systems changed */
+void ecs_world_sync_systems(
+    ecs_world_t *world);
+
+/* Recompute which tables are ordered by a sorted system or query */
+void ecs_world_update_sorted_tables(
+    ecs_world_t *world);
+
 /* Get current thread-specific stage */
 ecs_stage_t *ecs_get_stage(
     ecs_world_t **world_ptr);
@@ -193,6 +249,7 @@ void ecs_table_register_system(
 /* Insert row into table (or stage) */
 uint32_t ecs_table_insert(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     ecs_table_t *table,
     ecs_table_column_t *columns,
     ecs_entity_t entity);
@@ -200,6 +257,7 @@ uint32_t ecs_table_insert(
 /* Insert multiple rows into table (or stage) */
 uint32_t ecs_table_grow(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     ecs_table_t *table,
     ecs_table_column_t *columns,
     uint32_t count,
@@ -207,6 +265,7 @@ uint32_t ecs_table_grow(
 
 /* Dimension array to have n rows (doesn't add entities) */
 int16_t ecs_table_dim(
+    ecs_world_t *world,
     ecs_table_t *table,
     uint32_t count);
 
@@ -249,6 +308,63 @@ void ecs_table_free(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Get pointer to component value shared by the prefab of a table. Pointers
+ * are cached until prefab data moves. */
+void* ecs_table_get_shared(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_entity_t prefab,
+    ecs_entity_t component);
+
+/* Compute the prefab values to copy when adding a type to an entity in table */
+ecs_array_t* ecs_table_new_instantiate_plan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_table_t *table,
+    ecs_type_t to_add);
+
+/* Get cached instantiate plan. Plans are cached until prefab data moves. */
+ecs_array_t* ecs_table_get_instantiate_plan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_table_t *table,
+    ecs_type_t to_add);
+
+/* Enable or disable table row (index is 0-based) */
+void ecs_table_set_enabled(
+    ecs_table_t *table,
+    uint32_t row,
+    bool enabled);
+
+/* Test if table row is enabled (index is 0-based) */
+bool ecs_table_is_enabled(
+    ecs_table_t *table,
+    uint32_t row);
+
+/* Find next run of enabled rows in [first, end). Returns number of rows in the
+ * run, and updates first to the start of the run. */
+uint32_t ecs_table_enabled_run(
+    ecs_table_t *table,
+    uint32_t *first,
+    uint32_t end);
+
+/* Release unused column memory of table */
+void ecs_table_reclaim(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Register that a column of a table was written. Column 0 registers that rows
+ * were added, removed or moved. */
+void ecs_table_column_changed(
+    ecs_table_t *table,
+    uint32_t column);
+
+/* Move rows of table so that row i contains the row that was at order[i] */
+void ecs_table_reorder(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const uint32_t *order);
+
 /* -- System API -- */
 
 /* Compute the AND type from the system columns */
@@ -284,16 +400,31 @@ void ecs_system_activate_table(
     ecs_table_t *table,
     bool active);
 
+/* Remove table from system (happens when table is garbage collected) */
+void ecs_system_remove_table(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    uint32_t table_index);
+
+/* Update index of table in system after table moved in the world table array */
+void ecs_system_move_table(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    uint32_t old_index,
+    uint32_t new_index);
+
 /* Run a task (periodic system that is not matched against any tables) */
 void ecs_run_task(
     ecs_world_t *world,
-    ecs_entity_t system);
+    ecs_entity_t system,
+    EcsRowSystem *system_data);
 
 /* Invoke row system */
 bool ecs_notify_row_system(
     ecs_world_t *world,
     ecs_entity_t system,
-    ecs_array_t *type,
+    EcsRowSystem *system_data,
+    int32_t *columns,
     ecs_table_column_t *table_columns,
     uint32_t offset,
     uint32_t limit);
@@ -307,27 +438,237 @@ int ecs_parse_component_action(
     const char *source_id,
     void *data);
 
+/* Get estimated time to run system for row of table (0 if unknown) */
+float ecs_system_row_cost(
+    EcsColSystem *system_data,
+    uint32_t table_index);
+
+/* Add time spent on rows of table, to be averaged by ecs_system_update_row_cost */
+void ecs_system_measure_rows(
+    EcsColSystem *system_data,
+    uint32_t table_index,
+    float time_spent,
+    uint32_t count);
+
+/* Update estimated cost of row of table with measured time */
+void ecs_system_update_row_cost(
+    EcsColSystem *system_data,
+    uint32_t table_index);
+
+/* Count rows of system with CASCADE column per hierarchy level */
+uint32_t ecs_system_level_rows(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_array_t **rows_out);
+
+/* Map columns of row system to the columns of a type */
+void ecs_row_system_columns(
+    EcsRowSystem *system_data,
+    ecs_array_t *type,
+    int32_t *columns);
+
+/* Run column system from pointer to its data */
+ecs_entity_t ecs_col_system_run(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    float delta_time,
+    uint32_t offset,
+    uint32_t limit,
+    ecs_type_t filter,
+    void *param,
+    ecs_array_t **costs);
+
 /* Trigger rematch of system */
 void ecs_rematch_system(
     ecs_world_t *world,
     ecs_entity_t system);
 
+/* Sort tables of system by its sort component, and compute the sorted order */
+void ecs_system_sort_tables(
+    ecs_world_t *world,
+    EcsColSystem *system_data);
+
+/* Mark tables of a sorted system, so they are not defragmented */
+void ecs_system_mark_sorted(
+    ecs_world_t *world,
+    EcsColSystem *system_data);
+
+/* Sort rows of table by component (entity id if 0), returns if rows moved */
+bool ecs_table_sort(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_entity_t component,
+    ecs_compare_action_t compare);
+
+/* Get offset and limit of the rows a time sliced system runs in this frame.
+ * Returns false if the system has no rows. */
+bool ecs_system_next_slice(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    uint32_t *offset,
+    uint32_t *limit);
+
+/* Register the owned columns accessed by a system as changed */
+void ecs_system_mark_changed(
+    ecs_world_t *world,
+    EcsColSystem *system_data);
+
+/* Can system run from a copy of the data it reads */
+bool ecs_system_can_snapshot(
+    EcsColSystem *system_data);
+
+/* Copy the data system reads in current frame, returns false if it doesn't run */
+bool ecs_system_snapshot(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_snapshot_system_t *out);
+
+/* Run system on copy of its data */
+void ecs_snapshot_run(
+    ecs_world_t *world,
+    ecs_snapshot_system_t *snapshot);
+
+/* Free copy of system data */
+void ecs_snapshot_free(
+    ecs_snapshot_system_t *snapshot);
+
+/* -- Query API -- */
+
+/* Notify query of a new table, which initiates query-table matching */
+void ecs_query_notify_of_table(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_table_t *table);
+
+/* Remove table from query (happens when table is garbage collected) */
+void ecs_query_remove_table(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    uint32_t table_index);
+
+/* Update index of table in query after table moved in the world table array */
+void ecs_query_move_table(
+    ecs_query_t *query,
+    uint32_t old_index,
+    uint32_t new_index);
+
+/* Trigger rematch of query */
+void ecs_query_rematch(
+    ecs_world_t *world,
+    ecs_query_t *query);
+
 /* -- Worker API -- */
 
 /* Compute schedule based on current number of entities matching system */
 void ecs_schedule_jobs(
     ecs_world_t *world,
-    ecs_entity_t system);
+    EcsColSystem *system_data);
 
 /* Prepare jobs */
 void ecs_prepare_jobs(
     ecs_world_t *world,
-    ecs_entity_t system);
+    EcsColSystem *system_data);
 
 /* Run jobs */
 void ecs_run_jobs(
     ecs_world_t *world);
 
+/* Run jobs of system with CASCADE column, one hierarchy level at a time */
+void ecs_run_cascade_jobs(
+    ecs_world_t *world,
+    EcsColSystem *system_data);
+
+/* Schedule task to run on a worker thread */
+void ecs_schedule_task(
+    ecs_world_t *world,
+    ecs_entity_t task,
+    EcsRowSystem *task_data);
+
+/* Run scheduled tasks on worker threads */
+void ecs_run_task_jobs(
+    ecs_world_t *world);
+
+/* Stop all worker threads, including parked threads */
+void ecs_stop_threads(
+    ecs_world_t *world);
+
+/* Wait for pending async run to finish */
+void ecs_wait_for_async(
+    ecs_world_t *world);
+
+/* -- Event API -- */
+
+/* Initialize queue for deferred notifications of row systems in index */
+void ecs_event_queue_init(
+    ecs_event_queue_t *queue,
+    ecs_map_t *systems);
+
+/* Free resources of deferred notification queue */
+void ecs_event_queue_deinit(
+    ecs_event_queue_t *queue);
+
+/* Queue notification for entities in table range if deferring is enabled.
+ * While in progress, notifications are queued in the stage until it is merged.
+ * Returns true if the notification does not need to be delivered now. */
+bool ecs_defer_event(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_map_t *systems,
+    ecs_type_t type,
+    ecs_table_column_t *table_columns,
+    uint32_t offset,
+    uint32_t limit);
+
+/* Move notifications deferred in stage to the queues of the world */
+void ecs_event_merge(
+    ecs_world_t *world,
+    ecs_stage_t *stage);
+
+/* Free notifications of stage that have not been merged */
+void ecs_event_stage_deinit(
+    ecs_stage_t *stage);
+
+/* -- Singleton API -- */
+
+/* Get singleton value, including values set in stage while in progress */
+void* ecs_singleton_get(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t component);
+
+/* Test if singleton values are set for all (or any) components of type */
+bool ecs_singleton_has(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_type_t type,
+    bool match_all);
+
+/* Add zero initialized singleton values for components of type that aren't set */
+void ecs_singleton_add(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_type_t type);
+
+/* Set singleton value in slot of world, or in stage while in progress */
+ecs_entity_t ecs_singleton_set(
+    ecs_world_t *world,
+    ecs_type_t type,
+    size_t size,
+    void *ptr);
+
+/* Copy singleton values set in stage to the world */
+void ecs_singleton_merge(
+    ecs_world_t *world,
+    ecs_stage_t *stage);
+
+/* Free singleton values of stage that have not been merged */
+void ecs_singleton_stage_deinit(
+    ecs_stage_t *stage);
+
+/* Free singleton values of world */
+void ecs_singleton_fini(
+    ecs_world_t *world);
+
 /* -- Private utilities -- */
 
 /* Compute hash */
@@ -20,6 +20,17 @@
 #define ECS_TABLE_INITIAL_ROW_COUNT (0)
 #define ECS_SYSTEM_INITIAL_TABLE_COUNT (0)
 #define ECS_MAX_JOBS_PER_WORKER (16)
+#define ECS_LARGE_COLUMN_SIZE (2 * 1024 * 1024)
+#define ECS_MAX_HIERARCHY_DEPTH (1024)
+#define ECS_SCHEDULE_TOLERANCE (0.25f)
+#define ECS_COST_SMOOTHING (0.1f)
+#define ECS_COST_SCHEDULE_INTERVAL (16)
+#define ECS_FRAME_SPIN_TIME (0.002)
+#define ECS_PHASE_COUNT (EcsOnStore + 1)
+
+/* Values stored in stage::enabled_merge */
+#define ECS_ENTITY_ENABLED (1)
+#define ECS_ENTITY_DISABLED (2)
 
 #define ECS_WORLD_MAGIC (0x65637377)
 #define ECS_THREAD_MAGIC (0x65637374)
@@ -33,6 +44,11 @@ typedef struct EcsTypeComponent {
     ecs_type_t resolved;  /* Resolved nested families */
 } EcsTypeComponent;
 
+/** Parent of an entity set with ecs_set_parent */
+typedef struct EcsParent {
+    ecs_entity_t entity;
+} EcsParent;
+
 /** Metadata of a component */
 typedef struct EcsComponent {
     uint32_t size;
@@ -137,12 +153,27 @@ typedef struct EcsSystem {
  * time_passed member, until it exceeds 'period'. In that case, the system is
  * ran, and 'time_passed' is decreased by 'period'. 
  */
+/** Estimated time it takes a system to run for a row of a table. Time measured
+ * by jobs is collected before it is averaged, so that the estimate is updated
+ * once per table, even if the rows of a table were split over jobs. */
+typedef struct ecs_row_cost_t {
+    float cost;                   /* Moving average of time per row */
+    float time_spent;             /* Measured time that is not yet averaged */
+    uint32_t count;               /* Measured rows that are not yet averaged */
+} ecs_row_cost_t;
+
 typedef struct EcsColSystem {
     EcsSystem base;
     ecs_entity_t entity;          /* Entity id of system, used for ordering */
     ecs_array_t *components;      /* Computed component list per matched table */
     ecs_array_t *inactive_tables; /* Inactive tables */
     ecs_array_t *jobs;            /* Jobs for this system */
+    ecs_array_t *level_rows;      /* Rows per hierarchy level (CASCADE) */
+    ecs_array_t *row_costs;       /* Cost per row, by world table index */
+    uint32_t schedule_changes;    /* world::row_changes when jobs were created */
+    uint32_t schedule_rows;       /* Rows per job when jobs were created */
+    uint32_t schedule_frame;      /* Frame in which jobs were created */
+    bool valid_schedule;          /* Are jobs created for current tables */
     ecs_array_t *tables;          /* Table index + refs index + column offsets */
     ecs_array_t *refs;            /* Columns that point to other entities */
     ecs_array_params_t table_params; /* Parameters for tables array */
@@ -150,6 +181,13 @@ typedef struct EcsColSystem {
     ecs_array_params_t ref_params; /* Parameters for tables array */
     float period;              /* Minimum period inbetween system invocations */
     float time_passed;         /* Time passed since last invocation */
+    ecs_entity_t sort_on;      /* Component to order rows by (0 if none) */
+    ecs_compare_action_t compare; /* Compares values of sort_on */
+    ecs_array_t *sorted_slices; /* Rows of tables in sorted order */
+    bool valid_order;          /* Are sorted_slices up to date with tables */
+    uint32_t slice_frames;     /* Frames in which all rows are visited once */
+    uint32_t slice_cursor;     /* First row of the next slice */
+    bool deferrable;           /* Skipped when frame budget is exhausted */
 } EcsColSystem;
 
 /** A row system is a system that is ran on 1..n entities for which a certain 
@@ -159,8 +197,51 @@ typedef struct EcsColSystem {
 typedef struct EcsRowSystem {
     EcsSystem base;
     ecs_array_t *components;       /* Components in order of signature */
+    ecs_array_t *refs;             /* Entities and components of columns that
+                                    * are not fetched from the entity itself */
+    ecs_array_t *conflicts;        /* Tasks that may not run concurrently */
+    bool parallel;                 /* Can task run on a worker thread */
 } EcsRowSystem;
 
+/** Element of the arrays in the world::type_sys_*_index maps. The pointer to
+ * the system data is refreshed when the tables that store systems change, so
+ * that notifying a row system does not require an entity lookup. The column
+ * map is computed once, when the system is matched with the type. */
+typedef struct ecs_row_system_ref_t {
+    ecs_entity_t system;           /* Row system handle */
+    EcsRowSystem *data;            /* Row system data */
+    int32_t *columns;              /* Columns of system mapped to type */
+} ecs_row_system_ref_t;
+
+/** Run of rows from a single table, in the order of a sorted system */
+typedef struct ecs_sorted_slice_t {
+    uint32_t table;                /* Index in tables of system */
+    uint32_t offset;               /* First row of slice */
+    uint32_t count;                /* Number of rows in slice */
+} ecs_sorted_slice_t;
+
+/** A notification for an entity of which delivery has been deferred */
+typedef struct ecs_event_t {
+    ecs_entity_t entity;           /* Entity to notify systems for */
+    ecs_type_t type;               /* Components that were added or set */
+} ecs_event_t;
+
+/** Queue of deferred notifications, one entry per entity */
+typedef struct ecs_event_queue_t {
+    ecs_array_t *events;           /* ecs_event_t, in order of arrival */
+    ecs_map_t *entity_index;       /* Entity to index + 1 in events */
+    ecs_map_t *systems;            /* Row system index to notify */
+} ecs_event_queue_t;
+
+/** A query matches tables like a column system, but is not an entity and does
+ * not belong to a phase. It is iterated by the application. */
+struct ecs_query_t {
+    ecs_world_t *world;            /* World the query was created in */
+    EcsColSystem system;           /* Matched tables, components and refs */
+    void **ref_ptrs;               /* Resolved references of current table */
+    ecs_reference_t *references;   /* References resolved per parent run */
+};
+
 
 /* -- Private types -- */
 
@@ -170,6 +251,29 @@ typedef struct ecs_table_column_t {
     uint16_t size;                /* Column size (saves component lookups) */
 } ecs_table_column_t;
 
+/** Copy of the rows of a table matched by a store system. Only the columns that
+ * the system accesses are copied, and disabled rows are left out. */
+typedef struct ecs_snapshot_table_t {
+    ecs_table_column_t *columns;     /* Copied columns (data NULL if unused) */
+    uint32_t column_count;           /* Number of columns, including entities */
+    int32_t *columns_map;            /* System columns mapped to table columns */
+    ecs_entity_t *components;        /* Components of system for table */
+    ecs_reference_t *references;     /* References of system for table */
+    void **ref_ptrs;                 /* Copied values of references */
+    uint32_t ref_count;              /* Number of references */
+    uint32_t count;                  /* Number of copied rows */
+} ecs_snapshot_table_t;
+
+/** Copy of the data a store system reads in a frame, so that it can run while
+ * the next frame modifies the tables */
+typedef struct ecs_snapshot_system_t {
+    ecs_entity_t entity;             /* System handle */
+    ecs_system_action_t action;      /* System action */
+    uint32_t column_count;           /* Number of columns in signature */
+    float delta_time;                /* Delta time passed to system */
+    ecs_array_t *tables;             /* Copied tables (ecs_snapshot_table_t) */
+} ecs_snapshot_system_t;
+
 /** A table is the Flecs equivalent of an archetype. Tables store all entities
  * with a specific set of components. Tables are automatically created when an
  * entity has a set of components not previously observed before. When a new
@@ -179,7 +283,29 @@ typedef struct ecs_table_t {
     ecs_table_column_t *columns;      /* Columns storing components of array */
     ecs_array_t *frame_systems;      /* Frame systems matched with table */
     ecs_type_t type_id;              /* Identifies table type in type_index */
+    ecs_array_t *disabled;           /* Bitmask with a bit set for each disabled row */
+    uint32_t disabled_count;         /* Number of disabled rows */
+    uint32_t last_modified;          /* Frame in which row count last changed */
+    ecs_array_t *depth_offsets;      /* First row of each hierarchy depth */
+    int16_t parent_column;           /* Column with parents (0 if none) */
+    bool hierarchy_dirty;            /* Rows must be sorted by depth & parent */
+    bool is_sorted;                  /* Rows are ordered by a sorted system */
+    bool has_systems;                /* Does table store system data */
+    bool is_prefab;                  /* Does table store prefabs */
+    ecs_map_t *prefab_cache;         /* Shared component values from prefabs */
+    ecs_map_t *instantiate_plans;    /* Prefab values to copy per added type */
+    uint32_t prefab_cache_version;   /* prefab_version of prefab caches */
+    uint32_t *column_versions;       /* Change counter per column. Column 0
+                                      * counts changes to the rows. */
  } ecs_table_t;
+
+/** Column of a table that is initialized with a value from a prefab when an
+ * entity is created in the table */
+typedef struct ecs_prefab_column_t {
+    int32_t column;                  /* Column in table (0 stores entities) */
+    uint32_t size;                   /* Size of component */
+    void *value;                     /* Value in prefab */
+} ecs_prefab_column_t;
  
 /** The ecs_row_t struct is a 64-bit value that describes in which table
  * (identified by a type_id) is stored, at which index. Entries in the 
@@ -223,16 +349,32 @@ typedef struct ecs_stage_t {
      * not on the main stage */
     ecs_map_t *data_stage;          /* Arrays with staged component values */
     ecs_map_t *remove_merge;        /* All removed components before merge */
+    ecs_map_t *enabled_merge;       /* Entities enabled/disabled before merge */
+    ecs_map_t *singletons;          /* Singleton values set before merge */
+    ecs_array_t *add_events;        /* OnAdd notifications deferred before merge */
+    ecs_array_t *set_events;        /* OnSet notifications deferred before merge */
 } ecs_stage_t;
 
 /** A type describing a unit of work to be executed by a worker thread. */ 
 typedef struct ecs_job_t {
     ecs_entity_t system;             /* System handle */
     EcsColSystem *system_data;    /* System to run */
+    EcsRowSystem *task_data;      /* Task to run */
     uint32_t offset;              /* Start index in row chunk */
     uint32_t limit;               /* Total number of rows to process */
+    bool is_task;                 /* Job runs a task instead of table rows */
 } ecs_job_t;
 
+/** Time spent by a job on the rows of a table, or on the job if count is 0.
+ * Jobs don't update the system, as jobs of the same system run at the same
+ * time and may run rows of the same table. */
+typedef struct ecs_job_cost_t {
+    EcsColSystem *system_data;    /* System that ran the rows */
+    uint32_t table_index;         /* Index of table in world */
+    float time_spent;             /* Time spent on the rows */
+    uint32_t count;               /* Number of rows */
+} ecs_job_cost_t;
+
 /** A type desribing a worker thread. When a system is invoked by a worker
  * thread, it receives a pointer to an ecs_thread_t instead of a pointer to an 
  * ecs_world_t (provided by the ecs_rows_t type). When this ecs_thread_t is passed down
@@ -243,12 +385,23 @@ typedef struct ecs_job_t {
 typedef struct ecs_thread_t {
     uint32_t magic;               /* Magic number to verify thread pointer */
     uint32_t job_count;           /* Number of jobs scheduled for thread */
+    uint32_t index;               /* Index of thread in pool */
     ecs_world_t *world;              /* Reference to world */
     ecs_job_t *jobs[ECS_MAX_JOBS_PER_WORKER]; /* Array with jobs */
     ecs_stage_t *stage;              /* Stage for thread */
     ecs_os_thread_t thread;          /* Thread handle */
+    float time_spent;                /* Time spent on jobs of last run */
+    ecs_array_t *costs;              /* Time spent per table by jobs */
 } ecs_thread_t;
 
+/** Time spent by worker threads on the jobs of a phase, used to determine how
+ * well jobs are balanced. A perfectly balanced phase has a max that is equal to
+ * total divided by the number of threads. */
+typedef struct ecs_phase_time_t {
+    float max;                       /* Time of slowest thread, summed per run */
+    float total;                     /* Time of all threads */
+} ecs_phase_time_t;
+
 /** The world stores and manages all ECS data. An application can have more than
  * one world, but data is not shared between worlds. */
 struct ecs_world_t {
@@ -270,6 +423,13 @@ struct ecs_world_t {
     ecs_array_t *on_demand_systems;  
     ecs_array_t *inactive_systems;   
 
+    /* Pointers to the data of the systems in each phase, in the same order as
+     * the phase arrays. Refreshed when system_version changes. */
+    ecs_array_t *phase_ptrs[ECS_PHASE_COUNT];
+    uint32_t system_version;         /* Changes when system data may move */
+    uint32_t system_ptrs_version;    /* system_version of system pointers */
+    uint32_t prefab_version;         /* Changes when prefab data may move */
+
 
     /* -- Row systems -- */
 
@@ -281,6 +441,8 @@ struct ecs_world_t {
     /* -- Tasks -- */
 
     ecs_array_t *tasks;              /* Periodic actions not invoked on entities */
+    ecs_array_t *task_ptrs;          /* Pointers to the data of tasks */
+    ecs_array_t *task_jobs;          /* Jobs for tasks that run on workers */
     ecs_array_t *fini_tasks;         /* Tasks to execute on ecs_fini */
 
 
@@ -291,6 +453,26 @@ struct ecs_world_t {
     ecs_map_t *type_sys_remove_index; /* Index to find remove row systems for type*/
     ecs_map_t *type_sys_set_index;    /* Index to find set row systems for type */
     ecs_map_t *type_handles;          /* Handles to named families */
+    ecs_map_t *child_index;           /* Children of parents set with ecs_set_parent */
+    ecs_map_t *changed_containers;    /* Watched entities that changed type */
+    ecs_map_t *changed_components;    /* Components added to/removed from them */
+
+
+    /* -- Singletons -- */
+
+    ecs_array_t *singletons;          /* Singleton values, by component */
+    bool singleton_slots;             /* Store singletons in slots */
+
+
+    /* -- Queries -- */
+
+    ecs_array_t *queries;             /* Queries, matched with new tables */
+
+
+    /* -- Deferred notifications -- */
+
+    ecs_event_queue_t add_events;     /* Deferred OnAdd notifications */
+    ecs_event_queue_t set_events;     /* Deferred OnSet notifications */
 
 
     /* -- Staging -- */
@@ -309,6 +491,22 @@ struct ecs_world_t {
     ecs_os_mutex_t job_mutex;        /* Mutex for protecting job counter */
     uint32_t jobs_finished;          /* Number of jobs finished */
     uint32_t threads_running;        /* Number of threads running */
+    uint32_t threads_created;        /* Threads in pool, including parked */
+    ecs_scheduler_t scheduler;       /* External scheduler, if set */
+    float job_delta_time;            /* Delta time passed to jobs */
+    void *job_param;                 /* Param passed to jobs */
+    uint32_t async_id;               /* Handle of last async run */
+    ecs_array_t *async_jobs;         /* Jobs of async run */
+    bool async_pending;              /* Is async run in progress */
+    bool async_staged;               /* Did async run set in_progress */
+
+    ecs_array_t *store_snapshot;     /* Store systems ran by store thread */
+    ecs_thread_t store_thread;       /* Runs store phases of previous frame */
+    ecs_os_cond_t store_cond;        /* Signal store work posted or done */
+    ecs_os_mutex_t store_mutex;      /* Mutex for store_pending, store_quit */
+    bool store_pending;              /* Does store thread have work */
+    bool store_quit;                 /* Signal store thread to quit */
+    bool pipelined;                  /* Overlap store phases with next frame */
 
     ecs_entity_t last_handle;        /* Last issued handle */
 
@@ -320,17 +518,29 @@ struct ecs_world_t {
     ecs_type_t t_prefab;
     ecs_type_t t_row_system;
     ecs_type_t t_col_system;
+    ecs_type_t t_parent;              /* Created when first parent is set */
+    ecs_entity_t e_parent;
 
 
     /* -- Time management -- */
 
     uint32_t tick;                /* Number of computed frames by world */
+    uint32_t frame_count;         /* Frames computed since world creation */
+    uint32_t row_changes;         /* Rows added to/removed from main stage */
     ecs_time_t frame_start;  /* Starting timestamp of frame */
     float frame_time;             /* Time spent processing a frame */
     float system_time;            /* Time spent processing systems */
     float merge_time;             /* Time spent on merging */
+    ecs_phase_time_t pre_update_time; /* Time spent by workers per phase */
+    ecs_phase_time_t on_update_time;
+    ecs_phase_time_t on_validate_time;
+    ecs_phase_time_t post_update_time;
+    ecs_phase_time_t *phase_time; /* Phase currently ran by workers */
     float target_fps;             /* Target fps */
-    float fps_sleep;              /* Sleep time to prevent fps overshoot */
+    double frame_deadline;        /* Time at which the last frame ended when
+                                   * pacing to the target fps (0 if unset) */
+    float frame_budget;           /* Time after which deferrable systems are
+                                   * skipped */
 
 
     /* -- Settings from command line arguments -- */
@@ -339,6 +549,19 @@ struct ecs_world_t {
     int arg_threads;
 
 
+    /* -- Garbage collection -- */
+
+    uint32_t gc_frames;           /* Frames after which idle tables are collected */
+
+
+    /* -- Defragmentation -- */
+
+    float defrag_budget;          /* Time per frame spent on defragmenting */
+    uint32_t defrag_cursor;       /* Next table to defragment */
+    ecs_entity_t defrag_component; /* Component that rows are ordered by */
+    ecs_compare_action_t defrag_compare; /* Compares values of component */
+
+
     /* -- World state -- */
 
     bool valid_schedule;          /* Is job schedule still valid */
@@ -346,10 +569,12 @@ struct ecs_world_t {
     bool in_progress;             /* Is world being progressed */
     bool is_merging;              /* Is world currently being merged */
     bool auto_merge;              /* Are stages auto-merged by ecs_progress */
+    bool defer_events;            /* Are OnAdd/OnSet notifications deferred */
     bool measure_frame_time;      /* Time spent on each frame */
     bool measure_system_time;     /* Time spent by each system */
     bool should_quit;             /* Did a system signal that app should quit */
     bool should_match;            /* Should tablea be rematched */
+    bool hierarchy_dirty;         /* Do tables with parent column need sorting */
 };
 
 
@@ -359,7 +584,11 @@ extern const ecs_array_params_t stage_arr_params;
 extern const ecs_array_params_t table_arr_params;
 extern const ecs_array_params_t thread_arr_params;
 extern const ecs_array_params_t job_arr_params;
+extern const ecs_array_params_t job_cost_arr_params;
 extern const ecs_array_params_t column_arr_params;
+extern const ecs_array_params_t ptr_arr_params;
+extern const ecs_array_params_t row_system_arr_params;
+extern const ecs_array_params_t reference_arr_params;
 
 
 #endif
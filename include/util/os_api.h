@@ -34,6 +34,18 @@ void* (*ecs_os_api_calloc_t)(
     size_t num,
     size_t size);
 
+/* Invoked after a large column buffer has been (re)allocated, before the rows
+ * that were added are written. Can be used to back the buffer with huge pages,
+ * or to control NUMA placement. The worker is the index of the thread that
+ * owns the column (as passed to thread_affinity), or 0 for the main thread.
+ * Pages that held the rows before the buffer was reallocated may already have
+ * been touched when they were copied, so placement only applies to new pages. */
+typedef
+void (*ecs_os_api_advise_large_t)(
+    void *ptr,
+    size_t size,
+    uint32_t worker);
+
 
 /* Threads */
 typedef
@@ -49,6 +61,13 @@ typedef
 void* (*ecs_os_api_thread_join_t)(
     ecs_os_thread_t thread);
 
+/* Invoked for each worker thread, with the index of the worker. Can be used to
+ * pin worker threads to cores. */
+typedef
+void (*ecs_os_api_thread_affinity_t)(
+    ecs_os_thread_t thread,
+    uint32_t index);
+
 
 /* Mutex */
 typedef
@@ -110,10 +129,12 @@ typedef struct ecs_os_api_t {
     ecs_os_api_realloc_t realloc;
     ecs_os_api_calloc_t calloc;
     ecs_os_api_free_t free;
+    ecs_os_api_advise_large_t advise_large;
 
     /* Threads */
     ecs_os_api_thread_new_t thread_new;
     ecs_os_api_thread_join_t thread_join;
+    ecs_os_api_thread_affinity_t thread_affinity;
 
     /* Mutex */
     ecs_os_api_mutex_new_t mutex_new;
@@ -152,6 +173,9 @@ void ecs_set_os_api_defaults(void);
 #define ecs_os_free(ptr) ecs_os_api.free(ptr);
 #define ecs_os_realloc(ptr, size) ecs_os_api.realloc(ptr, size)
 #define ecs_os_calloc(num, size) ecs_os_api.calloc(num, size)
+#define ecs_os_advise_large(ptr, size, worker)\
+    (ecs_os_api.advise_large ?\
+        ecs_os_api.advise_large(ptr, size, worker) : (void)0)
 
 #ifdef _MSC_VER
 #define ecs_os_alloca(type, count) _alloca(sizeof(type) * (count))
@@ -162,6 +186,8 @@ void ecs_set_os_api_defaults(void);
 /* Threads */
 #define ecs_os_thread_new(callback, param) ecs_os_api.thread_new(callback, param)
 #define ecs_os_thread_join(thread) ecs_os_api.thread_join(thread)
+#define ecs_os_thread_affinity(thread, index)\
+    (ecs_os_api.thread_affinity ? ecs_os_api.thread_affinity(thread, index) : (void)0)
 
 /* Mutex */
 #define ecs_os_mutex_new() ecs_os_api.mutex_new()
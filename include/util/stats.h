@@ -62,6 +62,10 @@ typedef struct ecs_world_stats_t {
     float system_time;
     float frame_time;
     float merge_time;
+    float pre_update_imbalance;
+    float on_update_imbalance;
+    float on_validate_imbalance;
+    float post_update_imbalance;
     EcsMemoryStats memory;
     ecs_array_t *features;
     ecs_array_t *on_load_systems;
@@ -0,0 +1,105 @@
+#include "include/util/time.h"
+#include "include/private/flecs.h"
+
+/** Order entities by id, so that entities created together are stored next
+ * to each other */
+static
+int compare_entity(
+    ecs_entity_t e1,
+    void *ptr1,
+    ecs_entity_t e2,
+    void *ptr2)
+{
+    (void)ptr1;
+    (void)ptr2;
+    return (e1 > e2) - (e1 < e2);
+}
+
+/** Restore the order of rows in a table. Returns whether rows were moved. */
+static
+bool defragment_table(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    /* Don't undo the order of a sorted system, or the table would be sorted
+     * back and forth every frame */
+    if (table->is_sorted || ecs_table_count(table) < 2) {
+        return false;
+    }
+
+    /* Siblings are ordered by id, but the hierarchy order is preserved */
+    if (table->parent_column) {
+        return ecs_hierarchy_defragment_table(world, table);
+    }
+
+    ecs_entity_t component = world->defrag_component;
+    if (component && ecs_type_index_of(table->type, component) != -1) {
+        return ecs_table_sort(world, table, component, world->defrag_compare);
+    }
+
+    return ecs_table_sort(world, table, 0, compare_entity);
+}
+
+/* -- Public functions -- */
+
+uint32_t ecs_defragment(
+    ecs_world_t *world,
+    float time_budget)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    /* Rows can't move while systems run asynchronously */
+    ecs_wait_for_async(world);
+
+    ecs_table_t *tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t i, count = ecs_array_count(world->main_stage.tables);
+    uint32_t cursor = world->defrag_cursor, result = 0;
+    double elapsed = 0;
+
+    ecs_time_t t;
+    ecs_os_get_time(&t);
+
+    for (i = 0; i < count; i ++) {
+        if (cursor >= count) {
+            cursor = 0;
+        }
+
+        result += defragment_table(world, &tables[cursor]);
+        cursor ++;
+
+        /* At least one table is visited, so that a small budget still makes
+         * progress */
+        if (time_budget) {
+            elapsed += ecs_time_measure(&t);
+            if (elapsed >= time_budget) {
+                break;
+            }
+        }
+    }
+
+    world->defrag_cursor = cursor;
+
+    return result;
+}
+
+void ecs_set_defragment(
+    ecs_world_t *world,
+    float time_budget)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(time_budget >= 0, ECS_INVALID_PARAMETERS, NULL);
+    world->defrag_budget = time_budget;
+}
+
+void _ecs_set_defragment_order(
+    ecs_world_t *world,
+    ecs_entity_t component,
+    ecs_compare_action_t compare)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!component || compare != NULL, ECS_INVALID_PARAMETERS, NULL);
+    world->defrag_component = component;
+    world->defrag_compare = compare;
+}
@@ -108,6 +108,11 @@ void* get_ptr(
 
     ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INTERNAL_ERROR, NULL);
 
+    /* Singleton components may be stored by the world, not in a table */
+    if (!entity && world->singleton_slots) {
+        return ecs_singleton_get(world, stage, component);
+    }
+
     if (world->in_progress && stage != &world->main_stage) {
         row_64 = ecs_map_get64(stage->entity_index, entity);
         if (row_64) {
@@ -159,6 +164,17 @@ void* get_ptr(
 
         if (type_id && search_prefab) {
             prefab = ecs_map_get64(world->prefab_index, type_id);
+
+            /* Values of the prefab are cached by the table. Worker threads
+             * don't use the cache, as they may run concurrently. The cache is
+             * also not used when the prefab has been changed in the stage. */
+            if (prefab && component != EEcsId && component != EEcsPrefab &&
+                (!world->in_progress || (stage == &world->temp_stage &&
+                 !ecs_map_has(stage->entity_index, prefab, NULL))))
+            {
+                return ecs_table_get_shared(
+                    world, info->table, prefab, component);
+            }
         }
     }
 
@@ -177,76 +193,75 @@ void* get_ptr(
     }
 }
 
+/** Initialize count elements from a single value. Each memcpy doubles the
+ * number of initialized elements. */
+static
+void fill_column(
+    void *dst,
+    const void *value,
+    uint32_t size,
+    uint32_t count)
+{
+    memcpy(dst, value, size);
+
+    uint32_t copied = 1;
+    while (copied < count) {
+        uint32_t n = count - copied < copied ? count - copied : copied;
+        memcpy(ECS_OFFSET(dst, copied * size), dst, n * size);
+        copied += n;
+    }
+}
+
 /** Copy default values from base (and base of base) prefabs */
 static
 void copy_from_prefab(
     ecs_world_t *world,
     ecs_stage_t *stage,
     ecs_table_t *table,
-    ecs_entity_t entity,
     uint32_t offset,
     uint32_t limit,
     ecs_type_t type_id,
     ecs_type_t to_add)
 {
-    ecs_entity_t prefab;
-    ecs_type_t entity_type = type_id;
-
-    if (world->in_progress) {
-        uint64_t row64 = ecs_map_get64(stage->entity_index, entity);
-        if (row64) {
-            ecs_row_t row = ecs_to_row(row64);
-            entity_type = row.type_id;
-        }
+    if (!limit || !ecs_map_get64(world->prefab_index, type_id)) {
+        return;
     }
 
-    while ((prefab = ecs_map_get64(world->prefab_index, entity_type))) {
-        /* Prefabs are only resolved from the main stage. Prefabs created while
-         * iterating cannot be resolved in the same iteration. */
-        ecs_row_t row = ecs_to_row(ecs_map_get64(world->main_stage.entity_index, prefab));
+    /* Worker threads may instantiate prefabs concurrently, and don't use the
+     * plans cached by the table */
+    bool is_worker = 
+        stage != &world->main_stage && stage != &world->temp_stage;
 
-        ecs_table_t *prefab_table = ecs_world_get_table(
-            world, stage, row.type_id);
-
-        ecs_array_t *add_type = ecs_type_get(world, stage, to_add);
-        ecs_entity_t *add_handles = ecs_array_buffer(add_type);
-        uint32_t i, add_count = ecs_array_count(add_type);
+    ecs_array_t *plan;
+    if (is_worker) {
+        plan = ecs_table_new_instantiate_plan(world, stage, table, to_add);
+    } else {
+        plan = ecs_table_get_instantiate_plan(world, stage, table, to_add);
+    }
 
-        ecs_table_column_t *columns = NULL;
+    ecs_prefab_column_t *buffer = ecs_array_buffer(plan);
+    uint32_t i, count = ecs_array_count(plan);
 
-        for (i = 0; i < add_count; i ++) {
-            ecs_entity_t component = add_handles[i];
-            void *prefab_ptr = get_row_ptr(
-                prefab_table->type, prefab_table->columns,
-                row.index, component);
+    if (count) {
+        ecs_table_column_t *columns;
+        if (world->in_progress) {
+            columns = ecs_map_get(stage->data_stage, type_id);
+        } else {
+            columns = table->columns;
+        }
 
-            if (prefab_ptr) {
-                if (!columns) {
-                    if (world->in_progress) {
-                        columns = ecs_map_get(stage->data_stage, type_id);
-                    } else {
-                        columns = table->columns;
-                    }
-                }
+        for (i = 0; i < count; i ++) {
+            ecs_prefab_column_t *column = &buffer[i];
+            void *ptr = ECS_OFFSET(
+                ecs_array_buffer(columns[column->column].data), 
+                offset * column->size);
 
-                ecs_array_t *type_arr = ecs_type_get(world, stage, type_id);
-                uint32_t column_index = ecs_type_index_of(type_arr, component);
-                uint32_t size = columns[column_index + 1].size;
-
-                if (size) {
-                    void *buffer = ecs_array_buffer(columns[column_index + 1].data);
-                    void *ptr = ECS_OFFSET(buffer, offset * size);
-                    uint32_t i;
-                    for (i = 0; i < limit; i ++) {
-                        memcpy(ptr, prefab_ptr, size);
-                        ptr = ECS_OFFSET(ptr, size);
-                    }
-                }
-            }
+            fill_column(ptr, column->value, column->size, limit);
         }
+    }
 
-        /* Recursively search through prefabs */
-        entity_type = row.type_id;
+    if (is_worker) {
+        ecs_array_free(plan);
     }
 }
 
@@ -261,12 +276,18 @@ bool notify_pre_merge(
     ecs_map_t *systems)
 {
     ecs_world_t *real_world = world;
-    ecs_get_stage(&real_world);
+    ecs_stage_t *stage = ecs_get_stage(&real_world);
     
     if (real_world->is_merging) {
         return false;
     }
 
+    if (ecs_defer_event(
+        real_world, stage, systems, to_init, table_columns, offset, limit))
+    {
+        return false;
+    }
+
     bool in_progress = real_world->in_progress;
     real_world->in_progress = true;
 
@@ -309,6 +330,53 @@ bool notify_post_merge(
     return result;
 }
 
+/** Record which components of a watched entity changed, so that only systems
+ * that use these components and tables that have the entity in their type are
+ * rematched. While in progress, the change is recorded when the stage is
+ * merged, as the merge commits the entity to the main stage. */
+static
+void record_watched_change(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_type_t old_type_id,
+    ecs_type_t type_id)
+{
+    if (world->in_progress) {
+        return;
+    }
+
+    ecs_map_t *type_index = world->main_stage.type_index;
+    ecs_map_t *changed = world->changed_components;
+    ecs_array_t *old_type = ecs_map_get(type_index, old_type_id);
+    ecs_array_t *new_type = ecs_map_get(type_index, type_id);
+    ecs_entity_t *old_buffer = ecs_array_buffer(old_type);
+    ecs_entity_t *new_buffer = ecs_array_buffer(new_type);
+    uint32_t i_old = 0, old_count = ecs_array_count(old_type);
+    uint32_t i_new = 0, new_count = ecs_array_count(new_type);
+
+    ecs_map_set64(world->changed_containers, entity, 1);
+
+    /* Types are sorted, so the changed components can be found in one pass */
+    while (i_old < old_count || i_new < new_count) {
+        if (i_new == new_count || 
+           (i_old < old_count && old_buffer[i_old] < new_buffer[i_new])) 
+        {
+            ecs_map_set64(changed, old_buffer[i_old], 1);
+            i_old ++;
+        } else if (i_old == old_count || 
+           new_buffer[i_new] < old_buffer[i_old]) 
+        {
+            ecs_map_set64(changed, new_buffer[i_new], 1);
+            i_new ++;
+        } else {
+            i_old ++;
+            i_new ++;
+        }
+    }
+
+    world->should_match = true;
+}
+
 /** Commit an entity with a specified type to memory */
 static
 uint32_t commit_w_type(
@@ -364,7 +432,7 @@ uint32_t commit_w_type(
     }
 
     if (old_index < 0) {
-        world->should_match = true;
+        record_watched_change(world, entity, old_type_id, type_id);
     }
 
     if (type_id) {
@@ -385,7 +453,8 @@ uint32_t commit_w_type(
                 new_columns = ecs_table_get_columns(world, stage, type);
             }
 
-            new_index = ecs_table_insert(world, new_table, new_columns, entity);
+            new_index = ecs_table_insert(
+                world, stage, new_table, new_columns, entity);
             assert(new_index != 0);
 
             if (new_columns != columns) {
@@ -393,7 +462,7 @@ uint32_t commit_w_type(
             }
         } else {
             new_index = ecs_table_insert(
-                world, new_table, new_table->columns, entity);
+                world, stage, new_table, new_table->columns, entity);
 
             new_columns = new_table->columns;
         }
@@ -402,6 +471,14 @@ uint32_t commit_w_type(
     if (old_type_id && type_id) {
         copy_row(new_table->type, new_columns, new_index, 
             old_type, old_columns, old_index);
+
+        /* A disabled entity stays disabled when it moves to another table */
+        if (!in_progress && old_table->disabled_count) {
+            int32_t old_row = old_index < 0 ? -old_index : old_index;
+            if (!ecs_table_is_enabled(old_table, old_row - 1)) {
+                ecs_table_set_enabled(new_table, new_index - 1, false);
+            }
+        }
     }
 
     if (type_id) {
@@ -426,6 +503,14 @@ uint32_t commit_w_type(
     if (!in_progress) {
         bool merged = false;
 
+        /* A child that loses its parent column is no longer a child */
+        if (old_type_id && old_table->parent_column && 
+           (!new_table || !new_table->parent_column)) 
+        {
+            ecs_hierarchy_remove_row(
+                world, old_table, old_columns, old_index, entity);
+        }
+
         /* Invoke the OnRemove callbacks when there are components to remove,
          * but only when not in progress. If we are currently in progress, the
          * OnRemove handlers will be invoked during the merge at the end of the
@@ -452,6 +537,11 @@ uint32_t commit_w_type(
         if (!merged && old_type_id) {
             ecs_table_delete(world, old_table, old_index);
         }
+
+        /* Children of a deleted parent become root entities */
+        if (!type_id) {
+            ecs_hierarchy_orphan_children(world, entity);
+        }
     }
 
     /* After the entity has been created in the new table and the stage is
@@ -463,14 +553,10 @@ uint32_t commit_w_type(
                 world->type_sys_add_index);
 
             copy_from_prefab(
-                world, stage, new_table, entity, new_index - 1, 1, type_id, to_add);
+                world, stage, new_table, new_index - 1, 1, type_id, to_add);
         }     
     }
 
-    /* This is a crude way to signal to the world that we need to redetermine
-     * the schedule for the worker threads */
-    world->valid_schedule = false;
-
     return new_index;
 }
 
@@ -490,12 +576,53 @@ bool ecs_notify(
     bool notified = false;
 
     if (systems) {
-        ecs_entity_t *buffer = ecs_array_buffer(systems);
+        ecs_world_t *real_world = world;
+        if (world->magic == ECS_THREAD_MAGIC) {
+            real_world = ((ecs_thread_t*)world)->world; /* dispel the magic */
+        }
+
+        /* Worker threads only run while the world is in progress, when tables
+         * that store systems don't change */
+        ecs_world_sync_systems(real_world);
+
+        ecs_row_system_ref_t *buffer = ecs_array_buffer(systems);
         uint32_t i, count = ecs_array_count(systems);
 
+        /* Column maps are computed for the type a system was matched with. If
+         * a subset of the table type is notified, use the maps computed for
+         * the table type. Both arrays are ordered by system handle, as systems
+         * are matched with types in the order in which they are created. */
+        ecs_row_system_ref_t *table_buffer = buffer;
+        uint32_t t = 0, table_count = count;
+
+        if (type_id != table->type_id) {
+            ecs_array_t *table_systems = ecs_map_get(index, table->type_id);
+            table_buffer = ecs_array_buffer(table_systems);
+            table_count = ecs_array_count(table_systems);
+        }
+
         for (i = 0; i < count; i ++) {
-            notified |= ecs_notify_row_system(
-                world, buffer[i], table->type, table_columns, offset, limit);
+            ecs_row_system_ref_t *ref = &buffer[i];
+            int32_t *columns = ref->columns;
+
+            if (table_buffer != buffer) {
+                while (t < table_count && table_buffer[t].system < ref->system) {
+                    t ++;
+                }
+
+                if (t < table_count && table_buffer[t].system == ref->system) {
+                    columns = table_buffer[t].columns;
+                } else {
+                    /* Table type was created while in progress, and has not
+                     * been matched with row systems */
+                    columns = ecs_os_alloca(
+                        int32_t, ecs_array_count(ref->data->base.columns));
+                    ecs_row_system_columns(ref->data, table->type, columns);
+                }
+            }
+
+            notified |= ecs_notify_row_system(world, ref->system, ref->data, 
+                columns, table_columns, offset, limit);
         }
     } 
 
@@ -518,8 +645,12 @@ void ecs_merge_entity(
 
     ecs_type_t to_remove = ecs_map_get64(stage->remove_merge, entity);
     ecs_type_t staged_id = staged_row->type_id;
+
+    /* Types of the stage have already been merged, so a type that is created
+     * here must be registered with the main stage, where the table is created */
     ecs_type_t type_id = ecs_type_merge(
-        world, stage, old_row.type_id, staged_row->type_id, to_remove);
+        world, &world->main_stage, old_row.type_id, staged_row->type_id, 
+        to_remove);
 
     ecs_entity_info_t info = {
         .entity = entity,
@@ -528,6 +659,9 @@ void ecs_merge_entity(
         .index = old_row.index
     };
 
+    /* Tables may be reallocated by the commit */
+    bool had_parent = old_table && old_table->parent_column;
+
     uint32_t new_index = commit_w_type(
         world, &world->main_stage, &info, type_id, 0, to_remove);
 
@@ -541,6 +675,16 @@ void ecs_merge_entity(
 
         copy_row( new_table->type, new_table->columns, new_index,
                   staged_table->type, staged_columns, staged_row->index); 
+
+        /* Entities that got a parent column while in progress, like clones of
+         * a child, are added to the children of their parent */
+        if (new_table->parent_column && !had_parent) {
+            ecs_hierarchy_add_row(
+                world, new_table, new_table->columns, new_index, entity);
+        }
+
+        /* Any of the columns may have been set in the stage */
+        ecs_table_column_changed(new_table, 0);
     }
 }
 
@@ -566,9 +710,32 @@ void ecs_set_watching(
         }
     }
 
+    ecs_map_set64(world->changed_containers, entity, 1);
     world->should_match = true;
 }
 
+void ecs_set_entity_enabled(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    bool enabled)
+{
+    uint64_t row64 = ecs_map_get64(world->main_stage.entity_index, entity);
+    if (!row64) {
+        return;
+    }
+
+    ecs_row_t row = ecs_to_row(row64);
+    if (!row.type_id) {
+        return;
+    }
+
+    ecs_table_t *table = ecs_world_get_table(
+        world, &world->main_stage, row.type_id);
+    int32_t index = row.index < 0 ? -row.index : row.index;
+
+    ecs_table_set_enabled(table, index - 1, enabled);
+}
+
 bool ecs_components_contains_component(
     ecs_world_t *world,
     ecs_type_t table_type,
@@ -626,8 +793,9 @@ ecs_entity_t ecs_clone(
 
             commit_w_type(world, stage, &info, type_id, type_id, 0);
 
-            if (copy_value) {
-                ecs_table_t *from_table = ecs_world_get_table(world, stage, type_id);
+            ecs_table_t *from_table = ecs_world_get_table(world, stage, type_id);
+
+            if (copy_value || from_table->parent_column) {
                 ecs_table_column_t *to_columns = NULL, *from_columns = from_table->columns;
                 ecs_table_t *to_table = ecs_world_get_table(world, stage, type_id);
                 ecs_row_t to_row = {0};
@@ -650,13 +818,29 @@ ecs_entity_t ecs_clone(
                     to_row = ecs_to_row(ecs_map_get64(
                             world->main_stage.entity_index, result));
 
-                copy_row(to_table->type, to_columns, to_row.index,
-                    from_table->type, from_columns, row.index);
+                if (copy_value) {
+                    copy_row(to_table->type, to_columns, to_row.index,
+                        from_table->type, from_columns, row.index);
+                } else {
+                    /* A clone has the same parent as the cloned entity */
+                    uint32_t column = from_table->parent_column;
+                    copy_column(&to_columns[column], to_row.index, 
+                        &from_columns[column], row.index);
+                }
+
+                /* Staged clones are added to the children of their parent
+                 * when they are merged */
+                if (to_table->parent_column && !world->in_progress) {
+                    ecs_hierarchy_add_row(
+                        world, to_table, to_columns, to_row.index, result);
+                }
 
                 /* A clone with value is equivalent to a set */
-                ecs_notify(
-                    world_arg, world->type_sys_set_index, from_table->type_id, 
-                    to_table, to_columns, to_row.index - 1, 1);
+                if (copy_value) {
+                    notify_pre_merge(
+                        world_arg, to_table, to_columns, to_row.index - 1, 1,
+                        from_table->type_id, world->type_sys_set_index);
+                }
             }
         }
     }
@@ -664,6 +848,149 @@ ecs_entity_t ecs_clone(
     return result;
 }
 
+ecs_entity_t ecs_clone_w_count(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    uint32_t count,
+    bool copy_value)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    ecs_world_t *world_arg = world;
+    ecs_stage_t *stage = ecs_get_stage(&world);
+
+    ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    if (!count) {
+        return 0;
+    }
+
+    /* Staged clones are stored in the data stage of the thread, and are merged
+     * individually */
+    if (world->in_progress) {
+        ecs_entity_t result = ecs_clone(world_arg, entity, copy_value);
+        uint32_t i;
+        for (i = 1; i < count; i ++) {
+            ecs_clone(world_arg, entity, copy_value);
+        }
+        return result;
+    }
+
+    ecs_entity_t result = world->last_handle + 1;
+    world->last_handle += count;
+
+    if (!entity) {
+        return result;
+    }
+
+    ecs_row_t row = ecs_to_row(ecs_map_get64(stage->entity_index, entity));
+    ecs_type_t type_id = row.type_id;
+    if (!type_id) {
+        return result;
+    }
+
+    ecs_table_t *table = ecs_world_get_table(world, stage, type_id);
+    uint32_t first = ecs_table_grow(
+        world, stage, table, table->columns, count, result);
+
+    ecs_map_t *entity_index = stage->entity_index;
+    ecs_map_set_size(entity_index, ecs_map_count(entity_index) + count);
+
+    uint32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_row_t new_row = {.type_id = type_id, .index = first + i};
+        ecs_map_set64(entity_index, result + i, ecs_from_row(new_row));
+    }
+
+    /* Clones have the same parent as the cloned entity */
+    if (table->parent_column) {
+        ecs_table_column_t *column = &table->columns[table->parent_column];
+        for (i = 0; i < count; i ++) {
+            copy_column(column, first + i, column, row.index);
+            ecs_hierarchy_add_row(
+                world, table, table->columns, first + i, result + i);
+        }
+    }
+
+    /* Notify OnAdd systems once for all clones */
+    bool merged = notify_pre_merge(
+        world_arg, table, table->columns, first - 1, count, type_id,
+        world->type_sys_add_index);
+
+    copy_from_prefab(
+        world, stage, table, first - 1, count, type_id, type_id);
+
+    if (!copy_value) {
+        return result;
+    }
+
+    /* OnAdd systems may have moved the source or the clones */
+    if (merged) {
+        row = ecs_to_row(ecs_map_get64(entity_index, entity));
+
+        for (i = 0; i < count; i ++) {
+            ecs_row_t clone_row = ecs_to_row(
+                ecs_map_get64(entity_index, result + i));
+            if (clone_row.type_id != type_id ||
+                clone_row.index != (int32_t)(first + i))
+            {
+                break;
+            }
+        }
+
+        if (i != count || row.type_id != type_id) {
+            ecs_table_t *from_table = ecs_world_get_table(
+                world, stage, row.type_id);
+
+            for (i = 0; i < count; i ++) {
+                ecs_row_t clone_row = ecs_to_row(
+                    ecs_map_get64(entity_index, result + i));
+                if (!clone_row.type_id) {
+                    continue;
+                }
+
+                ecs_table_t *to_table = ecs_world_get_table(
+                    world, stage, clone_row.type_id);
+                int32_t index = clone_row.index < 0 
+                    ? -clone_row.index 
+                    : clone_row.index;
+
+                copy_row(to_table->type, to_table->columns, index,
+                    from_table->type, from_table->columns, row.index);
+
+                notify_pre_merge(
+                    world_arg, to_table, to_table->columns, index - 1, 1, 
+                    from_table->type_id, world->type_sys_set_index);
+            }
+
+            return result;
+        }
+    }
+
+    /* Replicate the row of the source entity into the rows of the clones */
+    int32_t src_row = (row.index < 0 ? -row.index : row.index) - 1;
+    uint32_t column_count = ecs_array_count(table->type);
+
+    for (i = 1; i < column_count + 1; i ++) {
+        ecs_table_column_t *column = &table->columns[i];
+        uint32_t size = column->size;
+        if (!size) {
+            continue;
+        }
+
+        void *buffer = ecs_array_buffer(column->data);
+        fill_column(ECS_OFFSET(buffer, (first - 1) * size),
+            ECS_OFFSET(buffer, src_row * size), size, count);
+    }
+
+    /* A clone with value is equivalent to a set */
+    notify_pre_merge(
+        world_arg, table, table->columns, first - 1, count, type_id,
+        world->type_sys_set_index);
+
+    return result;
+}
+
 ecs_entity_t _ecs_new(
     ecs_world_t *world,
     ecs_type_t type)
@@ -702,7 +1029,8 @@ ecs_entity_t _ecs_new_w_count(
 
     if (type) {
         ecs_table_t *table = ecs_world_get_table(world, stage, type);
-        uint32_t row = ecs_table_grow(world, table, table->columns, count, result);
+        uint32_t row = ecs_table_grow(
+            world, stage, table, table->columns, count, result);
 
         ecs_map_t *entity_index = stage->entity_index;
 
@@ -726,7 +1054,7 @@ ecs_entity_t _ecs_new_w_count(
             type, world->type_sys_add_index);
         
         /* Check if there are prefabs */
-        copy_from_prefab(world, stage, table, result, row - 1, count, type, type);
+        copy_from_prefab(world, stage, table, row - 1, count, type, type);
     } 
 
     return result;
@@ -756,6 +1084,9 @@ void ecs_delete(
             commit_w_type(world, stage, &info, 0, 0, row.type_id);
 
             ecs_map_remove(world->main_stage.entity_index, entity);
+        } else {
+            /* An entity without components can still be a parent */
+            ecs_hierarchy_orphan_children(world, entity);
         }
     } else {
         /* Mark components of the entity in the main stage as removed. This will
@@ -781,6 +1112,12 @@ void _ecs_add(
     ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
     ecs_stage_t *stage = ecs_get_stage(&world);
     ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    /* Singleton components may be stored by the world, not in a table */
+    if (!entity && world->singleton_slots) {
+        ecs_singleton_add(world, stage, type);
+        return;
+    }
     
     ecs_map_t *entity_index = stage->entity_index;
     ecs_type_t dst_type = 0;
@@ -811,6 +1148,10 @@ void _ecs_remove(
     ecs_stage_t *stage = ecs_get_stage(&world);
     ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
 
+    /* Pointers to singleton values remain valid until the world is deleted */
+    ecs_assert(entity != 0 || !world->singleton_slots, ECS_INVALID_PARAMETERS, 
+        "singleton components can't be removed");
+
     ecs_map_t *entity_index = stage->entity_index;
     ecs_type_t dst_type = 0;
     ecs_entity_info_t info = {.entity = entity};
@@ -831,6 +1172,54 @@ void _ecs_remove(
     commit_w_type(world, stage, &info, dst_type, 0, type);
 }
 
+void ecs_enable_entity(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    bool enabled)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_stage_t *stage = ecs_get_stage(&world);
+    ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    if (world->in_progress) {
+        ecs_map_set64(stage->enabled_merge, entity, 
+            enabled ? ECS_ENTITY_ENABLED : ECS_ENTITY_DISABLED);
+    } else {
+        ecs_set_entity_enabled(world, entity, enabled);
+    }
+}
+
+bool ecs_is_entity_enabled(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_stage_t *stage = ecs_get_stage(&world);
+
+    if (world->in_progress) {
+        uint64_t enabled = ecs_map_get64(stage->enabled_merge, entity);
+        if (enabled) {
+            return enabled == ECS_ENTITY_ENABLED;
+        }
+    }
+
+    uint64_t row64 = ecs_map_get64(world->main_stage.entity_index, entity);
+    if (!row64) {
+        return true;
+    }
+
+    ecs_row_t row = ecs_to_row(row64);
+    if (!row.type_id) {
+        return true;
+    }
+
+    ecs_table_t *table = ecs_world_get_table(
+        world, &world->main_stage, row.type_id);
+    int32_t index = row.index < 0 ? -row.index : row.index;
+
+    return ecs_table_is_enabled(table, index - 1);
+}
+
 ecs_entity_t _ecs_new_child(
     ecs_world_t *world,
     ecs_entity_t parent,
@@ -940,6 +1329,12 @@ ecs_entity_t _ecs_set_ptr_intern(
 
     memcpy(dst, ptr, size);
 
+    /* Values set in a stage are registered as changed when they are merged */
+    if (info.columns == info.table->columns) {
+        ecs_table_column_changed(info.table, 
+            ecs_type_index_of(info.table->type, component) + 1);
+    }
+
     notify_pre_merge(
         world_arg, info.table, info.columns, info.index - 1, 1, type,
         world->type_sys_set_index);
@@ -971,6 +1366,13 @@ ecs_entity_t _ecs_set_singleton_ptr(
     size_t size,
     void *ptr)
 {
+    ecs_world_t *real_world = world;
+    ecs_get_stage(&real_world);
+
+    if (real_world->singleton_slots) {
+        return ecs_singleton_set(world, type, size, ptr);
+    }
+
     return _ecs_set_ptr_intern(world, 0, type, size, ptr);
 }
 
@@ -987,6 +1389,11 @@ bool _ecs_has(
 
     ecs_world_t *world_arg = world;
     ecs_stage_t *stage = ecs_get_stage(&world);
+
+    if (!entity && world->singleton_slots) {
+        return ecs_singleton_has(world, stage, type, true);
+    }
+
     ecs_type_t entity_type = ecs_get_type(world_arg, entity);
 
     return ecs_type_contains(world, stage, entity_type, type, true, true) != 0;
@@ -1005,6 +1412,11 @@ bool _ecs_has_any(
 
     ecs_world_t *world_arg = world;
     ecs_stage_t *stage = ecs_get_stage(&world);
+
+    if (!entity && world->singleton_slots) {
+        return ecs_singleton_has(world, stage, type, false);
+    }
+
     ecs_type_t entity_type = ecs_get_type(world_arg, entity);
     return ecs_type_contains(world, stage, entity_type, type, false, true);
 }
@@ -90,6 +90,8 @@ const char* ecs_strerror(
         return "unresolved reference for system";
     case ECS_THREAD_ERROR:
         return "failed to create thread";
+    case ECS_INVALID_WHILE_ITERATING:
+        return "operation is invalid while iterating";
     }
 
     return "unknown error code";
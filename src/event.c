@@ -0,0 +1,311 @@
+#include <stdlib.h>
+#include "include/private/flecs.h"
+
+static
+const ecs_array_params_t event_arr_params = {
+    .element_size = sizeof(ecs_event_t)
+};
+
+/** Location of an entity for which a deferred event is delivered */
+typedef struct event_row_t {
+    uint32_t table;               /* Index of table in main stage */
+    ecs_type_t type;              /* Components to notify */
+    uint32_t row;                 /* Row of entity in table */
+} event_row_t;
+
+static
+int compare_row(
+    const void *p1,
+    const void *p2)
+{
+    const event_row_t *r1 = p1, *r2 = p2;
+
+    if (r1->table != r2->table) {
+        return r1->table < r2->table ? -1 : 1;
+    }
+
+    if (r1->type != r2->type) {
+        return r1->type < r2->type ? -1 : 1;
+    }
+
+    return (r1->row > r2->row) - (r1->row < r2->row);
+}
+
+/** Get the components of an event that the entity still has. Components that
+ * were removed before the event is delivered are not notified. */
+static
+ecs_type_t present_components(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_type_t type)
+{
+    if (ecs_type_contains(world, NULL, table->type_id, type, true, false)) {
+        return type;
+    }
+
+    ecs_array_t *components = ecs_type_get(world, NULL, type);
+    ecs_entity_t *buffer = ecs_array_buffer(components);
+    uint32_t i, count = ecs_array_count(components);
+    ecs_type_t result = 0;
+
+    for (i = 0; i < count; i ++) {
+        if (ecs_type_index_of(table->type, buffer[i]) != -1) {
+            result = ecs_type_add(world, NULL, result, buffer[i]);
+        }
+    }
+
+    return result;
+}
+
+static
+void queue_event(
+    ecs_world_t *world,
+    ecs_event_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_type_t type)
+{
+    uint64_t index = ecs_map_get64(queue->entity_index, entity);
+
+    if (index) {
+        ecs_event_t *event = ecs_array_get(
+            queue->events, &event_arr_params, index - 1);
+        event->type = ecs_type_merge(world, NULL, event->type, type, 0);
+    } else {
+        ecs_event_t *event = ecs_array_add(&queue->events, &event_arr_params);
+        event->entity = entity;
+        event->type = type;
+        ecs_map_set64(queue->entity_index, entity,
+            ecs_array_count(queue->events));
+    }
+}
+
+/** Add events that were deferred in a stage to a queue of the world */
+static
+void merge_events(
+    ecs_world_t *world,
+    ecs_event_queue_t *queue,
+    ecs_array_t *events)
+{
+    ecs_event_t *buffer = ecs_array_buffer(events);
+    uint32_t i, count = ecs_array_count(events);
+
+    for (i = 0; i < count; i ++) {
+        queue_event(world, queue, buffer[i].entity, buffer[i].type);
+    }
+
+    ecs_array_clear(events);
+}
+
+/** Deliver the events of a queue. Entities are sorted by table and row, so
+ * that entities in adjacent rows are passed to row systems in a single call. */
+static
+void flush_queue(
+    ecs_world_t *world,
+    ecs_event_queue_t *queue)
+{
+    uint32_t i, count = ecs_array_count(queue->events);
+    if (!count) {
+        return;
+    }
+
+    ecs_event_t *events = ecs_array_buffer(queue->events);
+    ecs_table_t *tables = ecs_array_buffer(world->main_stage.tables);
+    ecs_map_t *entity_index = world->main_stage.entity_index;
+    uint32_t row_count = 0;
+
+    event_row_t *rows = ecs_os_malloc(sizeof(event_row_t) * count);
+    ecs_assert(rows != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    for (i = 0; i < count; i ++) {
+        ecs_row_t row = ecs_to_row(ecs_map_get64(
+            entity_index, events[i].entity));
+
+        /* Entity was deleted before the event was delivered */
+        if (!row.type_id) {
+            continue;
+        }
+
+        ecs_table_t *table = ecs_world_get_table(
+            world, &world->main_stage, row.type_id);
+        ecs_type_t type = present_components(world, table, events[i].type);
+        if (!type) {
+            continue;
+        }
+
+        rows[row_count ++] = (event_row_t){
+            .table = table - tables,
+            .type = type,
+            .row = (row.index < 0 ? -row.index : row.index) - 1
+        };
+    }
+
+    ecs_array_clear(queue->events);
+    ecs_map_clear(queue->entity_index);
+
+    qsort(rows, row_count, sizeof(event_row_t), compare_row);
+
+    /* Row systems run as if in progress, so that the rows don't move while
+     * events are delivered. Their changes are merged afterwards. */
+    bool notified = false;
+    world->in_progress = true;
+
+    for (i = 0; i < row_count; ) {
+        event_row_t *first = &rows[i];
+        uint32_t run = 1;
+
+        while (i + run < row_count &&
+            rows[i + run].table == first->table &&
+            rows[i + run].type == first->type &&
+            rows[i + run].row == first->row + run)
+        {
+            run ++;
+        }
+
+        ecs_table_t *table = ecs_array_get(
+            world->main_stage.tables, &table_arr_params, first->table);
+
+        notified |= ecs_notify(world, queue->systems, first->type, table,
+            table->columns, first->row, run);
+
+        i += run;
+    }
+
+    world->in_progress = false;
+    ecs_os_free(rows);
+
+    if (notified) {
+        ecs_merge(world);
+    }
+}
+
+/* -- Private functions -- */
+
+void ecs_event_queue_init(
+    ecs_event_queue_t *queue,
+    ecs_map_t *systems)
+{
+    queue->events = ecs_array_new(&event_arr_params, 0);
+    queue->entity_index = ecs_map_new(0);
+    queue->systems = systems;
+}
+
+void ecs_event_queue_deinit(
+    ecs_event_queue_t *queue)
+{
+    ecs_array_free(queue->events);
+    ecs_map_free(queue->entity_index);
+}
+
+bool ecs_defer_event(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_map_t *systems,
+    ecs_type_t type,
+    ecs_table_column_t *table_columns,
+    uint32_t offset,
+    uint32_t limit)
+{
+    if (!world->defer_events) {
+        return false;
+    }
+
+    ecs_event_queue_t *queue;
+    ecs_array_t **stage_events;
+    if (systems == world->type_sys_add_index) {
+        queue = &world->add_events;
+        stage_events = &stage->add_events;
+    } else if (systems == world->type_sys_set_index) {
+        queue = &world->set_events;
+        stage_events = &stage->set_events;
+    } else {
+        return false;
+    }
+
+    /* Only queue events for which there are systems to notify */
+    if (!ecs_map_get(systems, type)) {
+        return true;
+    }
+
+    ecs_entity_t *entities = ecs_array_buffer(table_columns[0].data);
+    uint32_t i;
+
+    /* While in progress, the queues of the world may not be modified, as
+     * worker threads notify at the same time. Events are added to the stage
+     * and moved to the queues of the world when the stage is merged. */
+    if (world->in_progress) {
+        if (!*stage_events) {
+            *stage_events = ecs_array_new(&event_arr_params, limit);
+        }
+
+        for (i = offset; i < offset + limit; i ++) {
+            ecs_event_t *event = ecs_array_add(stage_events, &event_arr_params);
+            event->entity = entities[i];
+            event->type = type;
+        }
+    } else {
+        for (i = offset; i < offset + limit; i ++) {
+            queue_event(world, queue, entities[i], type);
+        }
+    }
+
+    return true;
+}
+
+void ecs_event_merge(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    if (stage->add_events) {
+        merge_events(world, &world->add_events, stage->add_events);
+    }
+
+    if (stage->set_events) {
+        merge_events(world, &world->set_events, stage->set_events);
+    }
+}
+
+void ecs_event_stage_deinit(
+    ecs_stage_t *stage)
+{
+    ecs_array_free(stage->add_events);
+    ecs_array_free(stage->set_events);
+    stage->add_events = NULL;
+    stage->set_events = NULL;
+}
+
+/* -- Public functions -- */
+
+void ecs_set_defer_events(
+    ecs_world_t *world,
+    bool defer)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    if (!defer) {
+        ecs_flush_events(world);
+    }
+
+    world->defer_events = defer;
+}
+
+void ecs_flush_events(
+    ecs_world_t *world)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    /* Systems that are notified of a set may add components, which triggers
+     * OnAdd systems. Those are deferred again, so repeat until both queues
+     * are empty. OnAdd systems are notified first, as they would be without
+     * deferring. */
+    while (ecs_array_count(world->add_events.events) ||
+           ecs_array_count(world->set_events.events))
+    {
+        flush_queue(world, &world->add_events);
+        flush_queue(world, &world->set_events);
+    }
+}
@@ -0,0 +1,465 @@
+#include <string.h>
+#include "include/private/flecs.h"
+
+static
+const ecs_array_params_t offset_arr_params = {
+    .element_size = sizeof(uint32_t)
+};
+
+/** Sort key of a row in a table with a parent column */
+typedef struct hierarchy_row_t {
+    uint32_t depth;
+    ecs_entity_t parent;
+    ecs_entity_t entity;
+    uint32_t row;
+} hierarchy_row_t;
+
+static
+int compare_row(
+    const void *p1,
+    const void *p2)
+{
+    const hierarchy_row_t *r1 = p1, *r2 = p2;
+
+    if (r1->depth != r2->depth) {
+        return r1->depth < r2->depth ? -1 : 1;
+    }
+
+    if (r1->parent != r2->parent) {
+        return r1->parent < r2->parent ? -1 : 1;
+    }
+
+    return (r1->row > r2->row) - (r1->row < r2->row);
+}
+
+/** Compare rows by depth and parent, and order children of the same parent by
+ * entity id */
+static
+int compare_row_entity(
+    const void *p1,
+    const void *p2)
+{
+    const hierarchy_row_t *r1 = p1, *r2 = p2;
+
+    if (r1->depth != r2->depth || r1->parent != r2->parent) {
+        return compare_row(p1, p2);
+    }
+
+    return (r1->entity > r2->entity) - (r1->entity < r2->entity);
+}
+
+/** Get table and (0-based) row of entity in main stage */
+static
+ecs_table_t* get_table(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    uint32_t *row_out)
+{
+    uint64_t row64 = ecs_map_get64(world->main_stage.entity_index, entity);
+    if (!row64) {
+        return NULL;
+    }
+
+    ecs_row_t row = ecs_to_row(row64);
+    if (!row.type_id) {
+        return NULL;
+    }
+
+    *row_out = (row.index < 0 ? -row.index : row.index) - 1;
+
+    return ecs_world_get_table(world, &world->main_stage, row.type_id);
+}
+
+/** Get pointer to parent column of entity, NULL if entity has no parent */
+static
+EcsParent* get_parent_ptr(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    uint32_t row;
+    ecs_table_t *table = get_table(world, entity, &row);
+    if (!table || !table->parent_column) {
+        return NULL;
+    }
+
+    EcsParent *parents = ecs_array_buffer(
+        table->columns[table->parent_column].data);
+
+    return &parents[row];
+}
+
+/** Get number of parents between entity and its root */
+static
+uint32_t get_depth(
+    ecs_world_t *world,
+    ecs_entity_t parent)
+{
+    uint32_t depth = 0;
+
+    while (parent) {
+        depth ++;
+        ecs_assert(depth < ECS_MAX_HIERARCHY_DEPTH, ECS_INVALID_PARAMETERS,
+            "cycle in hierarchy");
+        parent = ecs_hierarchy_get_parent(world, parent);
+    }
+
+    return depth;
+}
+
+/** Test if entity is one of the parents of another entity, or the entity */
+static
+bool is_ancestor(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_entity_t ancestor)
+{
+    uint32_t depth = 0;
+
+    while (entity) {
+        if (entity == ancestor) {
+            return true;
+        }
+
+        depth ++;
+        ecs_assert(depth < ECS_MAX_HIERARCHY_DEPTH, ECS_INVALID_PARAMETERS,
+            "cycle in hierarchy");
+        entity = ecs_hierarchy_get_parent(world, entity);
+    }
+
+    return false;
+}
+
+static
+void add_child(
+    ecs_world_t *world,
+    ecs_entity_t parent,
+    ecs_entity_t child)
+{
+    ecs_array_t *children = ecs_map_get(world->child_index, parent);
+    ecs_array_t *new_children = children;
+
+    ecs_entity_t *elem = ecs_array_add(&new_children, &handle_arr_params);
+    *elem = child;
+
+    if (new_children != children) {
+        ecs_map_set(world->child_index, parent, new_children);
+    }
+}
+
+static
+void remove_child(
+    ecs_world_t *world,
+    ecs_entity_t parent,
+    ecs_entity_t child)
+{
+    ecs_array_t *children = ecs_map_get(world->child_index, parent);
+    if (!children) {
+        return;
+    }
+
+    ecs_entity_t *buffer = ecs_array_buffer(children);
+    uint32_t i, count = ecs_array_count(children);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i] == child) {
+            ecs_array_remove_index(children, &handle_arr_params, i);
+            break;
+        }
+    }
+
+    if (!ecs_array_count(children)) {
+        ecs_array_free(children);
+        ecs_map_remove(world->child_index, parent);
+    }
+}
+
+/* -- Private functions -- */
+
+ecs_entity_t ecs_hierarchy_get_parent(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    EcsParent *ptr = get_parent_ptr(world, entity);
+    if (ptr) {
+        return ptr->entity;
+    } else {
+        return 0;
+    }
+}
+
+void ecs_hierarchy_remove_row(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_table_column_t *columns,
+    int32_t index,
+    ecs_entity_t entity)
+{
+    EcsParent *parents = ecs_array_buffer(columns[table->parent_column].data);
+    if (index < 0) {
+        index *= -1;
+    }
+
+    ecs_entity_t parent = parents[index - 1].entity;
+    if (parent) {
+        remove_child(world, parent, entity);
+    }
+}
+
+void ecs_hierarchy_add_row(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_table_column_t *columns,
+    int32_t index,
+    ecs_entity_t entity)
+{
+    EcsParent *parents = ecs_array_buffer(columns[table->parent_column].data);
+    if (index < 0) {
+        index *= -1;
+    }
+
+    ecs_entity_t parent = parents[index - 1].entity;
+    if (parent) {
+        add_child(world, parent, entity);
+        table->hierarchy_dirty = true;
+        world->hierarchy_dirty = true;
+    }
+}
+
+void ecs_hierarchy_orphan_children(
+    ecs_world_t *world,
+    ecs_entity_t parent)
+{
+    if (!ecs_map_count(world->child_index)) {
+        return;
+    }
+
+    ecs_array_t *children = ecs_map_get(world->child_index, parent);
+    if (!children) {
+        return;
+    }
+
+    ecs_entity_t *buffer = ecs_array_buffer(children);
+    uint32_t i, count = ecs_array_count(children);
+
+    for (i = 0; i < count; i ++) {
+        uint32_t row;
+        ecs_table_t *table = get_table(world, buffer[i], &row);
+        if (table && table->parent_column) {
+            EcsParent *parents = ecs_array_buffer(
+                table->columns[table->parent_column].data);
+            parents[row].entity = 0;
+            table->hierarchy_dirty = true;
+            world->hierarchy_dirty = true;
+        }
+    }
+
+    ecs_array_free(children);
+    ecs_map_remove(world->child_index, parent);
+}
+
+/** Sort rows by depth and parent, and store the first row of each depth.
+ * Returns whether rows were moved. */
+static
+bool sort_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    bool by_entity)
+{
+    uint32_t i, count = ecs_table_count(table);
+    int (*compare)(const void*, const void*) = 
+        by_entity ? compare_row_entity : compare_row;
+
+    table->hierarchy_dirty = false;
+
+    if (!count) {
+        ecs_array_free(table->depth_offsets);
+        table->depth_offsets = NULL;
+        return false;
+    }
+
+    EcsParent *parents = ecs_array_buffer(
+        table->columns[table->parent_column].data);
+    ecs_entity_t *entities = ecs_array_buffer(table->columns[0].data);
+
+    hierarchy_row_t *rows = ecs_os_malloc(sizeof(hierarchy_row_t) * count);
+    ecs_assert(rows != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    /* Compute sort keys. Consecutive rows often share the same parent, so only
+     * walk the hierarchy when the parent changes. */
+    bool sorted = true;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t parent = parents[i].entity;
+        rows[i].parent = parent;
+        rows[i].entity = entities[i];
+        rows[i].row = i;
+
+        if (i && parent == rows[i - 1].parent) {
+            rows[i].depth = rows[i - 1].depth;
+            if (by_entity && compare(&rows[i - 1], &rows[i]) > 0) {
+                sorted = false;
+            }
+        } else {
+            rows[i].depth = get_depth(world, parent);
+            if (i && compare(&rows[i - 1], &rows[i]) > 0) {
+                sorted = false;
+            }
+        }
+    }
+
+    if (!sorted) {
+        qsort(rows, count, sizeof(hierarchy_row_t), compare);
+
+        uint32_t *order = ecs_os_malloc(sizeof(uint32_t) * count);
+        ecs_assert(order != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+        for (i = 0; i < count; i ++) {
+            order[i] = rows[i].row;
+        }
+
+        ecs_table_reorder(world, table, order);
+        ecs_os_free(order);
+    }
+
+    /* Store first row of each depth, so that rows of a single depth can be
+     * iterated without looking at the parent column. The last element stores
+     * the number of rows. */
+    uint32_t depth, depth_count = rows[count - 1].depth + 1;
+    ecs_array_t *offsets = table->depth_offsets;
+    if (!offsets) {
+        offsets = ecs_array_new(&offset_arr_params, depth_count + 1);
+    }
+
+    ecs_array_set_count(&offsets, &offset_arr_params, depth_count + 1);
+    uint32_t *offset_buffer = ecs_array_buffer(offsets);
+
+    for (i = 0, depth = 0; depth < depth_count; depth ++) {
+        while (i < count && rows[i].depth < depth) {
+            i ++;
+        }
+        offset_buffer[depth] = i;
+    }
+
+    offset_buffer[depth_count] = count;
+    table->depth_offsets = offsets;
+
+    ecs_os_free(rows);
+
+    return !sorted;
+}
+
+void ecs_hierarchy_sort_table(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    sort_table(world, table, false);
+}
+
+bool ecs_hierarchy_defragment_table(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    return sort_table(world, table, true);
+}
+
+void ecs_hierarchy_sort(
+    ecs_world_t *world)
+{
+    if (!world->hierarchy_dirty) {
+        return;
+    }
+
+    ecs_table_t *buffer = ecs_array_buffer(world->main_stage.tables);
+    uint32_t i, count = ecs_array_count(world->main_stage.tables);
+
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *table = &buffer[i];
+        if (table->hierarchy_dirty) {
+            ecs_hierarchy_sort_table(world, table);
+        }
+    }
+
+    world->hierarchy_dirty = false;
+}
+
+/* -- Public functions -- */
+
+void ecs_set_parent(
+    ecs_world_t *world,
+    ecs_entity_t child,
+    ecs_entity_t parent)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_get_stage(&world);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(child != 0, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsParent *ptr = get_parent_ptr(world, child);
+
+    if (!parent) {
+        /* Removing the parent column removes the child from the index */
+        if (ptr) {
+            _ecs_remove(world, child, world->t_parent);
+        }
+        return;
+    }
+
+    /* An entity can't be the parent of one of its parents */
+    ecs_assert(!is_ancestor(world, parent, child), ECS_INVALID_PARAMETERS, 
+        "cycle in hierarchy");
+
+    /* The parent component is only registered when it is used, so that tables
+     * of applications that don't use it are not affected */
+    if (!world->e_parent) {
+        world->e_parent = ecs_new_component(
+            world, "EcsParent", sizeof(EcsParent));
+        world->t_parent = ecs_type_from_entity(world, world->e_parent);
+    }
+
+    if (ptr) {
+        if (ptr->entity == parent) {
+            return;
+        }
+
+        if (ptr->entity) {
+            remove_child(world, ptr->entity, child);
+        }
+    }
+
+    add_child(world, parent, child);
+    _ecs_set_ptr(world, child, world->t_parent, sizeof(EcsParent), 
+        &(EcsParent){parent});
+
+    uint32_t row;
+    ecs_table_t *table = get_table(world, child, &row);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    table->hierarchy_dirty = true;
+    world->hierarchy_dirty = true;
+}
+
+ecs_entity_t ecs_parent_of(
+    ecs_world_t *world,
+    ecs_entity_t child)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_get_stage(&world);
+    return ecs_hierarchy_get_parent(world, child);
+}
+
+ecs_entity_t* ecs_children_of(
+    ecs_world_t *world,
+    ecs_entity_t parent,
+    uint32_t *count_out)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(count_out != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_get_stage(&world);
+
+    ecs_array_t *children = ecs_map_get(world->child_index, parent);
+    *count_out = ecs_array_count(children);
+
+    if (children) {
+        return ecs_array_buffer(children);
+    } else {
+        return NULL;
+    }
+}
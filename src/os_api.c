@@ -1,6 +1,14 @@
+#ifdef __linux__
+#define _DEFAULT_SOURCE
+#endif
 
 #include "include/private/flecs.h"
 
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 static bool ecs_os_api_initialized = false;
 
 const ecs_os_api_t ecs_os_api;
@@ -18,6 +26,28 @@ void ecs_set_os_api(
     }
 }
 
+/* On Linux, request transparent huge pages for large column buffers */
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+
+static
+void linux_advise_large(
+    void *ptr,
+    size_t size,
+    uint32_t worker)
+{
+    (void)worker;
+
+    uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)ptr + page_size - 1) & ~(page_size - 1);
+    uintptr_t end = ((uintptr_t)ptr + size) & ~(page_size - 1);
+
+    if (end > start) {
+        madvise((void*)start, end - start, MADV_HUGEPAGE);
+    }
+}
+
+#endif
+
 /* When flecs is built with bake, use threading functions from bake.util */
 #ifdef __BAKE__
 
@@ -71,6 +101,7 @@ ecs_os_cond_t bake_cond_new(void) {
 static 
 void bake_cond_free(ecs_os_cond_t cond) {
     ut_cond_free((struct ut_cond_s *)cond);
+    ecs_os_api.free((struct ut_cond_s *)cond);
 }
 
 static 
@@ -109,6 +140,10 @@ void ecs_set_os_api_defaults(void)
     _ecs_os_api->realloc = realloc;
     _ecs_os_api->calloc = calloc;
 
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    _ecs_os_api->advise_large = linux_advise_large;
+#endif
+
 #ifdef __BAKE__
     _ecs_os_api->thread_new = bake_thread_new;
     _ecs_os_api->thread_join = bake_thread_join;
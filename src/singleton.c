@@ -0,0 +1,259 @@
+#include <string.h>
+#include "include/private/flecs.h"
+
+/** Get size of component from its EcsComponent value */
+static
+uint32_t component_size(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t component)
+{
+    ecs_entity_info_t info = {0};
+    EcsComponent *cdata = get_ptr(
+        world, stage, component, EEcsComponent, false, false, &info);
+    ecs_assert(cdata != NULL, ECS_NOT_A_COMPONENT, NULL);
+    return cdata->size;
+}
+
+/** Get slot in which the world stores the singleton value of a component */
+static
+void** get_slot(
+    ecs_world_t *world,
+    ecs_entity_t component)
+{
+    if (component >= ecs_array_count(world->singletons)) {
+        return NULL;
+    }
+
+    void **buffer = ecs_array_buffer(world->singletons);
+    return &buffer[component];
+}
+
+/** Get slot for component, add slots if the array is not large enough */
+static
+void** ensure_slot(
+    ecs_world_t *world,
+    ecs_entity_t component)
+{
+    uint32_t count = ecs_array_count(world->singletons);
+
+    if (component >= count) {
+        ecs_array_set_count(
+            &world->singletons, &ptr_arr_params, component + 1);
+
+        void **buffer = ecs_array_buffer(world->singletons);
+        memset(&buffer[count], 0, (component + 1 - count) * sizeof(void*));
+    }
+
+    return get_slot(world, component);
+}
+
+/** Get value of singleton to write to. While in progress the value is stored
+ * in the stage, as slots of the world may be read by other threads. Values are
+ * copied to the world slot when the stage is merged. */
+static
+void* ensure_value(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t component,
+    size_t size)
+{
+    void *dst;
+
+    if (world->in_progress) {
+        if (!stage->singletons) {
+            stage->singletons = ecs_map_new(0);
+        }
+
+        dst = ecs_map_get(stage->singletons, component);
+        if (!dst) {
+            dst = ecs_os_malloc(size);
+            ecs_assert(dst != NULL, ECS_OUT_OF_MEMORY, NULL);
+            ecs_map_set(stage->singletons, component, dst);
+        }
+    } else {
+        void **slot = ensure_slot(world, component);
+        if (!*slot) {
+            *slot = ecs_os_malloc(size);
+            ecs_assert(*slot != NULL, ECS_OUT_OF_MEMORY, NULL);
+        }
+
+        dst = *slot;
+    }
+
+    return dst;
+}
+
+/* -- Private functions -- */
+
+void* ecs_singleton_get(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_entity_t component)
+{
+    /* Values set while in progress are visible to the stage that set them */
+    if (world->in_progress && stage->singletons) {
+        void *ptr = ecs_map_get(stage->singletons, component);
+        if (ptr) {
+            return ptr;
+        }
+    }
+
+    void **slot = get_slot(world, component);
+    if (slot) {
+        return *slot;
+    } else {
+        return NULL;
+    }
+}
+
+bool ecs_singleton_has(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_type_t type,
+    bool match_all)
+{
+    ecs_array_t *components = ecs_type_get(world, stage, type);
+    ecs_entity_t *buffer = ecs_array_buffer(components);
+    uint32_t i, count = ecs_array_count(components);
+
+    for (i = 0; i < count; i ++) {
+        bool has = ecs_singleton_get(world, stage, buffer[i]) != NULL;
+        if (has != match_all) {
+            return has;
+        }
+    }
+
+    return match_all;
+}
+
+void ecs_singleton_add(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_type_t type)
+{
+    ecs_array_t *components = ecs_type_get(world, stage, type);
+    ecs_entity_t *buffer = ecs_array_buffer(components);
+    uint32_t i, count = ecs_array_count(components);
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t component = buffer[i];
+
+        /* Values that are already set, or staged, are not reset */
+        if (ecs_singleton_get(world, stage, component)) {
+            continue;
+        }
+
+        size_t size = component_size(world, stage, component);
+        void *dst = ensure_value(world, stage, component, size);
+        memset(dst, 0, size);
+    }
+}
+
+void ecs_singleton_merge(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    if (!stage->singletons) {
+        return;
+    }
+
+    EcsIter it = ecs_map_iter(stage->singletons);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_entity_t component;
+        void *value = (void*)(uintptr_t)ecs_map_next(&it, &component);
+        void **slot = ensure_slot(world, component);
+
+        if (*slot) {
+            memcpy(*slot, value, component_size(
+                world, &world->main_stage, component));
+            ecs_os_free(value);
+        } else {
+            *slot = value;
+        }
+    }
+
+    ecs_map_clear(stage->singletons);
+}
+
+void ecs_singleton_stage_deinit(
+    ecs_stage_t *stage)
+{
+    if (!stage->singletons) {
+        return;
+    }
+
+    EcsIter it = ecs_map_iter(stage->singletons);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_os_free(ecs_iter_next(&it));
+    }
+
+    ecs_map_free(stage->singletons);
+    stage->singletons = NULL;
+}
+
+void ecs_singleton_fini(
+    ecs_world_t *world)
+{
+    void **buffer = ecs_array_buffer(world->singletons);
+    uint32_t i, count = ecs_array_count(world->singletons);
+
+    for (i = 0; i < count; i ++) {
+        ecs_os_free(buffer[i]);
+    }
+
+    ecs_array_free(world->singletons);
+}
+
+ecs_entity_t ecs_singleton_set(
+    ecs_world_t *world,
+    ecs_type_t type,
+    size_t size,
+    void *ptr)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(type != 0, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(ptr != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    ecs_world_t *world_arg = world;
+    ecs_stage_t *stage = ecs_get_stage(&world);
+
+    ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    /* Set only accepts types that hold a single component */
+    ecs_entity_t component = ecs_entity_from_type(world_arg, type);
+    ecs_assert(component_size(world, stage, component) == size,
+        ECS_INVALID_COMPONENT_SIZE, NULL);
+
+    void *dst = ensure_value(world, stage, component, size);
+    memcpy(dst, ptr, size);
+
+    return 0;
+}
+
+/* -- Public functions -- */
+
+void ecs_set_singleton_slots(
+    ecs_world_t *world,
+    bool enable)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    if (world->singleton_slots == enable) {
+        return;
+    }
+
+    /* Singletons set before are not moved to the other store */
+    void **buffer = ecs_array_buffer(world->singletons);
+    uint32_t i, count = ecs_array_count(world->singletons);
+    for (i = 0; i < count; i ++) {
+        ecs_assert(!buffer[i], ECS_INVALID_PARAMETERS, 
+            "singletons are already set");
+    }
+
+    ecs_assert(!ecs_map_has(world->main_stage.entity_index, 0, NULL), 
+        ECS_INVALID_PARAMETERS, "singletons are already set");
+
+    world->singleton_slots = enable;
+}
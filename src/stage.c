@@ -16,6 +16,24 @@ void merge_families(
             ecs_map_set(world->main_stage.type_index, type_id, type);
         }
     }
+}
+
+/** Free types of which another stage already merged a copy. This happens after
+ * the staged tables and data that point to the types are freed. */
+static
+void clean_merged_families(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    EcsIter it = ecs_map_iter(stage->type_index);
+    while (ecs_iter_hasnext(&it)) {
+        uint64_t type_id;
+        ecs_array_t *type = (void*)(uintptr_t)ecs_map_next(&it, &type_id);
+
+        if (ecs_map_get(world->main_stage.type_index, type_id) != type) {
+            ecs_array_free(type);
+        }
+    }
 
     ecs_map_clear(stage->type_index);
 }
@@ -40,13 +58,42 @@ void merge_tables(
 
         ecs_assert(main_table != NULL, ECS_INTERNAL_ERROR, NULL);
 
-        ecs_table_deinit(world, table);
+        ecs_table_free(world, table);
     }
 
     ecs_array_clear(stage->tables);
     ecs_map_clear(stage->table_index);
 }
 
+/** Free the columns that store data of entities committed while in progress */
+static
+void free_data_stage(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    EcsIter it = ecs_map_iter(stage->data_stage);
+    while (ecs_iter_hasnext(&it)) {
+        uint64_t type_id;
+        ecs_table_column_t *columns = 
+            (void*)(uintptr_t)ecs_map_next(&it, &type_id);
+
+        /* The type is stored in the main stage once families are merged */
+        ecs_array_t *type = ecs_map_get(world->main_stage.type_index, type_id);
+        if (!type) {
+            type = ecs_map_get(stage->type_index, type_id);
+        }
+
+        uint32_t i, count = ecs_array_count(type);
+        for (i = 0; i < count + 1; i ++) {
+            ecs_array_free(columns[i].data);
+        }
+
+        ecs_os_free(columns);
+    }
+
+    ecs_map_clear(stage->data_stage);
+}
+
 static
 void merge_commits(
     ecs_world_t *world,
@@ -61,15 +108,26 @@ void merge_commits(
         ecs_merge_entity(world, stage, entity, &staged_row);
     }
 
-    it = ecs_map_iter(stage->data_stage);
-    while (ecs_iter_hasnext(&it)) {
-        ecs_array_t *stage = ecs_iter_next(&it);
-        ecs_array_free(stage);
-    }
+    free_data_stage(world, stage);
 
     ecs_map_clear(stage->entity_index);
     ecs_map_clear(stage->remove_merge);
-    ecs_map_clear(stage->data_stage);
+}
+
+static
+void merge_enabled(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    EcsIter it = ecs_map_iter(stage->enabled_merge);
+
+    while (ecs_iter_hasnext(&it)) {
+        ecs_entity_t entity;
+        uint64_t enabled = ecs_map_next(&it, &entity);
+        ecs_set_entity_enabled(world, entity, enabled == ECS_ENTITY_ENABLED);
+    }
+
+    ecs_map_clear(stage->enabled_merge);
 }
 
 static
@@ -135,6 +193,7 @@ void ecs_stage_init(
     if (!is_main_stage) {
         stage->data_stage = ecs_map_new(0);
         stage->remove_merge = ecs_map_new(0);
+        stage->enabled_merge = ecs_map_new(0);
     }
 }
 
@@ -145,6 +204,10 @@ void ecs_stage_deinit(
     bool is_main_stage = stage == &world->main_stage;
     bool is_temp_stage = stage == &world->temp_stage;
 
+    if (!is_main_stage) {
+        free_data_stage(world, stage);
+    }
+
     ecs_map_free(stage->entity_index);
 
     clean_tables(world, stage);
@@ -157,7 +220,11 @@ void ecs_stage_deinit(
     if (!is_main_stage) {
         ecs_map_free(stage->data_stage);
         ecs_map_free(stage->remove_merge);
+        ecs_map_free(stage->enabled_merge);
     }
+
+    ecs_singleton_stage_deinit(stage);
+    ecs_event_stage_deinit(stage);
 }
 
 void ecs_stage_merge(
@@ -174,5 +241,18 @@ void ecs_stage_merge(
     
     merge_commits(world, stage);
 
+    /* Apply enabled state after commits, so that entities created or moved
+     * while in progress are stored in their final table */
+    merge_enabled(world, stage);
+
     merge_tables(world, stage);
+
+    if (!is_temp_stage) {
+        clean_merged_families(world, stage);
+    }
+
+    ecs_singleton_merge(world, stage);
+
+    /* Entities are merged, so deferred notifications can find their rows */
+    ecs_event_merge(world, stage);
 }
@@ -311,6 +311,26 @@ int system_stats_arr_inactive(
     return count;
 }
 
+/** Compute how much longer worker threads took than they would have if jobs
+ * were perfectly balanced. A value of 1 means that all threads spent the same
+ * amount of time on the phase. Resets the time measured for the phase. */
+static
+float phase_imbalance(
+    ecs_phase_time_t *phase_time,
+    uint32_t thread_count)
+{
+    float result = 0;
+
+    if (thread_count && phase_time->total) {
+        result = phase_time->max * thread_count / phase_time->total;
+    }
+
+    phase_time->max = 0;
+    phase_time->total = 0;
+
+    return result;
+}
+
 void ecs_get_stats(
     ecs_world_t *world,
     ecs_world_stats_t *stats)
@@ -454,6 +474,16 @@ void ecs_get_stats(
         stats->system_time = 0;
     }
 
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+    stats->pre_update_imbalance = phase_imbalance(
+        &world->pre_update_time, thread_count);
+    stats->on_update_imbalance = phase_imbalance(
+        &world->on_update_time, thread_count);
+    stats->on_validate_imbalance = phase_imbalance(
+        &world->on_validate_time, thread_count);
+    stats->post_update_imbalance = phase_imbalance(
+        &world->post_update_time, thread_count);
+
     stats->frame_profiling = world->measure_frame_time;
     stats->system_profiling = world->measure_system_time;
 
@@ -3,6 +3,34 @@
 #include "include/private/flecs.h"
 #include "include/util/time.h"
 
+/** Store the entity and component of each column that is not fetched from the
+ * entity itself. These don't depend on the type the system is invoked for. */
+static
+void compute_refs(
+    ecs_entity_t system,
+    EcsRowSystem *system_data)
+{
+    uint32_t i, column_count = ecs_array_count(system_data->base.columns);
+    ecs_system_column_t *buffer = ecs_array_buffer(system_data->base.columns);
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_entity_t entity = 0;
+
+        if (buffer[i].kind == EcsFromSelf) {
+            continue;
+        } else if (buffer[i].kind == EcsFromSystem) {
+            entity = system;
+        } else if (buffer[i].kind == EcsFromEntity) {
+            entity = buffer[i].source;
+        }
+
+        ecs_reference_t *ref = ecs_array_add(
+            &system_data->refs, &reference_arr_params);
+        ref->entity = entity;
+        ref->component = buffer[i].is.component;
+    }
+}
+
 static
 void match_type(
     ecs_world_t *world,
@@ -33,11 +61,19 @@ void match_type(
 
         ecs_array_t *systems = ecs_map_get(index, type);
         if (!systems) {
-            systems = ecs_array_new(&handle_arr_params, 1);
+            systems = ecs_array_new(&row_system_arr_params, 1);
         }
 
-        ecs_entity_t *new_elem = ecs_array_add(&systems, &handle_arr_params);
-        *new_elem = system;
+        ecs_row_system_ref_t *new_elem = ecs_array_add(
+            &systems, &row_system_arr_params);
+        new_elem->system = system;
+        new_elem->data = system_data;
+        new_elem->columns = ecs_os_malloc(sizeof(int32_t) * 
+            ecs_array_count(system_data->base.columns));
+        ecs_assert(new_elem->columns != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+        ecs_row_system_columns(
+            system_data, ecs_type_get(world, stage, type), new_elem->columns);
 
         /* Always set the system entry, as array may have been realloc'd */
         ecs_map_set(index, type, systems);
@@ -140,17 +176,43 @@ ecs_entity_t new_row_system(
         *elem = result;
     }
 
+    compute_refs(result, system_data);
     ecs_system_compute_and_families(world, &system_data->base);
 
     if (needs_tables) {
         match_families(world, result, system_data);
     }
 
+    /* Pointers to system data are stored when the system is first ran */
+    world->system_version ++;
+
     return result;
 }
 
 /* -- Private API -- */
 
+/** Map the columns of a row system to the columns of a type. Columns that are
+ * not fetched from the entity itself are mapped to the system references, in
+ * the order in which they are stored in EcsRowSystem::refs. */
+void ecs_row_system_columns(
+    EcsRowSystem *system_data,
+    ecs_array_t *type,
+    int32_t *columns)
+{
+    uint32_t i, column_count = ecs_array_count(system_data->base.columns);
+    ecs_system_column_t *buffer = ecs_array_buffer(system_data->base.columns);
+    int32_t ref_id = 0;
+
+    for (i = 0; i < column_count; i ++) {
+        if (buffer[i].kind == EcsFromSelf) {
+            columns[i] = ecs_type_index_of(type, buffer[i].is.component) + 1;
+        } else {
+            ref_id ++;
+            columns[i] = -ref_id;
+        }
+    }
+}
+
 void ecs_system_compute_and_families(
     ecs_world_t *world,
     EcsSystem *system_data)
@@ -270,70 +332,35 @@ error:
     return -1;
 }
 
-/** Run system on a single row */
+/** Run system on a single row. The column map is computed for the type when
+ * the system is registered for it, and the references of the system are
+ * computed when the system is created, so only the pointers to referenced
+ * components, which can move, are resolved here. */
 bool ecs_notify_row_system(
     ecs_world_t *world,
     ecs_entity_t system,
-    ecs_array_t *type,
+    EcsRowSystem *system_data,
+    int32_t *columns,
     ecs_table_column_t *table_columns,
     uint32_t offset,
     uint32_t limit)
 {
-    ecs_entity_info_t entity_info = {0};
-
     ecs_world_t *real_world = world;
     if (world->magic == ECS_THREAD_MAGIC) {
         real_world = ((ecs_thread_t*)world)->world; /* dispel the magic */
     }
 
-    EcsRowSystem *system_data = get_ptr(
-        real_world, &real_world->main_stage, system, EEcsRowSystem, false, true, &entity_info);
-    
     assert(system_data != NULL);
 
     if (!system_data->base.enabled) {
         return false;
     }
 
-    ecs_system_action_t action = system_data->base.action;
-
-    uint32_t i, column_count = ecs_array_count(system_data->base.columns);
-    ecs_system_column_t *buffer = ecs_array_buffer(system_data->base.columns);
-    int32_t *columns = ecs_os_alloca(int32_t, column_count);
-    ecs_reference_t *references = ecs_os_alloca(ecs_reference_t, column_count);
-    void **ref_ptrs = ecs_os_alloca(void*, column_count);
-
-    uint32_t ref_id = 0;
-
-    for (i = 0; i < column_count; i ++) {
-        if (buffer[i].kind == EcsFromSelf) {
-            columns[i] = ecs_type_index_of(type, buffer[i].is.component) + 1;
-        } else {
-            ecs_entity_t entity = 0;
-            ecs_entity_t component = buffer[i].is.component;
-            
-            if (buffer[i].kind == EcsFromSystem) {
-                entity = system;
-            } else if (buffer[i].kind == EcsFromSingleton) {
-                entity = 0;         
-            } else if (buffer[i].kind == EcsFromEntity) {
-                entity = buffer[i].source;
-            }
-
-            references[ref_id] = (ecs_reference_t){.entity = entity, .component = component};
-            ref_ptrs[ref_id] = get_ptr(real_world, &real_world->main_stage, entity, component, false, true, &entity_info);
-
-            ref_id ++;
-            columns[i] = -ref_id;
-        }
-    }
-
     ecs_rows_t rows = {
         .world = world,
         .system = system,
         .columns = columns,
         .column_count = ecs_array_count(system_data->components),
-        .references = references,
         .table_columns = table_columns,
         .components = ecs_array_buffer(system_data->components),
         .frame_offset = 0,
@@ -341,7 +368,18 @@ bool ecs_notify_row_system(
         .count = limit
     };
 
-    if (ref_id) {
+    uint32_t i, ref_count = ecs_array_count(system_data->refs);
+    if (ref_count) {
+        ecs_reference_t *references = ecs_array_buffer(system_data->refs);
+        void **ref_ptrs = ecs_os_alloca(void*, ref_count);
+
+        for (i = 0; i < ref_count; i ++) {
+            ecs_entity_info_t entity_info = {0};
+            ref_ptrs[i] = get_ptr(real_world, &real_world->main_stage, 
+                references[i].entity, references[i].component, false, true, 
+                &entity_info);
+        }
+
         rows.references = references;
         rows.ref_ptrs = ref_ptrs;
     }
@@ -351,7 +389,7 @@ bool ecs_notify_row_system(
         rows.entities = &entities[rows.offset];
     }
 
-    action(&rows);
+    system_data->base.action(&rows);
 
     return true;
 }
@@ -361,9 +399,14 @@ bool ecs_notify_row_system(
  * Tasks are ran once every frame. */
 void ecs_run_task(
     ecs_world_t *world,
-    ecs_entity_t system)
+    ecs_entity_t system,
+    EcsRowSystem *system_data)
 {
-    ecs_notify_row_system(world, system, NULL, NULL, 0, 1);
+    int32_t *columns = ecs_os_alloca(
+        int32_t, ecs_array_count(system_data->base.columns));
+    ecs_row_system_columns(system_data, NULL, columns);
+
+    ecs_notify_row_system(world, system, system_data, columns, NULL, 0, 1);
 }
 
 /* Notify row system of a new type */
@@ -521,6 +564,107 @@ void ecs_set_period(
     }
 }
 
+void _ecs_set_order_by(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_entity_t component,
+    ecs_compare_action_t compare)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!component || compare != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    ecs_assert(system_data != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    /* Rows of CASCADE systems are already ordered by depth */
+    ecs_assert(!system_data->base.cascade_by, ECS_INVALID_PARAMETERS, NULL);
+
+    bool was_sorted = system_data->sort_on != 0;
+
+    system_data->sort_on = component;
+    system_data->compare = compare;
+    system_data->valid_order = false;
+
+    /* Tables that are no longer sorted by any system can be defragmented */
+    if (was_sorted && !component) {
+        ecs_world_update_sorted_tables(world);
+    }
+}
+
+void ecs_set_time_slice(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    uint32_t frames)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    ecs_assert(system_data != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    /* A slice would cut through hierarchy levels */
+    ecs_assert(!system_data->base.cascade_by, ECS_INVALID_PARAMETERS, NULL);
+
+    system_data->slice_frames = frames > 1 ? frames : 0;
+    system_data->slice_cursor = 0;
+    system_data->valid_schedule = false;
+}
+
+void ecs_set_deferrable(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    bool deferrable)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    ecs_assert(system_data != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    system_data->deferrable = deferrable;
+}
+
+void ecs_set_task_parallel(
+    ecs_world_t *world,
+    ecs_entity_t task,
+    bool parallel)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    EcsRowSystem *task_data = ecs_get_ptr(world, task, EcsRowSystem);
+    ecs_assert(task_data != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(task_data->base.kind == EcsOnUpdate, 
+        ECS_INVALID_PARAMETERS, "system is not a task");
+    task_data->parallel = parallel;
+}
+
+void ecs_set_task_conflict(
+    ecs_world_t *world,
+    ecs_entity_t task_1,
+    ecs_entity_t task_2)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(task_1 != task_2, ECS_INVALID_PARAMETERS, NULL);
+
+    EcsRowSystem *data_1 = ecs_get_ptr(world, task_1, EcsRowSystem);
+    EcsRowSystem *data_2 = ecs_get_ptr(world, task_2, EcsRowSystem);
+    ecs_assert(data_1 != NULL && data_2 != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(data_1->base.kind == EcsOnUpdate && 
+        data_2->base.kind == EcsOnUpdate, 
+        ECS_INVALID_PARAMETERS, "system is not a task");
+
+    /* Conflicts are stored on both tasks, so that the scheduler only has to
+     * look at the conflicts of the task it is adding */
+    ecs_entity_t *elem = ecs_array_add(&data_1->conflicts, &handle_arr_params);
+    *elem = task_2;
+    elem = ecs_array_add(&data_2->conflicts, &handle_arr_params);
+    *elem = task_1;
+}
+
 void* _ecs_column(
     ecs_rows_t *rows,
     uint32_t index,
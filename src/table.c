@@ -1,6 +1,116 @@
 #include <assert.h>
+#include <string.h>
 #include "include/private/flecs.h"
 
+static
+const ecs_array_params_t mask_arr_params = {
+    .element_size = sizeof(uint32_t)
+};
+
+static
+const ecs_array_params_t prefab_column_arr_params = {
+    .element_size = sizeof(ecs_prefab_column_t)
+};
+
+#define ROW_WORD(row) ((row) >> 5)
+#define ROW_BIT(row) (1u << ((row) & 31))
+
+/** Register that the column buffers of a table may have moved. When the table
+ * stores systems, pointers to system data must be refreshed before systems are
+ * ran again. When the table stores prefabs, the shared component values cached
+ * by tables must be resolved again. */
+static
+void mark_moved(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (table->has_systems) {
+        world->system_version ++;
+    }
+
+    if (table->is_prefab) {
+        world->prefab_version ++;
+    }
+}
+
+/** Register that rows were added to or removed from a table. Changes to the
+ * main stage are counted so that job schedules can detect when they drifted
+ * too far from the actual row counts. Rows of tables with a parent column must
+ * be sorted before they are iterated again. Staged columns are not sorted, as
+ * they are merged into the main stage columns before they are iterated. */
+static
+void mark_modified(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_table_column_t *columns,
+    uint32_t count)
+{
+    table->last_modified = world->frame_count;
+
+    if (columns == table->columns) {
+        world->row_changes += count;
+        table->column_versions[0] ++;
+        mark_moved(world, table);
+
+        if (table->parent_column) {
+            table->hierarchy_dirty = true;
+            world->hierarchy_dirty = true;
+        }
+    }
+}
+
+/** Free instantiate plans of a table */
+static
+void clear_instantiate_plans(
+    ecs_map_t *plans)
+{
+    EcsIter it = ecs_map_iter(plans);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_array_t *plan = ecs_iter_next(&it);
+        ecs_array_free(plan);
+    }
+
+    ecs_map_clear(plans);
+}
+
+/** Free values resolved from prefabs. Tables of a stage are deinitialized but
+ * not freed when the stage is merged. */
+static
+void free_prefab_cache(
+    ecs_table_t *table)
+{
+    if (table->prefab_cache) {
+        ecs_map_free(table->prefab_cache);
+        table->prefab_cache = NULL;
+    }
+
+    if (table->instantiate_plans) {
+        clear_instantiate_plans(table->instantiate_plans);
+        ecs_map_free(table->instantiate_plans);
+        table->instantiate_plans = NULL;
+    }
+}
+
+/** Drop values resolved from prefabs when prefab data moved since the values
+ * were cached */
+static
+void validate_prefab_cache(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    if (table->prefab_cache_version != world->prefab_version) {
+        if (table->prefab_cache) {
+            ecs_map_clear(table->prefab_cache);
+        }
+
+        if (table->instantiate_plans) {
+            clear_instantiate_plans(table->instantiate_plans);
+        }
+
+        table->prefab_cache_version = world->prefab_version;
+    }
+}
+
 /** Notify systems that a table has changed its active state */
 static
 void activate_table(
@@ -24,6 +134,42 @@ void activate_table(
     }
 }
 
+/** Get index of the worker thread that owns the columns of a stage. The main
+ * stage and the temporary stage are owned by the main thread. */
+static
+uint32_t stage_worker(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    ecs_stage_t *stages = ecs_array_buffer(world->worker_stages);
+    uint32_t count = ecs_array_count(world->worker_stages);
+
+    if (stages && stage >= stages && stage < &stages[count]) {
+        return stage - stages + 1;
+    }
+
+    return 0;
+}
+
+/** Pass column buffers that are large enough to benefit from huge pages to the
+ * OS API. This only happens when the column has been resized, and is done
+ * before the added rows are written. */
+static
+void advise_column(
+    ecs_array_t *data,
+    uint32_t old_size,
+    uint32_t element_size,
+    uint32_t worker)
+{
+    uint32_t size = ecs_array_size(data);
+    if (size != old_size) {
+        size_t byte_size = (size_t)size * element_size;
+        if (byte_size >= ECS_LARGE_COLUMN_SIZE) {
+            ecs_os_advise_large(ecs_array_buffer(data), byte_size, worker);
+        }
+    }
+}
+
 /* -- Private functions -- */
 
 ecs_table_column_t *ecs_table_get_columns(
@@ -68,6 +214,25 @@ int ecs_table_init(
     table->frame_systems = NULL;
     table->type = type;
     table->columns = ecs_table_get_columns(world, stage, type);
+    table->disabled = NULL;
+    table->disabled_count = 0;
+    table->last_modified = world->frame_count;
+    table->depth_offsets = NULL;
+    table->is_sorted = false;
+    table->parent_column = world->e_parent 
+        ? ecs_type_index_of(type, world->e_parent) + 1 
+        : 0;
+    table->hierarchy_dirty = false;
+    table->has_systems = 
+        ecs_type_index_of(type, EEcsColSystem) != -1 ||
+        ecs_type_index_of(type, EEcsRowSystem) != -1;
+    table->is_prefab = ecs_type_index_of(type, EEcsPrefab) != -1;
+    table->prefab_cache = NULL;
+    table->instantiate_plans = NULL;
+    table->prefab_cache_version = 0;
+    table->column_versions = ecs_os_calloc(
+        ecs_array_count(type) + 1, sizeof(uint32_t));
+    ecs_assert(table->column_versions != NULL, ECS_OUT_OF_MEMORY, NULL);
 
     if (stage == &world->main_stage) {
         ecs_entity_t *buf = ecs_array_buffer(type);
@@ -98,7 +263,9 @@ void ecs_table_deinit(
     ecs_table_t *table)
 {
     (void)world;
-    (void)table;
+    free_prefab_cache(table);
+    ecs_os_free(table->column_versions);
+    table->column_versions = NULL;
 }
 
 void ecs_table_free(
@@ -115,6 +282,340 @@ void ecs_table_free(
     ecs_os_free(table->columns);
 
     ecs_array_free(table->frame_systems);
+    ecs_array_free(table->disabled);
+    ecs_array_free(table->depth_offsets);
+    free_prefab_cache(table);
+    ecs_os_free(table->column_versions);
+    table->column_versions = NULL;
+}
+
+void ecs_table_reclaim(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_table_column_t *columns = table->columns;
+    uint32_t i, column_count = ecs_array_count(table->type);
+
+    for (i = 0; i < column_count + 1; i ++) {
+        if (columns[i].data) {
+            ecs_array_params_t params = {.element_size = columns[i].size};
+            ecs_array_reclaim(&columns[i].data, &params);
+        }
+    }
+
+    if (table->disabled && !table->disabled_count) {
+        ecs_array_free(table->disabled);
+        table->disabled = NULL;
+    }
+
+    mark_moved(world, table);
+}
+
+void ecs_table_column_changed(
+    ecs_table_t *table,
+    uint32_t column)
+{
+    ecs_assert(column <= ecs_array_count(table->type), 
+        ECS_INTERNAL_ERROR, NULL);
+    table->column_versions[column] ++;
+}
+
+void ecs_table_reorder(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const uint32_t *order)
+{
+    ecs_table_column_t *columns = table->columns;
+    uint32_t c, column_count = ecs_array_count(table->type) + 1;
+    uint32_t i, count = ecs_table_count(table), max_size = 0;
+
+    for (c = 0; c < column_count; c ++) {
+        if (columns[c].size > max_size) {
+            max_size = columns[c].size;
+        }
+    }
+
+    char *tmp = ecs_os_malloc(max_size * count);
+    ecs_assert(tmp != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    for (c = 0; c < column_count; c ++) {
+        uint32_t size = columns[c].size;
+        if (!size) {
+            continue;
+        }
+
+        char *buffer = ecs_array_buffer(columns[c].data);
+        for (i = 0; i < count; i ++) {
+            memcpy(&tmp[i * size], &buffer[order[i] * size], size);
+        }
+
+        memcpy(buffer, tmp, count * size);
+    }
+
+    ecs_os_free(tmp);
+
+    /* Disabled rows must move along with their data */
+    if (table->disabled_count) {
+        bool *disabled = ecs_os_malloc(sizeof(bool) * count);
+        ecs_assert(disabled != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+        for (i = 0; i < count; i ++) {
+            disabled[i] = !ecs_table_is_enabled(table, order[i]);
+        }
+
+        for (i = 0; i < count; i ++) {
+            ecs_table_set_enabled(table, i, !disabled[i]);
+        }
+
+        ecs_os_free(disabled);
+    }
+
+    /* Update entity index with the new rows. Watched entities stay watched. */
+    ecs_entity_t *entities = ecs_array_buffer(columns[0].data);
+    ecs_map_t *entity_index = world->main_stage.entity_index;
+
+    for (i = 0; i < count; i ++) {
+        ecs_row_t row = ecs_to_row(ecs_map_get64(entity_index, entities[i]));
+        row.index = row.index < 0 ? -(int32_t)(i + 1) : (int32_t)(i + 1);
+        ecs_map_set64(entity_index, entities[i], ecs_from_row(row));
+    }
+
+    /* Systems and prefabs in the table moved to another row */
+    table->column_versions[0] ++;
+    mark_moved(world, table);
+}
+
+void* ecs_table_get_shared(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_entity_t prefab,
+    ecs_entity_t component)
+{
+    validate_prefab_cache(world, table);
+
+    if (!table->prefab_cache) {
+        table->prefab_cache = ecs_map_new(0);
+    }
+
+    void *ptr = ecs_map_get(table->prefab_cache, component);
+    if (!ptr) {
+        /* Resolving the component from the prefab uses the cache of the prefab
+         * table, so each level of a prefab chain is only walked once */
+        ecs_entity_info_t info = {0};
+        ptr = get_ptr(world, &world->main_stage, prefab, component, false, 
+            true, &info);
+
+        if (ptr) {
+            ecs_map_set(table->prefab_cache, component, ptr);
+        }
+    }
+
+    return ptr;
+}
+
+ecs_array_t* ecs_table_new_instantiate_plan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_table_t *table,
+    ecs_type_t to_add)
+{
+    ecs_array_t *plan = ecs_array_new(&prefab_column_arr_params, 0);
+    ecs_array_t *add_type = ecs_type_get(world, stage, to_add);
+    ecs_entity_t *add_handles = ecs_array_buffer(add_type);
+    uint32_t i, add_count = ecs_array_count(add_type);
+    ecs_type_t type_id = table->type_id;
+    ecs_entity_t prefab;
+
+    while ((prefab = ecs_map_get64(world->prefab_index, type_id))) {
+        /* Prefabs are only resolved from the main stage. Prefabs created while
+         * iterating cannot be resolved in the same iteration. */
+        ecs_row_t row = ecs_to_row(
+            ecs_map_get64(world->main_stage.entity_index, prefab));
+        if (!row.type_id) {
+            break;
+        }
+
+        ecs_table_t *prefab_table = ecs_world_get_table(
+            world, stage, row.type_id);
+        int32_t prefab_row = (row.index < 0 ? -row.index : row.index) - 1;
+
+        for (i = 0; i < add_count; i ++) {
+            ecs_entity_t component = add_handles[i];
+            int16_t prefab_column = ecs_type_index_of(
+                prefab_table->type, component);
+            if (prefab_column == -1) {
+                continue;
+            }
+
+            ecs_table_column_t *column = &prefab_table->columns[
+                prefab_column + 1];
+            if (!column->size) {
+                continue;
+            }
+
+            void *value = ECS_OFFSET(
+                ecs_array_buffer(column->data), prefab_row * column->size);
+            int32_t table_column = ecs_type_index_of(
+                table->type, component) + 1;
+
+            /* Values of prefabs further down the chain are copied last, and
+             * thus replace values of the prefabs before them */
+            ecs_prefab_column_t *buffer = ecs_array_buffer(plan);
+            uint32_t p, plan_count = ecs_array_count(plan);
+            for (p = 0; p < plan_count; p ++) {
+                if (buffer[p].column == table_column) {
+                    break;
+                }
+            }
+
+            if (p == plan_count) {
+                ecs_prefab_column_t *elem = ecs_array_add(
+                    &plan, &prefab_column_arr_params);
+                elem->column = table_column;
+                elem->size = column->size;
+                elem->value = value;
+            } else {
+                buffer[p].value = value;
+            }
+        }
+
+        /* Recursively search through prefabs */
+        type_id = row.type_id;
+    }
+
+    return plan;
+}
+
+ecs_array_t* ecs_table_get_instantiate_plan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_table_t *table,
+    ecs_type_t to_add)
+{
+    validate_prefab_cache(world, table);
+
+    if (!table->instantiate_plans) {
+        table->instantiate_plans = ecs_map_new(0);
+    }
+
+    ecs_array_t *plan = ecs_map_get(table->instantiate_plans, to_add);
+    if (!plan) {
+        plan = ecs_table_new_instantiate_plan(world, stage, table, to_add);
+        ecs_map_set(table->instantiate_plans, to_add, plan);
+    }
+
+    return plan;
+}
+
+void ecs_table_set_enabled(
+    ecs_table_t *table,
+    uint32_t row,
+    bool enabled)
+{
+    uint32_t word = ROW_WORD(row), bit = ROW_BIT(row);
+    uint32_t word_count = ecs_array_count(table->disabled);
+    uint32_t *words;
+
+    if (enabled) {
+        if (word >= word_count) {
+            return;
+        }
+
+        words = ecs_array_buffer(table->disabled);
+        if (words[word] & bit) {
+            words[word] &= ~bit;
+            table->disabled_count --;
+            table->column_versions[0] ++;
+        }
+    } else {
+        if (word >= word_count) {
+            if (!table->disabled) {
+                table->disabled = ecs_array_new(&mask_arr_params, word + 1);
+            }
+
+            ecs_array_set_count(&table->disabled, &mask_arr_params, word + 1);
+            words = ecs_array_buffer(table->disabled);
+            memset(&words[word_count], 0, 
+                (word + 1 - word_count) * sizeof(uint32_t));
+        } else {
+            words = ecs_array_buffer(table->disabled);
+        }
+
+        if (!(words[word] & bit)) {
+            words[word] |= bit;
+            table->disabled_count ++;
+            table->column_versions[0] ++;
+        }
+    }
+}
+
+bool ecs_table_is_enabled(
+    ecs_table_t *table,
+    uint32_t row)
+{
+    uint32_t word = ROW_WORD(row);
+    if (word >= ecs_array_count(table->disabled)) {
+        return true;
+    }
+
+    uint32_t *words = ecs_array_buffer(table->disabled);
+    return !(words[word] & ROW_BIT(row));
+}
+
+uint32_t ecs_table_enabled_run(
+    ecs_table_t *table,
+    uint32_t *first,
+    uint32_t end)
+{
+    uint32_t *words = ecs_array_buffer(table->disabled);
+    uint32_t word_count = ecs_array_count(table->disabled);
+    uint32_t row = *first;
+
+    /* Skip disabled rows. Skip entire words if all rows are disabled. */
+    while (row < end) {
+        uint32_t word = ROW_WORD(row);
+        if (word >= word_count || !(words[word] & ROW_BIT(row))) {
+            break;
+        }
+
+        if (!(row & 31) && words[word] == UINT32_MAX) {
+            row += 32;
+        } else {
+            row ++;
+        }
+    }
+
+    if (row >= end) {
+        *first = end;
+        return 0;
+    }
+
+    *first = row;
+
+    /* Find end of run. Skip entire words if no rows are disabled. */
+    while (row < end) {
+        uint32_t word = ROW_WORD(row);
+        if (word >= word_count) {
+            row = end;
+            break;
+        }
+
+        if (words[word] & ROW_BIT(row)) {
+            break;
+        }
+
+        if (!(row & 31) && !words[word]) {
+            row += 32;
+        } else {
+            row ++;
+        }
+    }
+
+    if (row > end) {
+        row = end;
+    }
+
+    return row - *first;
 }
 
 void ecs_table_register_system(
@@ -133,18 +634,22 @@ void ecs_table_register_system(
 
 uint32_t ecs_table_insert(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     ecs_table_t *table,
     ecs_table_column_t *columns,
     ecs_entity_t entity)
 {
     uint32_t column_count = ecs_array_count(table->type);
+    uint32_t worker = stage_worker(world, stage);
 
     /* Fist add entity to column with entity ids */
+    uint32_t old_size = ecs_array_size(columns[0].data);
     ecs_entity_t *e = ecs_array_add(&columns[0].data, &handle_arr_params);
     if (!e) {
         return -1;
     }
 
+    advise_column(columns[0].data, old_size, sizeof(ecs_entity_t), worker);
     *e = entity;
 
     /* Add elements to each column array */
@@ -153,13 +658,16 @@ uint32_t ecs_table_insert(
         uint32_t size = columns[i].size;
         if (size) {
             ecs_array_params_t params = {.element_size = size};
+            old_size = ecs_array_size(columns[i].data);
             if (!ecs_array_add(&columns[i].data, &params)) {
                 return -1;
             }
+            advise_column(columns[i].data, old_size, size, worker);
         }
     }
 
     uint32_t index = ecs_array_count(columns[0].data) - 1;
+    mark_modified(world, table, columns, 1);
 
     if (!world->in_progress && !index) {
         activate_table(world, table, 0, true);
@@ -193,6 +701,18 @@ void ecs_table_delete(
     uint32_t column_last = ecs_array_count(table->type) + 1;
     uint32_t i;
 
+    /* Keep the mask with disabled rows consistent with the column data. If the
+     * last row is moved to index, it takes its enabled state along. */
+    if (table->disabled_count) {
+        bool last_enabled = ecs_table_is_enabled(table, count);
+        ecs_table_set_enabled(table, index, true);
+
+        if ((uint32_t)index != count && !last_enabled) {
+            ecs_table_set_enabled(table, count, true);
+            ecs_table_set_enabled(table, index, false);
+        }
+    }
+
     if (index != count) {        
         /* Move last entity in array to index */
         ecs_entity_t *entities = ecs_array_buffer(entity_column);
@@ -206,15 +726,31 @@ void ecs_table_delete(
             }
         }
 
-        /* Last entity in table is now moved to index of removed entity */
-        ecs_row_t row;
+        /* Last entity in table is now moved to index of removed entity. A
+         * watched entity must remain watched. */
+        ecs_map_t *entity_index = world->main_stage.entity_index;
+        ecs_row_t row = ecs_to_row(ecs_map_get64(entity_index, to_move));
+        bool watched = row.index < 0;
         row.type_id = table->type_id;
-        row.index = index + 1;
-        ecs_map_set64(world->main_stage.entity_index, to_move, ecs_from_row(row));
+        row.index = watched ? -(index + 1) : index + 1;
+        ecs_map_set64(entity_index, to_move, ecs_from_row(row));
 
         /* Decrease size of entity column */
         ecs_array_remove_last(entity_column);
 
+    /* This was the last entity. If tables are garbage collected, keep the
+     * capacity so that a table that oscillates around empty doesn't reallocate
+     * its columns. The collector releases the memory once the table has been
+     * empty long enough. */
+    } else if (!count && world->gc_frames) {
+        ecs_array_clear(entity_column);
+
+        for (i = 1; i < column_last; i ++) {
+            if (columns[i].size) {
+                ecs_array_clear(columns[i].data);
+            }
+        }
+
     /* This was the last entity, free all columns */
     } else if (!count) {
         ecs_array_free(entity_column);
@@ -237,6 +773,8 @@ void ecs_table_delete(
             }
         }
     }
+
+    mark_modified(world, table, columns, 1);
     
     if (!world->in_progress && !count) {
         activate_table(world, table, 0, false);
@@ -245,19 +783,24 @@ void ecs_table_delete(
 
 uint32_t ecs_table_grow(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     ecs_table_t *table,
     ecs_table_column_t *columns,
     uint32_t count,
     ecs_entity_t first_entity)
 {
     uint32_t column_count = ecs_array_count(table->type);
+    uint32_t worker = stage_worker(world, stage);
 
     /* Fist add entity to column with entity ids */
+    uint32_t old_size = ecs_array_size(columns[0].data);
     ecs_entity_t *e = ecs_array_addn(&columns[0].data, &handle_arr_params, count);
     if (!e) {
         return -1;
     }
 
+    advise_column(columns[0].data, old_size, sizeof(ecs_entity_t), worker);
+
     uint32_t i;
     for (i = 0; i < count; i ++) {
         e[i] = first_entity + i;
@@ -266,12 +809,16 @@ uint32_t ecs_table_grow(
     /* Add elements to each column array */
     for (i = 1; i < column_count + 1; i ++) {
         ecs_array_params_t params = {.element_size = columns[i].size};
+        old_size = ecs_array_size(columns[i].data);
         if (!ecs_array_addn(&columns[i].data, &params, count)) {
             return -1;
         }
+        advise_column(columns[i].data, old_size, columns[i].size, worker);
     }
 
     uint32_t row_count = ecs_array_count(columns[0].data);
+    mark_modified(world, table, columns, count);
+
     if (!world->in_progress && row_count == count) {
         activate_table(world, table, 0, true);
     }
@@ -281,24 +828,33 @@ uint32_t ecs_table_grow(
 }
 
 int16_t ecs_table_dim(
+    ecs_world_t *world,
     ecs_table_t *table,
     uint32_t count)
 {
     ecs_table_column_t *columns = table->columns;
     uint32_t column_count = ecs_array_count(table->type);
 
+    uint32_t old_size = ecs_array_size(columns[0].data);
     if (!ecs_array_set_size(&columns[0].data, &handle_arr_params, count)) {
         return -1;
     }
 
+    /* Tables are only dimensioned in the main stage */
+    advise_column(columns[0].data, old_size, sizeof(ecs_entity_t), 0);
+
     uint32_t i;
     for (i = 1; i < column_count + 1; i ++) {
         ecs_array_params_t params = {.element_size = columns[i].size};
+        old_size = ecs_array_size(columns[i].data);
         if (!ecs_array_set_size(&columns[i].data, &params, count)) {
             return -1;
         }
+        advise_column(columns[i].data, old_size, columns[i].size, 0);
     }
 
+    mark_moved(world, table);
+
     return 0;
 }
 
@@ -7,6 +7,16 @@ const ecs_array_params_t column_arr_params = {
     .element_size = sizeof(ecs_system_column_t)
 };
 
+static
+const ecs_array_params_t level_arr_params = {
+    .element_size = sizeof(uint32_t)
+};
+
+static
+const ecs_array_params_t row_cost_arr_params = {
+    .element_size = sizeof(ecs_row_cost_t)
+};
+
 static
 ecs_entity_t components_contains(
     ecs_world_t *world,
@@ -44,7 +54,8 @@ ecs_entity_t components_contains(
 #define REFS_COUNT (2)
 #define COMPONENTS_INDEX (3)
 #define DEPTH_INDEX (4)
-#define COLUMNS_INDEX (5)
+#define SORTED_INDEX (5)
+#define COLUMNS_INDEX (6)
 
 /* Get ref array for system table */
 static
@@ -120,9 +131,16 @@ void add_table(
 
     /* Initially always add table to inactive group. If the system is registered
      * with the table and the table is not empty, the table will send an
-     * activate signal to the system. */
-    table_data = ecs_array_add(
-        &system_data->inactive_tables, &system_data->table_params);
+     * activate signal to the system. Queries are not registered with tables,
+     * and skip empty tables while iterating, so their tables are always in the
+     * active group. */
+    if (system) {
+        table_data = ecs_array_add(
+            &system_data->inactive_tables, &system_data->table_params);
+    } else {
+        table_data = ecs_array_add(
+            &system_data->tables, &system_data->table_params);
+    }
 
     /* Add element to array that contains components for this table. Tables
      * typically share the same component list, unless the system contains OR
@@ -141,6 +159,21 @@ void add_table(
     /* Index in components array is at element 2 */
     table_data[COMPONENTS_INDEX] = ecs_array_count(system_data->components) - 1;
 
+    /* Depth is used to order tables of systems with a CASCADE column */
+    if (system_data->base.cascade_by) {
+        ecs_system_column_t *cascade_column = ecs_array_get(
+            system_data->base.columns, &column_arr_params, 
+            system_data->base.cascade_by - 1);
+        table_data[DEPTH_INDEX] = ecs_type_container_depth(
+            world, table_type, cascade_column->is.component);
+    } else {
+        table_data[DEPTH_INDEX] = 0;
+    }
+
+    /* Table is sorted when the sorted order of the system is computed */
+    table_data[SORTED_INDEX] = 0;
+    system_data->valid_order = false;
+
     /* Walk columns parsed from the system signature */
     ecs_system_column_t *columns = ecs_array_buffer(system_data->base.columns);
     uint32_t c, count = ecs_array_count(system_data->base.columns);
@@ -262,7 +295,15 @@ void add_table(
          * reference. Having the reference already linked to the system table
          * makes changing this administation easier when the change happens.
          * */
-        if (entity || table_data[i] == -1 || kind == EcsFromSingleton || kind == EcsCascade) {
+        /* If the table stores parents in a column, a container column for
+         * which no container was found in the type is resolved for each run
+         * of rows with the same parent. */
+        bool from_parent = kind == EcsFromContainer && !entity && 
+            table->parent_column;
+
+        if (entity || table_data[i] == -1 || kind == EcsFromSingleton || 
+            kind == EcsCascade || from_parent) 
+        {
             if (ecs_has(world, component, EcsComponent)) {
                 EcsComponent *component_data = ecs_get_ptr(
                         world, component, EcsComponent);
@@ -280,6 +321,8 @@ void add_table(
                         e = 0;
                     } else if (kind == EcsFromEntity) {
                         e = entity;
+                    } else if (from_parent) {
+                        e = ECS_INVALID_ENTITY;
                     } else {
                         e = get_entity_for_component(
                             world, entity, table_type, component);
@@ -312,7 +355,9 @@ void add_table(
         ref_data[ref].entity = 0;
     }
 
-    ecs_table_register_system(world, table, system);
+    if (system) {
+        ecs_table_register_system(world, table, system);
+    }
 }
 
 /* Utility function to update an index to a new value after a table has been
@@ -400,6 +445,11 @@ void remove_table(
         &system_data->component_params);        
 
     ecs_array_remove(tables, &system_data->table_params, table_data);
+
+    if (tables == system_data->tables) {
+        system_data->valid_schedule = false;
+        system_data->valid_order = false;
+    }
 }
 
 /* Match table with system */
@@ -439,8 +489,11 @@ bool match_table(
             if (elem_kind == EcsFromSelf) {
                 /* Already validated */
             } else if (elem_kind == EcsFromContainer) {
-                if (!ecs_components_contains_component(
-                    world, table_type, elem->is.component, NULL))
+                /* If the table stores parents in a column, the container is
+                 * resolved for each run of rows with the same parent */
+                if (!table->parent_column && 
+                    !ecs_components_contains_component(
+                        world, table_type, elem->is.component, NULL))
                 {
                     return false;
                 }
@@ -564,26 +617,86 @@ int32_t table_matched(
     return -1;
 }
 
-/* Does a system have references to shared components */
+/* Does a reference column of a system use a component that was added to or
+ * removed from a watched entity */
 static
-bool has_refs(
+bool uses_changed_components(
+    ecs_world_t *world,
     EcsColSystem *system_data)
 {
+    ecs_map_t *changed = world->changed_components;
     uint32_t i, count = ecs_array_count(system_data->base.columns);
     ecs_system_column_t *columns = ecs_array_buffer(system_data->base.columns);
 
+    if (!ecs_map_count(changed)) {
+        return false;
+    }
+
     for (i = 0; i < count; i ++) {
         ecs_system_expr_elem_kind_t elem_kind = columns[i].kind;
+        ecs_system_expr_oper_kind_t oper_kind = columns[i].oper_kind;
+
+        /* Only columns that are matched against the components of containers
+         * are affected by a rematch. If oper kind is Not and the query
+         * contained a shared expression, the expression is translated to
+         * FromId to prevent resolving the ref. */
+        if (elem_kind != EcsFromContainer && elem_kind != EcsCascade &&
+            !(oper_kind == EcsOperNot && elem_kind == EcsFromId))
+        {
+            continue;
+        }
+
+        if (oper_kind == EcsOperOr) {
+            ecs_array_t *type = ecs_map_get(
+                world->main_stage.type_index, columns[i].is.type);
+            ecs_entity_t *buffer = ecs_array_buffer(type);
+            uint32_t t, t_count = ecs_array_count(type);
+
+            for (t = 0; t < t_count; t ++) {
+                if (ecs_map_has(changed, buffer[t], NULL)) {
+                    return true;
+                }
+            }
+        } else if (ecs_map_has(changed, columns[i].is.component, NULL)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Was a parent added to or removed from a watched entity. This changes the
+ * depth of the tables that have the entity or its children in their type. */
+static
+bool changed_parent(
+    ecs_world_t *world)
+{
+    EcsIter it = ecs_map_iter(world->changed_components);
 
-        if (columns[i].oper_kind == EcsOperNot && elem_kind == EcsFromId) {
-            /* Special case: if oper kind is Not and the query contained a
-             * shared expression, the expression is translated to FromId to
-             * prevent resolving the ref */
+    while (ecs_iter_hasnext(&it)) {
+        uint64_t component;
+        ecs_map_next(&it, &component);
+
+        uint64_t row64 = ecs_map_get64(world->main_stage.entity_index, component);
+        if (row64 && ecs_to_row(row64).index < 0) {
             return true;
-        } else if (elem_kind != EcsFromSelf && elem_kind != EcsFromId) {
-            /* If the component is not from the entity being iterated over, and
-             * the column is not just passing an id, it must be a reference to
-             * another entity. */
+        }
+    }
+
+    return false;
+}
+
+/* Does the type of a table contain a watched entity that changed */
+static
+bool has_changed_container(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_entity_t *buffer = ecs_array_buffer(table->type);
+    uint32_t i, count = ecs_array_count(table->type);
+
+    for (i = 0; i < count; i ++) {
+        if (ecs_map_has(world->changed_containers, buffer[i], NULL)) {
             return true;
         }
     }
@@ -628,27 +741,32 @@ void resolve_cascade_container(
     }
 }
 
-/* -- Private API -- */
-
-/* Rematch system with tables after a change happened to a container or prefab */
-void ecs_rematch_system(
+/* Rematch system or query with tables after a container or prefab changed */
+static
+void rematch_tables(
     ecs_world_t *world,
-    ecs_entity_t system)
+    ecs_entity_t system,
+    EcsColSystem *system_data)
 {
-    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
-    ecs_assert(system_data != NULL, ECS_INTERNAL_ERROR, 0);
+    bool depth_changed = system_data->base.cascade_by && changed_parent(world);
 
-    /* Only rematch systems that have references */
-    if (has_refs(system_data)) {
+    /* Only rematch systems that have references to changed components */
+    if (depth_changed || uses_changed_components(world, system_data)) {
         ecs_array_t *tables = world->main_stage.tables;
         uint32_t i, count = ecs_array_count(tables);
         ecs_table_t *buffer = ecs_array_buffer(tables);
         bool changed = false;
 
         for (i = 0; i < count; i ++) {
+            ecs_table_t *table = &buffer[i];
+
+            /* Only tables with a changed container can match differently */
+            if (!has_changed_container(world, table)) {
+                continue;
+            }
+
             /* Is the system currently matched with the table? */
             int32_t match = table_matched(world, system_data, system_data->tables, i);
-            ecs_table_t *table = &buffer[i];
 
             if (match_table(world, table, system_data)) {
                 /* If the table matches, and it is not currently matched, add */
@@ -662,6 +780,7 @@ void ecs_rematch_system(
                 } else if (system_data->base.cascade_by) {
                     resolve_cascade_container(
                         world, system_data, match, table->type_id);
+                    changed = true;
                 }
             } else {
                 /* If table no longer matches, remove it */
@@ -683,87 +802,84 @@ void ecs_rematch_system(
         }
 
         /* If the system has a CASCADE column and modifications were made, 
-         * reorder the system tables so that the depth order is preserved */
-        if (changed && system_data->base.cascade_by) {
+         * reorder the system tables so that the depth order is preserved. This
+         * includes tables that were not visited, if one of their containers
+         * was moved to another parent. */
+        if ((changed || depth_changed) && system_data->base.cascade_by) {
             order_cascade_tables(world, system_data);
         }
     }
 }
 
-/** Match new table against system (table is created after system) */
-void ecs_col_system_notify_of_table(
+/* Remove all matches of a table that is about to be deleted. Returns whether
+ * the table was removed from the active tables. */
+static
+bool remove_matched_table(
     ecs_world_t *world,
-    ecs_entity_t system,
-    ecs_table_t *table)
+    EcsColSystem *system_data,
+    uint32_t table_index)
 {
-    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
-    assert(system_data != NULL);
-
-    if (match_table(world, table, system_data)) {
-        add_table(world, system, system_data, table);
+    int32_t match;
+    while ((match = table_matched(
+        world, system_data, system_data->inactive_tables, table_index)) != -1)
+    {
+        remove_table(world, system_data, system_data->inactive_tables, match);
     }
-}
 
-/** Table activation happens when a table was or becomes empty. Deactivated
- * tables are not considered by the system in the main loop. */
-void ecs_system_activate_table(
-    ecs_world_t *world,
-    ecs_entity_t system,
-    ecs_table_t *table,
-    bool active)
-{
-    ecs_array_t *src_array, *dst_array;
-    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
-    EcsSystemKind kind = system_data->base.kind;
-
-    uint32_t table_index = ecs_array_get_index(
-        world->main_stage.tables, &table_arr_params, table);
+    bool removed = false;
+    while ((match = table_matched(
+        world, system_data, system_data->tables, table_index)) != -1)
+    {
+        remove_table(world, system_data, system_data->tables, match);
+        removed = true;
+    }
 
-    if (active) {
-        src_array = system_data->inactive_tables;
-        dst_array = system_data->tables;
-    } else {
-        src_array = system_data->tables;
-        dst_array = system_data->inactive_tables;
+    /* Another table may be moved to the index, don't give it this cost */
+    if (table_index < ecs_array_count(system_data->row_costs)) {
+        ecs_row_cost_t *cost = ecs_array_get(
+            system_data->row_costs, &row_cost_arr_params, table_index);
+        memset(cost, 0, sizeof(ecs_row_cost_t));
     }
 
-    uint32_t i, count = ecs_array_count(src_array);
-    for (i = 0; i < count; i ++) {
-        uint32_t *index = ecs_array_get(
-            src_array, &system_data->table_params, i);
-        if (*index == table_index) {
-            break;
-        }
+    return removed;
+}
+
+/* Update the index of a matched table that moved in the world table array */
+static
+void move_matched_table(
+    EcsColSystem *system_data,
+    uint32_t old_index,
+    uint32_t new_index)
+{
+    if (!update_table_index(
+        system_data, system_data->tables, TABLE_INDEX, old_index, new_index))
+    {
+        update_table_index(
+            system_data, system_data->inactive_tables, TABLE_INDEX, old_index, 
+            new_index);
     }
 
-    ecs_assert(i != count, ECS_INTERNAL_ERROR, "cannot find table to (de)activate");
+    /* Estimated costs are stored by world table index */
+    ecs_row_cost_t *costs = ecs_array_buffer(system_data->row_costs);
+    uint32_t cost_count = ecs_array_count(system_data->row_costs);
+    ecs_row_cost_t moved = {0};
 
-    uint32_t src_count = ecs_array_move_index(
-        &dst_array, src_array, &system_data->table_params, i);
+    if (old_index < cost_count) {
+        moved = costs[old_index];
+        memset(&costs[old_index], 0, sizeof(ecs_row_cost_t));
+    }
 
-    if (active) {
-        uint32_t dst_count = ecs_array_count(dst_array);
-        if (kind != EcsManual) {
-            if (dst_count == 1 && system_data->base.enabled) {
-                ecs_world_activate_system(
-                    world, system, kind, true);
-            }
-        }
-        system_data->tables = dst_array;
-    } else {
-        if (kind != EcsManual) {
-            if (src_count == 0) {
-                ecs_world_activate_system(
-                    world, system, kind, false);
-            }
-        }
-        system_data->inactive_tables = dst_array;
+    if (new_index < cost_count) {
+        costs[new_index] = moved;
     }
 }
 
-ecs_entity_t ecs_new_col_system(
+/* Initialize data of system or query from its signature */
+static
+void init_system_data(
     ecs_world_t *world,
-    const char *id,
+    EcsColSystem *system_data,
+    ecs_entity_t system,
     EcsSystemKind kind,
     const char *sig,
     ecs_system_action_t action)
@@ -773,13 +889,6 @@ ecs_entity_t ecs_new_col_system(
         assert(0);
     }
 
-    ecs_entity_t result = _ecs_new(
-        world, world->t_col_system);
-
-    EcsId *id_data = ecs_get_ptr(world, result, EcsId);
-    *id_data = id;
-
-    EcsColSystem *system_data = ecs_get_ptr(world, result, EcsColSystem);
     memset(system_data, 0, sizeof(EcsColSystem));
     system_data->base.action = action;
     system_data->base.enabled = true;
@@ -793,7 +902,7 @@ ecs_entity_t ecs_new_col_system(
     system_data->ref_params.element_size = sizeof(ecs_system_ref_t) * count;
     system_data->component_params.element_size = sizeof(ecs_entity_t) * count;
     system_data->period = 0;
-    system_data->entity = result;
+    system_data->entity = system;
 
     system_data->components = ecs_array_new(
         &system_data->component_params, ECS_SYSTEM_INITIAL_TABLE_COUNT);
@@ -809,123 +918,1588 @@ ecs_entity_t ecs_new_col_system(
     }
 
     ecs_system_compute_and_families(world, &system_data->base);
+}
 
-    match_tables(world, result, system_data);
-
-    ecs_entity_t *elem = NULL;
-
-    if (kind == EcsManual) {
-        elem = ecs_array_add(&world->on_demand_systems, &handle_arr_params);
-    } else if (!ecs_array_count(system_data->tables)) {
-        elem = ecs_array_add(&world->inactive_systems, &handle_arr_params);
-    } else {
-        if (kind == EcsOnUpdate) {
-            elem = ecs_array_add(&world->on_update_systems, &handle_arr_params);
-        } else if (kind == EcsOnValidate) {
-            elem = ecs_array_add(&world->on_validate_systems, &handle_arr_params);            
-        } else if (kind == EcsPreUpdate) {
-            elem = ecs_array_add(&world->pre_update_systems, &handle_arr_params);
-        } else if (kind == EcsPostUpdate) {
-            elem = ecs_array_add(&world->post_update_systems, &handle_arr_params);
-        } else if (kind == EcsOnLoad) {
-            elem = ecs_array_add(&world->on_load_systems, &handle_arr_params);
-        } else if (kind == EcsPostLoad) {
-            elem = ecs_array_add(&world->post_load_systems, &handle_arr_params);            
-        } else if (kind == EcsPreStore) {
-            elem = ecs_array_add(&world->pre_store_systems, &handle_arr_params);
-        } else if (kind == EcsOnStore) {
-            elem = ecs_array_add(&world->on_store_systems, &handle_arr_params);
-        } else {
-            ecs_abort(ECS_INVALID_PARAMETERS, NULL);
-        }
-    }
+/** Values that rows of a table are sorted by */
+typedef struct sort_column_t {
+    ecs_compare_action_t compare;
+    ecs_entity_t *entities;
+    char *values;
+    uint32_t size;                /* 0 if all rows share the same value */
+} sort_column_t;
+
+/** Position of a table in the merged order of a sorted system */
+typedef struct sort_cursor_t {
+    ecs_table_t *table;
+    sort_column_t column;
+    uint32_t row;                 /* Current row */
+    uint32_t end;                 /* End of current run of enabled rows */
+    uint32_t count;               /* Number of rows in table */
+    bool has_value;               /* Does table have the sort component */
+} sort_cursor_t;
 
-    *elem = result;
+static
+const ecs_array_params_t slice_arr_params = {
+    .element_size = sizeof(ecs_sorted_slice_t)
+};
 
-    return result;
+static
+int compare_values(
+    sort_column_t *c1,
+    uint32_t r1,
+    sort_column_t *c2,
+    uint32_t r2)
+{
+    return c1->compare(
+        c1->entities[r1], ECS_OFFSET(c1->values, c1->size * r1),
+        c2->entities[r2], ECS_OFFSET(c2->values, c2->size * r2));
 }
 
-/* -- Public API -- */
-
+/** Sort an array of rows. This is a stable merge sort, as qsort cannot pass the
+ * column to the compare function, and the order of rows with equal values
+ * should not change between frames. */
 static
-bool should_run(
-    EcsColSystem *system_data,
-    float period,
-    float delta_time)
+void sort_rows(
+    sort_column_t *column,
+    uint32_t *rows,
+    uint32_t *tmp,
+    uint32_t count)
 {
-    float time_passed = system_data->time_passed + delta_time;
+    uint32_t *src = rows, *dst = tmp, *swap;
+    uint32_t width, i;
+
+    for (width = 1; width < count; width *= 2) {
+        for (i = 0; i < count; i += 2 * width) {
+            uint32_t mid = i + width < count ? i + width : count;
+            uint32_t end = i + 2 * width < count ? i + 2 * width : count;
+            uint32_t l = i, r = mid, k = i;
+
+            while (l < mid && r < end) {
+                if (compare_values(column, src[r], column, src[l]) < 0) {
+                    dst[k ++] = src[r ++];
+                } else {
+                    dst[k ++] = src[l ++];
+                }
+            }
 
-    delta_time = time_passed;
+            while (l < mid) {
+                dst[k ++] = src[l ++];
+            }
 
-    if (time_passed >= period) {
-        time_passed -= period;
-        if (time_passed > period) {
-            time_passed = 0;
+            while (r < end) {
+                dst[k ++] = src[r ++];
+            }
         }
 
-        system_data->time_passed = time_passed;
-    } else {
-        system_data->time_passed = time_passed;
-        return false;
+        swap = src;
+        src = dst;
+        dst = swap;
     }
 
-    return true;
+    if (src != rows) {
+        memcpy(rows, src, sizeof(uint32_t) * count);
+    }
 }
 
-ecs_entity_t _ecs_run_w_filter(
+/** Get the column with the values that rows of a table are sorted by. Rows are
+ * sorted by entity id if no component is provided. Returns false if the table
+ * does not have the sort component. */
+static
+bool get_sort_column(
     ecs_world_t *world,
-    ecs_entity_t system,
-    float delta_time,
-    uint32_t offset,
-    uint32_t limit,
-    ecs_type_t filter,
-    void *param)
+    ecs_table_t *table,
+    ecs_entity_t component,
+    ecs_compare_action_t compare,
+    sort_column_t *out)
 {
-    ecs_world_t *real_world = world;
+    ecs_entity_t *entities = ecs_array_buffer(table->columns[0].data);
 
-    if (world->magic == ECS_THREAD_MAGIC) {
-        real_world = ((ecs_thread_t*)world)->world; /* dispel the magic */
+    out->compare = compare;
+    out->entities = entities;
+
+    if (!component) {
+        out->values = (char*)entities;
+        out->size = sizeof(ecs_entity_t);
+        return true;
     }
 
-    ecs_entity_info_t entity_info = {0};
-    EcsColSystem *system_data = get_ptr(real_world, &real_world->main_stage, system, EEcsColSystem, false, false, &entity_info);
-    assert(system_data != NULL);
+    int32_t index = ecs_type_index_of(table->type, component);
 
-    if (!system_data->base.enabled) {
-        return 0;
+    if (index != -1) {
+        out->values = ecs_array_buffer(table->columns[index + 1].data);
+        out->size = table->columns[index + 1].size;
+    } else {
+        /* Component is shared by all rows, for example from a prefab */
+        ecs_entity_info_t info = {0};
+        out->values = get_ptr(world, &world->main_stage, entities[0], 
+            component, false, true, &info);
+        out->size = 0;
     }
 
-    ecs_stage_t *stage = ecs_get_stage(&real_world);
-
-    float system_delta_time = delta_time + system_data->time_passed;
-    float period = system_data->period;
-    bool measure_time = real_world->measure_system_time;
+    return out->values != NULL;
+}
 
-    ecs_array_t *tables = system_data->tables;
-    uint32_t tables_size = system_data->table_params.element_size;
-    int32_t *table_first = ecs_array_buffer(tables);
-    int32_t *table_last = ECS_OFFSET(table_first, tables_size * ecs_array_count(tables));
+/** Get version of the data a table is sorted by */
+static
+uint32_t sort_version(
+    EcsColSystem *system_data,
+    ecs_table_t *table)
+{
+    int32_t index = ecs_type_index_of(table->type, system_data->sort_on);
+    uint32_t version = table->column_versions[0];
 
-    if (table_first == table_last) {
-        return 0;
+    if (index != -1) {
+        version += table->column_versions[index + 1];
     }
 
-    if (period) {
-        if (!should_run(system_data, period, delta_time)) {
-            return 0;
-        }
-    }
+    return version;
+}
 
-    ecs_time_t time_start;
-    if (measure_time) {
-        ecs_os_get_time(&time_start);
+/** Move cursor to the next run of enabled rows of its table */
+static
+void cursor_next_run(
+    sort_cursor_t *cursor)
+{
+    if (cursor->table->disabled_count) {
+        uint32_t first = cursor->row;
+        uint32_t count = ecs_table_enabled_run(
+            cursor->table, &first, cursor->count);
+        cursor->row = first;
+        cursor->end = first + count;
+    } else {
+        cursor->end = cursor->count;
+    }
+}
+
+static
+int compare_cursors(
+    sort_cursor_t *c1,
+    sort_cursor_t *c2)
+{
+    return compare_values(&c1->column, c1->row, &c2->column, c2->row);
+}
+
+/** Merge the sorted rows of the tables of a system into a list of slices. A
+ * slice contains the rows of a table that come before the current row of any
+ * other table. Rows with equal values are ordered by table. */
+static
+void build_slices(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table = ecs_array_buffer(system_data->tables);
+    uint32_t t, table_count = ecs_array_count(system_data->tables);
+
+    if (!system_data->sorted_slices) {
+        system_data->sorted_slices = ecs_array_new(&slice_arr_params, 0);
+    } else {
+        ecs_array_clear(system_data->sorted_slices);
+    }
+
+    if (!table_count) {
+        return;
+    }
+
+    sort_cursor_t *cursors = ecs_os_malloc(sizeof(sort_cursor_t) * table_count);
+    ecs_assert(cursors != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    for (t = 0; t < table_count; t ++) {
+        sort_cursor_t *cursor = &cursors[t];
+        cursor->table = &world_tables[table[TABLE_INDEX]];
+        cursor->row = 0;
+        cursor->end = 0;
+        cursor->count = ecs_table_count(cursor->table);
+        cursor->has_value = cursor->count && get_sort_column(
+            world, cursor->table, system_data->sort_on, system_data->compare, 
+            &cursor->column);
+
+        if (cursor->has_value) {
+            cursor_next_run(cursor);
+        }
+
+        table = ECS_OFFSET(table, tables_size);
+    }
+
+    while (true) {
+        sort_cursor_t *best = NULL, *next = NULL;
+
+        for (t = 0; t < table_count; t ++) {
+            sort_cursor_t *cursor = &cursors[t];
+            if (cursor->row >= cursor->end) {
+                continue;
+            }
+
+            if (!best || compare_cursors(cursor, best) < 0) {
+                next = best;
+                best = cursor;
+            } else if (!next || compare_cursors(cursor, next) < 0) {
+                next = cursor;
+            }
+        }
+
+        if (!best) {
+            break;
+        }
+
+        /* Extend the slice until a row of another table comes first */
+        uint32_t count = 1;
+        while (best->row + count < best->end) {
+            if (next) {
+                int cmp = compare_values(&best->column, best->row + count, 
+                    &next->column, next->row);
+                if (cmp > 0 || (!cmp && best > next)) {
+                    break;
+                }
+            }
+            count ++;
+        }
+
+        ecs_sorted_slice_t *slice = ecs_array_add(
+            &system_data->sorted_slices, &slice_arr_params);
+        slice->table = best - cursors;
+        slice->offset = best->row;
+        slice->count = count;
+
+        best->row += count;
+        if (best->row == best->end) {
+            cursor_next_run(best);
+        }
+    }
+
+    /* Add rows of tables that do not have the sort component */
+    for (t = 0; t < table_count; t ++) {
+        sort_cursor_t *cursor = &cursors[t];
+        if (cursor->count && !cursor->has_value) {
+            cursor_next_run(cursor);
+            while (cursor->row < cursor->end) {
+                ecs_sorted_slice_t *slice = ecs_array_add(
+                    &system_data->sorted_slices, &slice_arr_params);
+                slice->table = t;
+                slice->offset = cursor->row;
+                slice->count = cursor->end - cursor->row;
+                cursor->row = cursor->end;
+                cursor_next_run(cursor);
+            }
+        }
+    }
+
+    ecs_os_free(cursors);
+}
+
+static
+bool should_run(
+    EcsColSystem *system_data,
+    float period,
+    float delta_time)
+{
+    float time_passed = system_data->time_passed + delta_time;
+
+    delta_time = time_passed;
+
+    if (time_passed >= period) {
+        time_passed -= period;
+        if (time_passed > period) {
+            time_passed = 0;
+        }
+
+        system_data->time_passed = time_passed;
+    } else {
+        system_data->time_passed = time_passed;
+        return false;
+    }
+
+    return true;
+}
+
+static
+const ecs_array_params_t snapshot_table_arr_params = {
+    .element_size = sizeof(ecs_snapshot_table_t)
+};
+
+/** Copy the enabled rows of a table column */
+static
+ecs_array_t* copy_enabled_rows(
+    ecs_table_t *table,
+    ecs_table_column_t *column,
+    uint32_t row_count)
+{
+    ecs_array_params_t params = {.element_size = column->size};
+    ecs_array_t *result = ecs_array_new(&params, row_count);
+    ecs_array_set_count(&result, &params, row_count);
+
+    char *dst = ecs_array_buffer(result);
+    char *src = ecs_array_buffer(column->data);
+    uint32_t size = column->size;
+    uint32_t first = 0, run_count, end = ecs_table_count(table);
+
+    if (!table->disabled_count) {
+        memcpy(dst, src, size * row_count);
+        return result;
+    }
+
+    while ((run_count = ecs_table_enabled_run(table, &first, end))) {
+        memcpy(dst, &src[first * size], size * run_count);
+        dst += size * run_count;
+        first += run_count;
+    }
+
+    return result;
+}
+
+/** Copy the values of the references of a system for a table */
+static
+void copy_references(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_snapshot_table_t *snapshot,
+    int32_t *table)
+{
+    uint32_t i, ref_count = table[REFS_COUNT];
+    ecs_reference_t *references = ecs_array_get(
+        system_data->refs, &system_data->ref_params, table[REFS_INDEX] - 1);
+
+    snapshot->ref_count = ref_count;
+    snapshot->references = ecs_os_malloc(sizeof(ecs_reference_t) * ref_count);
+    snapshot->ref_ptrs = ecs_os_calloc(sizeof(void*), ref_count);
+    ecs_assert(snapshot->references != NULL, ECS_OUT_OF_MEMORY, NULL);
+    ecs_assert(snapshot->ref_ptrs != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    memcpy(snapshot->references, references, 
+        sizeof(ecs_reference_t) * ref_count);
+
+    for (i = 0; i < ref_count; i ++) {
+        ecs_reference_t ref = references[i];
+        if (ref.entity == ECS_INVALID_ENTITY) {
+            continue;
+        }
+
+        ecs_entity_info_t info = {0};
+        void *ptr = get_ptr(world, &world->main_stage, ref.entity, 
+            ref.component, false, true, &info);
+        ecs_assert(ptr != NULL, ECS_UNRESOLVED_REFERENCE, NULL);
+
+        ecs_entity_info_t component_info = {0};
+        EcsComponent *cdata = get_ptr(world, &world->main_stage, 
+            ref.component, EEcsComponent, false, false, &component_info);
+
+        if (cdata && cdata->size) {
+            snapshot->ref_ptrs[i] = ecs_os_malloc(cdata->size);
+            ecs_assert(snapshot->ref_ptrs[i] != NULL, ECS_OUT_OF_MEMORY, NULL);
+            memcpy(snapshot->ref_ptrs[i], ptr, cdata->size);
+        }
+    }
+}
+
+/* -- Private API -- */
+
+/* Rematch system with tables after a change happened to a container or prefab */
+void ecs_rematch_system(
+    ecs_world_t *world,
+    ecs_entity_t system)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    ecs_assert(system_data != NULL, ECS_INTERNAL_ERROR, 0);
+
+    rematch_tables(world, system, system_data);
+}
+
+/** Match new table against system (table is created after system) */
+void ecs_col_system_notify_of_table(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_table_t *table)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    assert(system_data != NULL);
+
+    if (match_table(world, table, system_data)) {
+        add_table(world, system, system_data, table);
+    }
+}
+
+/** Table activation happens when a table was or becomes empty. Deactivated
+ * tables are not considered by the system in the main loop. */
+void ecs_system_activate_table(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    ecs_table_t *table,
+    bool active)
+{
+    ecs_array_t *src_array, *dst_array;
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    EcsSystemKind kind = system_data->base.kind;
+
+    uint32_t table_index = ecs_array_get_index(
+        world->main_stage.tables, &table_arr_params, table);
+
+    if (active) {
+        src_array = system_data->inactive_tables;
+        dst_array = system_data->tables;
+    } else {
+        src_array = system_data->tables;
+        dst_array = system_data->inactive_tables;
+    }
+
+    uint32_t i, count = ecs_array_count(src_array);
+    for (i = 0; i < count; i ++) {
+        uint32_t *index = ecs_array_get(
+            src_array, &system_data->table_params, i);
+        if (*index == table_index) {
+            break;
+        }
+    }
+
+    ecs_assert(i != count, ECS_INTERNAL_ERROR, "cannot find table to (de)activate");
+
+    uint32_t src_count = ecs_array_move_index(
+        &dst_array, src_array, &system_data->table_params, i);
+
+    if (active) {
+        uint32_t dst_count = ecs_array_count(dst_array);
+
+        if (kind != EcsManual) {
+            if (dst_count == 1 && system_data->base.enabled) {
+                ecs_world_activate_system(
+                    world, system, kind, true);
+            }
+        }
+        system_data->tables = dst_array;
+    } else {
+        if (kind != EcsManual) {
+            if (src_count == 0) {
+                ecs_world_activate_system(
+                    world, system, kind, false);
+            }
+        }
+        system_data->inactive_tables = dst_array;
+    }
+
+    system_data->valid_schedule = false;
+    system_data->valid_order = false;
+
+    /* Moving tables between arrays does not preserve the order of the active
+     * tables, so restore the ordering by depth */
+    if (system_data->base.cascade_by) {
+        ecs_array_sort(
+            system_data->tables, &system_data->table_params, table_compare);
+    }
+}
+
+/** Remove a table that is about to be deleted from the system */
+void ecs_system_remove_table(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    uint32_t table_index)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    ecs_assert(system_data != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    bool removed = remove_matched_table(world, system_data, table_index);
+
+    EcsSystemKind kind = system_data->base.kind;
+    if (removed && kind != EcsManual && !ecs_array_count(system_data->tables)) {
+        ecs_world_activate_system(world, system, kind, false);
+    }
+}
+
+/** A table moved to another index in the world table array */
+void ecs_system_move_table(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    uint32_t old_index,
+    uint32_t new_index)
+{
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    ecs_assert(system_data != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    move_matched_table(system_data, old_index, new_index);
+}
+
+/** Sort rows of a table in place. Rows are only moved if they are not already
+ * in order. Tables that store parents in a column stay ordered by depth. */
+bool ecs_table_sort(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_entity_t component,
+    ecs_compare_action_t compare)
+{
+    uint32_t i, count = ecs_table_count(table);
+    sort_column_t column;
+
+    if (count < 2 || table->parent_column) {
+        return false;
+    }
+
+    if (!get_sort_column(world, table, component, compare, &column) || 
+        !column.size) 
+    {
+        return false;
+    }
+
+    for (i = 1; i < count; i ++) {
+        if (compare_values(&column, i - 1, &column, i) > 0) {
+            break;
+        }
+    }
+
+    if (i == count) {
+        return false;
+    }
+
+    uint32_t *rows = ecs_os_malloc(sizeof(uint32_t) * count * 2);
+    ecs_assert(rows != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    for (i = 0; i < count; i ++) {
+        rows[i] = i;
+    }
+
+    sort_rows(&column, rows, &rows[count], count);
+    ecs_table_reorder(world, table, rows);
+
+    ecs_os_free(rows);
+
+    return true;
+}
+
+/** Mark the tables of a sorted system, so defragmenting doesn't undo the order
+ * of its rows */
+void ecs_system_mark_sorted(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    if (!system_data->sort_on) {
+        return;
+    }
+
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+
+    for (i = 0; i < count; i ++) {
+        world_tables[table[TABLE_INDEX]].is_sorted = true;
+        table = ECS_OFFSET(table, tables_size);
+    }
+}
+
+/** Sort the rows of the tables of a system by its sort component, and merge
+ * them into a single order. Only tables of which the rows or the sort column
+ * changed since they were last sorted are sorted again. */
+void ecs_system_sort_tables(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    if (!system_data->sort_on) {
+        return;
+    }
+
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+    bool valid = system_data->valid_order, changed = !valid;
+
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *w_table = &world_tables[table[TABLE_INDEX]];
+
+        /* Defragmenting must not undo the order of the system */
+        w_table->is_sorted = true;
+
+        if (!valid || 
+            sort_version(system_data, w_table) != (uint32_t)table[SORTED_INDEX]) 
+        {
+            ecs_table_sort(
+                world, w_table, system_data->sort_on, system_data->compare);
+            table[SORTED_INDEX] = sort_version(system_data, w_table);
+            changed = true;
+        }
+
+        table = ECS_OFFSET(table, tables_size);
+    }
+
+    if (changed) {
+        build_slices(world, system_data);
+        system_data->valid_order = true;
+    }
+}
+
+/** Test if the sorted order of a system is up to date with its tables */
+static
+bool valid_sort_order(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    if (!system_data->valid_order) {
+        return false;
+    }
+
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *w_table = &world_tables[table[TABLE_INDEX]];
+        uint32_t version = sort_version(system_data, w_table);
+        if (version != (uint32_t)table[SORTED_INDEX]) {
+            return false;
+        }
+
+        table = ECS_OFFSET(table, tables_size);
+    }
+
+    return true;
+}
+
+/** Advance the cursor of a time sliced system. Each slice has the number of
+ * rows of the system divided by the number of frames, so that all rows are
+ * visited once every slice_frames frames. The cursor is an offset in the rows
+ * of all matched tables, which is the same offset that ecs_col_system_run
+ * accepts. When the rows shrink below the cursor, the next slice starts from
+ * the first row again. */
+bool ecs_system_next_slice(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    uint32_t *offset,
+    uint32_t *limit)
+{
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+    uint32_t frames = system_data->slice_frames, total_rows = 0;
+
+    for (i = 0; i < count; i ++) {
+        total_rows += ecs_table_count(&world_tables[table[TABLE_INDEX]]);
+        table = ECS_OFFSET(table, tables_size);
+    }
+
+    if (!total_rows) {
+        return false;
+    }
+
+    uint32_t slice_rows = (total_rows + frames - 1) / frames;
+    uint32_t cursor = system_data->slice_cursor;
+
+    if (cursor >= total_rows) {
+        cursor = 0;
+    }
+
+    *offset = cursor;
+    *limit = slice_rows;
+    system_data->slice_cursor = cursor + slice_rows;
+
+    return true;
+}
+
+/** Register that a system may have written the columns it matched. Signatures
+ * do not specify whether a column is only read, so all owned columns that the
+ * system accesses are registered as changed. */
+void ecs_system_mark_changed(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+    uint32_t c, column_count = ecs_array_count(system_data->base.columns);
+
+    for (i = 0; i < count; i ++) {
+        ecs_table_t *w_table = &world_tables[table[TABLE_INDEX]];
+
+        for (c = 0; c < column_count; c ++) {
+            int32_t index = table[COLUMNS_INDEX + c];
+            if (index > 0) {
+                ecs_table_column_changed(w_table, index);
+            }
+        }
+
+        table = ECS_OFFSET(table, tables_size);
+    }
+}
+
+/** Can a system run from a copy of its data. Systems that read components of
+ * parents, or of which the rows to visit depend on the frame, can't. */
+bool ecs_system_can_snapshot(
+    EcsColSystem *system_data)
+{
+    if (system_data->base.cascade_by || system_data->sort_on || 
+        system_data->slice_frames) 
+    {
+        return false;
+    }
+
+    ecs_system_column_t *columns = ecs_array_buffer(system_data->base.columns);
+    uint32_t i, count = ecs_array_count(system_data->base.columns);
+
+    for (i = 0; i < count; i ++) {
+        if (columns[i].kind == EcsFromContainer) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Copy the rows and references that a system reads in the current frame.
+ * Returns false if the system does not run in this frame. */
+bool ecs_system_snapshot(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_snapshot_system_t *out)
+{
+    float delta_time = world->delta_time + system_data->time_passed;
+    float period = system_data->period;
+
+    if (!system_data->base.enabled) {
+        return false;
+    }
+
+    if (period && !should_run(system_data, period, world->delta_time)) {
+        return false;
+    }
+
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+    uint32_t c, column_count = ecs_array_count(system_data->base.columns);
+
+    out->entity = system_data->entity;
+    out->action = system_data->base.action;
+    out->column_count = column_count;
+    out->delta_time = delta_time;
+    out->tables = ecs_array_new(&snapshot_table_arr_params, count);
+
+    for (i = 0; i < count; i ++, table = ECS_OFFSET(table, tables_size)) {
+        ecs_table_t *w_table = &world_tables[table[TABLE_INDEX]];
+        uint32_t row_count = ecs_table_count(w_table) - w_table->disabled_count;
+
+        if (!row_count) {
+            continue;
+        }
+
+        ecs_snapshot_table_t *snapshot = ecs_array_add(
+            &out->tables, &snapshot_table_arr_params);
+
+        snapshot->count = row_count;
+        snapshot->column_count = ecs_array_count(w_table->type) + 1;
+        snapshot->columns = ecs_os_calloc(
+            sizeof(ecs_table_column_t), snapshot->column_count);
+        snapshot->columns_map = ecs_os_malloc(sizeof(int32_t) * column_count);
+        snapshot->components = ecs_os_malloc(
+            sizeof(ecs_entity_t) * column_count);
+        ecs_assert(snapshot->columns != NULL, ECS_OUT_OF_MEMORY, NULL);
+        ecs_assert(snapshot->columns_map != NULL, ECS_OUT_OF_MEMORY, NULL);
+        ecs_assert(snapshot->components != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+        memcpy(snapshot->columns_map, &table[COLUMNS_INDEX], 
+            sizeof(int32_t) * column_count);
+        memcpy(snapshot->components, ECS_OFFSET(
+            ecs_array_buffer(system_data->components),
+            system_data->component_params.element_size * 
+                table[COMPONENTS_INDEX]), 
+            sizeof(ecs_entity_t) * column_count);
+
+        /* Entities are always copied, other columns only if accessed */
+        snapshot->columns[0].size = w_table->columns[0].size;
+        snapshot->columns[0].data = copy_enabled_rows(
+            w_table, &w_table->columns[0], row_count);
+
+        for (c = 0; c < column_count; c ++) {
+            int32_t index = table[COLUMNS_INDEX + c];
+            if (index > 0 && !snapshot->columns[index].data) {
+                snapshot->columns[index].size = w_table->columns[index].size;
+                snapshot->columns[index].data = copy_enabled_rows(
+                    w_table, &w_table->columns[index], row_count);
+            }
+        }
+
+        if (table[REFS_INDEX]) {
+            copy_references(world, system_data, snapshot, table);
+        } else {
+            snapshot->references = NULL;
+            snapshot->ref_ptrs = NULL;
+            snapshot->ref_count = 0;
+        }
+    }
+
+    ecs_system_mark_changed(world, system_data);
+
+    return true;
+}
+
+/** Run a system on a copy of its data. This does not access the tables or the
+ * system data, which may be modified by another thread while it runs. */
+void ecs_snapshot_run(
+    ecs_world_t *world,
+    ecs_snapshot_system_t *snapshot)
+{
+    ecs_snapshot_table_t *tables = ecs_array_buffer(snapshot->tables);
+    uint32_t i, count = ecs_array_count(snapshot->tables);
+
+    ecs_rows_t info = {
+        .world = world,
+        .system = snapshot->entity,
+        .column_count = snapshot->column_count,
+        .delta_time = snapshot->delta_time
+    };
+
+    for (i = 0; i < count; i ++) {
+        ecs_snapshot_table_t *table = &tables[i];
+
+        info.columns = table->columns_map;
+        info.table_columns = table->columns;
+        info.components = table->components;
+        info.references = table->references;
+        info.ref_ptrs = table->ref_ptrs;
+        info.entities = ecs_array_buffer(table->columns[0].data);
+        info.offset = 0;
+        info.count = table->count;
+
+        snapshot->action(&info);
+
+        info.frame_offset += table->count;
+
+        if (info.interrupted_by) {
+            break;
+        }
+    }
+}
+
+void ecs_snapshot_free(
+    ecs_snapshot_system_t *snapshot)
+{
+    ecs_snapshot_table_t *tables = ecs_array_buffer(snapshot->tables);
+    uint32_t i, count = ecs_array_count(snapshot->tables);
+
+    for (i = 0; i < count; i ++) {
+        ecs_snapshot_table_t *table = &tables[i];
+        uint32_t c;
+
+        for (c = 0; c < table->column_count; c ++) {
+            ecs_array_free(table->columns[c].data);
+        }
+
+        for (c = 0; c < table->ref_count; c ++) {
+            ecs_os_free(table->ref_ptrs[c]);
+        }
+
+        ecs_os_free(table->columns);
+        ecs_os_free(table->columns_map);
+        ecs_os_free(table->components);
+        ecs_os_free(table->references);
+        ecs_os_free(table->ref_ptrs);
+    }
+
+    ecs_array_free(snapshot->tables);
+}
+
+ecs_entity_t ecs_new_col_system(
+    ecs_world_t *world,
+    const char *id,
+    EcsSystemKind kind,
+    const char *sig,
+    ecs_system_action_t action)
+{
+    ecs_entity_t result = _ecs_new(
+        world, world->t_col_system);
+
+    EcsId *id_data = ecs_get_ptr(world, result, EcsId);
+    *id_data = id;
+
+    EcsColSystem *system_data = ecs_get_ptr(world, result, EcsColSystem);
+    init_system_data(world, system_data, result, kind, sig, action);
+
+    match_tables(world, result, system_data);
+
+    ecs_entity_t *elem = NULL;
+
+    if (kind == EcsManual) {
+        elem = ecs_array_add(&world->on_demand_systems, &handle_arr_params);
+    } else if (!ecs_array_count(system_data->tables)) {
+        elem = ecs_array_add(&world->inactive_systems, &handle_arr_params);
+    } else {
+        if (kind == EcsOnUpdate) {
+            elem = ecs_array_add(&world->on_update_systems, &handle_arr_params);
+        } else if (kind == EcsOnValidate) {
+            elem = ecs_array_add(&world->on_validate_systems, &handle_arr_params);            
+        } else if (kind == EcsPreUpdate) {
+            elem = ecs_array_add(&world->pre_update_systems, &handle_arr_params);
+        } else if (kind == EcsPostUpdate) {
+            elem = ecs_array_add(&world->post_update_systems, &handle_arr_params);
+        } else if (kind == EcsOnLoad) {
+            elem = ecs_array_add(&world->on_load_systems, &handle_arr_params);
+        } else if (kind == EcsPostLoad) {
+            elem = ecs_array_add(&world->post_load_systems, &handle_arr_params);            
+        } else if (kind == EcsPreStore) {
+            elem = ecs_array_add(&world->pre_store_systems, &handle_arr_params);
+        } else if (kind == EcsOnStore) {
+            elem = ecs_array_add(&world->on_store_systems, &handle_arr_params);
+        } else {
+            ecs_abort(ECS_INVALID_PARAMETERS, NULL);
+        }
+    }
+
+    *elem = result;
+
+    return result;
+}
+
+/** Match new table against query (table is created after query) */
+void ecs_query_notify_of_table(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_table_t *table)
+{
+    EcsColSystem *system_data = &query->system;
+
+    if (match_table(world, table, system_data)) {
+        add_table(world, 0, system_data, table);
+
+        /* Query tables are not activated, so keep the depth order here */
+        if (system_data->base.cascade_by) {
+            order_cascade_tables(world, system_data);
+        }
+    }
+}
+
+/** Remove a table that is about to be deleted from the query */
+void ecs_query_remove_table(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    uint32_t table_index)
+{
+    remove_matched_table(world, &query->system, table_index);
+}
+
+/** A table moved to another index in the world table array */
+void ecs_query_move_table(
+    ecs_query_t *query,
+    uint32_t old_index,
+    uint32_t new_index)
+{
+    move_matched_table(&query->system, old_index, new_index);
+}
+
+/* Rematch query with tables after a change happened to a container or prefab */
+void ecs_query_rematch(
+    ecs_world_t *world,
+    ecs_query_t *query)
+{
+    rematch_tables(world, 0, &query->system);
+}
+
+/* -- Public API -- */
+
+/** Resolve container references of a run of rows that share the same parent.
+ * Returns false if the rows should not be passed to the system, which happens
+ * when the parent does not have a component required by the system. */
+static
+bool resolve_parent_refs(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_rows_t *info,
+    int32_t *table_data,
+    ecs_reference_t *references,
+    ecs_entity_t parent)
+{
+    ecs_system_column_t *columns = ecs_array_buffer(system_data->base.columns);
+    uint32_t i, count = ecs_array_count(system_data->base.columns);
+    ecs_type_t not_from_component = system_data->base.not_from_component;
+
+    if (parent && not_from_component) {
+        ecs_row_t row = ecs_to_row(
+            ecs_map_get64(world->main_stage.entity_index, parent));
+        if (row.type_id && ecs_type_contains(world, &world->main_stage, 
+            row.type_id, not_from_component, false, true))
+        {
+            return false;
+        }
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_system_expr_elem_kind_t kind = columns[i].kind;
+        if (kind != EcsFromContainer && kind != EcsCascade) {
+            continue;
+        }
+
+        int32_t index = table_data[COLUMNS_INDEX + i];
+        if (index >= 0) {
+            continue;
+        }
+
+        /* References that were resolved from the table type are not resolved
+         * from the parent column */
+        int32_t ref = -index - 1;
+        if (references[ref].entity != ECS_INVALID_ENTITY) {
+            continue;
+        }
+
+        void *ptr = NULL;
+        if (parent) {
+            ecs_entity_info_t entity_info = {0};
+            ptr = get_ptr(world, &world->main_stage, parent, 
+                references[ref].component, false, true, &entity_info);
+        }
+
+        if (!ptr && kind == EcsFromContainer && 
+            columns[i].oper_kind == EcsOperAnd) 
+        {
+            return false;
+        }
+
+        info->references[ref].entity = ptr ? parent : ECS_INVALID_ENTITY;
+        info->ref_ptrs[ref] = ptr;
+    }
+
+    return true;
+}
+
+/** Invoke system action for a range of rows. If the table stores the parent of
+ * each row in a column, the range is split up in runs of rows that share the
+ * same parent, and container references are resolved for each run. */
+static
+void invoke_rows(
+    ecs_world_t *real_world,
+    EcsColSystem *system_data,
+    ecs_rows_t *info,
+    ecs_table_t *table,
+    int32_t *table_data,
+    ecs_entity_t *entity_buffer,
+    uint32_t first,
+    uint32_t count,
+    uint32_t frame_offset)
+{
+    ecs_system_action_t action = system_data->base.action;
+    int16_t parent_column = table->parent_column;
+
+    if (!parent_column || !info->references) {
+        info->offset = first;
+        info->count = count;
+        info->entities = &entity_buffer[first];
+        info->frame_offset = frame_offset;
+        action(info);
+        return;
+    }
+
+    /* Resolved references differ per run, so don't write them to the system */
+    uint32_t ref_count = table_data[REFS_COUNT];
+    ecs_reference_t *references = info->references;
+    ecs_reference_t *run_references = ecs_os_alloca(ecs_reference_t, ref_count);
+    memcpy(run_references, references, sizeof(ecs_reference_t) * ref_count);
+    info->references = run_references;
+
+    EcsParent *parents = ecs_array_buffer(table->columns[parent_column].data);
+    uint32_t run_first = first, end = first + count;
+
+    while (run_first < end) {
+        ecs_entity_t parent = parents[run_first].entity;
+        uint32_t run_end = run_first + 1;
+
+        while (run_end < end && parents[run_end].entity == parent) {
+            run_end ++;
+        }
+
+        if (resolve_parent_refs(real_world, system_data, info, table_data, 
+            references, parent)) 
+        {
+            info->offset = run_first;
+            info->count = run_end - run_first;
+            info->entities = &entity_buffer[run_first];
+            info->frame_offset = frame_offset + run_first - first;
+            action(info);
+
+            if (info->interrupted_by) {
+                break;
+            }
+        }
+
+        run_first = run_end;
+    }
+
+    info->references = references;
+}
+
+/** Get number of hierarchy levels visited by a system with a CASCADE column.
+ * If the system matched tables that store parents in a column, rows of these
+ * tables can have different depths, and the system visits the tables once for
+ * each depth. Otherwise the table order already respects the depth. */
+static
+uint32_t cascade_level_count(
+    ecs_world_t *real_world,
+    int32_t *table_first,
+    int32_t *table_last,
+    uint32_t tables_size)
+{
+    ecs_table_t *world_tables = ecs_array_buffer(real_world->main_stage.tables);
+    uint32_t level_count = 0;
+    bool has_parent_column = false;
+    int32_t *table;
+
+    for (table = table_first; table < table_last; 
+        table = ECS_OFFSET(table, tables_size)) 
+    {
+        ecs_table_t *w_table = &world_tables[table[TABLE_INDEX]];
+        uint32_t table_levels;
+
+        if (w_table->parent_column) {
+            table_levels = ecs_array_count(w_table->depth_offsets);
+            if (table_levels) {
+                table_levels --;
+            }
+            has_parent_column = true;
+        } else {
+            table_levels = table[DEPTH_INDEX] + 1;
+        }
+
+        if (table_levels > level_count) {
+            level_count = table_levels;
+        }
+    }
+
+    if (!has_parent_column) {
+        return 1;
+    }
+
+    return level_count;
+}
+
+/** Get rows of table that are on the specified hierarchy level */
+static
+bool table_level_range(
+    ecs_table_t *w_table,
+    int32_t *table,
+    uint32_t level,
+    uint32_t *first,
+    uint32_t *count)
+{
+    if (w_table->parent_column) {
+        uint32_t *offsets = ecs_array_buffer(w_table->depth_offsets);
+        uint32_t offset_count = ecs_array_count(w_table->depth_offsets);
+
+        if (level + 1 >= offset_count) {
+            return false;
+        }
+
+        *first = offsets[level];
+        *count = offsets[level + 1] - offsets[level];
+    } else if ((uint32_t)table[DEPTH_INDEX] != level) {
+        return false;
+    }
+
+    return *count != 0;
+}
+
+/** Advance to next table. When a system visits tables once for each hierarchy
+ * level, wrap around to the first table until all levels have been visited. */
+static
+int32_t* next_table(
+    int32_t *table,
+    uint32_t tables_size,
+    int32_t *table_first,
+    int32_t *table_last,
+    uint32_t *level,
+    uint32_t level_count)
+{
+    table = ECS_OFFSET(table, tables_size);
+
+    if (table == table_last && ++ (*level) < level_count) {
+        table = table_first;
+    }
+
+    return table;
+}
+
+/** Update estimated costs of the tables of a system that were measured while
+ * it ran */
+static
+void update_row_costs(
+    EcsColSystem *system_data)
+{
+    void *ptr = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+    size_t size = system_data->table_params.element_size;
+
+    for (i = 0; i < count; i ++, ptr = ECS_OFFSET(ptr, size)) {
+        ecs_system_update_row_cost(system_data, *(uint32_t*)ptr);
+    }
+}
+
+/** Add time spent on the rows of a table. The time is averaged when the
+ * estimated cost of the table is updated. */
+void ecs_system_measure_rows(
+    EcsColSystem *system_data,
+    uint32_t table_index,
+    float time_spent,
+    uint32_t count)
+{
+    uint32_t cost_count = ecs_array_count(system_data->row_costs);
+
+    if (!system_data->row_costs) {
+        system_data->row_costs = ecs_array_new(
+            &row_cost_arr_params, table_index + 1);
+    }
+
+    if (table_index >= cost_count) {
+        ecs_array_set_count(
+            &system_data->row_costs, &row_cost_arr_params, table_index + 1);
+
+        ecs_row_cost_t *buffer = ecs_array_buffer(system_data->row_costs);
+        memset(&buffer[cost_count], 0, 
+            (table_index + 1 - cost_count) * sizeof(ecs_row_cost_t));
+    }
+
+    ecs_row_cost_t *cost = ecs_array_get(
+        system_data->row_costs, &row_cost_arr_params, table_index);
+    cost->time_spent += time_spent;
+    cost->count += count;
+}
+
+/** Update estimated cost of a row of a table with the time measured since the
+ * last update. The estimate is a moving average, so that a single slow frame
+ * doesn't upset the job schedule. */
+void ecs_system_update_row_cost(
+    EcsColSystem *system_data,
+    uint32_t table_index)
+{
+    if (table_index >= ecs_array_count(system_data->row_costs)) {
+        return;
+    }
+
+    ecs_row_cost_t *cost = ecs_array_get(
+        system_data->row_costs, &row_cost_arr_params, table_index);
+    if (!cost->count) {
+        return;
+    }
+
+    float measured = cost->time_spent / cost->count;
+
+    if (cost->cost) {
+        cost->cost += (measured - cost->cost) * ECS_COST_SMOOTHING;
+    } else {
+        cost->cost = measured;
+    }
+
+    cost->time_spent = 0;
+    cost->count = 0;
+}
+
+/** Get estimated time it takes to run a system for a row of a table. Returns
+ * 0 if the system has not been measured for the table. */
+float ecs_system_row_cost(
+    EcsColSystem *system_data,
+    uint32_t table_index)
+{
+    if (table_index >= ecs_array_count(system_data->row_costs)) {
+        return 0;
+    }
+
+    ecs_row_cost_t *cost = ecs_array_get(
+        system_data->row_costs, &row_cost_arr_params, table_index);
+    return cost->cost;
+}
+
+/** Count rows of a system with a CASCADE column per hierarchy level. Levels are
+ * counted in the order in which _ecs_run_w_filter visits them, so that the rows
+ * of a single level form one contiguous range of offsets. */
+uint32_t ecs_system_level_rows(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_array_t **rows_out)
+{
+    ecs_table_t *world_tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table_first = ecs_array_buffer(system_data->tables);
+    int32_t *table_last = ECS_OFFSET(table_first, 
+        tables_size * ecs_array_count(system_data->tables));
+    int32_t *table;
+    uint32_t level, level_count = 0;
+
+    for (table = table_first; table < table_last; 
+        table = ECS_OFFSET(table, tables_size)) 
+    {
+        ecs_table_t *w_table = &world_tables[table[TABLE_INDEX]];
+        uint32_t table_levels;
+
+        if (w_table->parent_column) {
+            table_levels = ecs_array_count(w_table->depth_offsets);
+            if (table_levels) {
+                table_levels --;
+            }
+        } else {
+            table_levels = table[DEPTH_INDEX] + 1;
+        }
+
+        if (table_levels > level_count) {
+            level_count = table_levels;
+        }
+    }
+
+    if (!*rows_out) {
+        *rows_out = ecs_array_new(&level_arr_params, level_count);
+    }
+
+    ecs_array_set_count(rows_out, &level_arr_params, level_count);
+    uint32_t *rows = ecs_array_buffer(*rows_out);
+
+    for (level = 0; level < level_count; level ++) {
+        rows[level] = 0;
+
+        for (table = table_first; table < table_last; 
+            table = ECS_OFFSET(table, tables_size)) 
+        {
+            ecs_table_t *w_table = &world_tables[table[TABLE_INDEX]];
+            uint32_t first = 0, count = ecs_table_count(w_table);
+
+            if (table_level_range(w_table, table, level, &first, &count)) {
+                rows[level] += count;
+            }
+        }
+    }
+
+    return level_count;
+}
+
+/** Apply the remaining offset and limit of a run to a range of rows. Returns
+ * false if the limit has been reached. */
+static
+bool offset_limit_range(
+    uint32_t *first,
+    uint32_t *count,
+    uint32_t *offset,
+    uint32_t *limit,
+    bool limit_set)
+{
+    if (*offset) {
+        if (*offset > *count) {
+            *offset -= *count;
+            *count = 0;
+            return true;
+        } else {
+            *first += *offset;
+            *count -= *offset;
+            *offset = 0;
+        }
+    }
+
+    if (*limit) {
+        if (*limit > *count) {
+            *limit -= *count;
+        } else {
+            *count = *limit;
+            *limit = 0;
+        }
+    } else if (limit_set) {
+        return false;
+    }
+
+    return true;
+}
+
+/** Prepare rows for a matched table. References that do not depend on the row
+ * are resolved once per table. */
+static
+void init_table_rows(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_rows_t *rows,
+    ecs_table_t *w_table,
+    int32_t *table)
+{
+    uint32_t ref_index = table[REFS_INDEX];
+
+    if (ref_index) {
+        rows->references = ecs_array_get(
+            system_data->refs, &system_data->ref_params, ref_index - 1);
+
+        int i, ref_count = table[REFS_COUNT];
+
+        for (i = 0; i < ref_count; i ++) {
+            ecs_reference_t ref = rows->references[i];
+
+            if (ref.entity != ECS_INVALID_ENTITY) {
+                ecs_entity_info_t entity_info = {0};
+                rows->ref_ptrs[i] = get_ptr(world, &world->main_stage,
+                    ref.entity, ref.component, false, true, &entity_info);
+
+                ecs_assert(rows->ref_ptrs[i] != NULL, 
+                    ECS_UNRESOLVED_REFERENCE, NULL);
+            } else {
+                rows->ref_ptrs[i] = NULL;
+            }
+        }
+    } else {
+        rows->references = NULL;
+    }
+
+    rows->columns = &table[COLUMNS_INDEX];
+    rows->table_columns = w_table->columns;
+    rows->components = ECS_OFFSET(ecs_array_buffer(system_data->components),
+        system_data->component_params.element_size * table[COMPONENTS_INDEX]);
+}
+
+/** Run a system over the rows of its tables in sorted order */
+static
+ecs_entity_t run_sorted(
+    ecs_world_t *real_world,
+    ecs_stage_t *stage,
+    EcsColSystem *system_data,
+    ecs_rows_t *info,
+    uint32_t offset,
+    uint32_t limit,
+    ecs_type_t filter)
+{
+    ecs_sorted_slice_t *slices = ecs_array_buffer(system_data->sorted_slices);
+    uint32_t i, count = ecs_array_count(system_data->sorted_slices);
+    bool offset_limit = (offset | limit) != 0;
+    bool limit_set = limit != 0;
+
+    for (i = 0; i < count; i ++) {
+        int32_t *table = ecs_array_get(
+            system_data->tables, &system_data->table_params, slices[i].table);
+        ecs_table_t *w_table = ecs_array_get(
+            real_world->main_stage.tables, &table_arr_params, 
+            table[TABLE_INDEX]);
+        uint32_t first = slices[i].offset, row_count = slices[i].count;
+
+        if (filter) {
+            if (!ecs_type_contains(
+                real_world, stage, w_table->type_id, filter, true, true))
+            {
+                continue;
+            }
+        }
+
+        if (offset_limit && !offset_limit_range(
+            &first, &row_count, &offset, &limit, limit_set))
+        {
+            break;
+        }
+
+        if (!row_count) {
+            continue;
+        }
+
+        init_table_rows(real_world, system_data, info, w_table, table);
+
+        invoke_rows(real_world, system_data, info, w_table, table, 
+            ecs_array_buffer(w_table->columns[0].data), first, row_count, 
+            info->frame_offset);
+
+        info->frame_offset += row_count;
+
+        if (info->interrupted_by) {
+            return info->interrupted_by;
+        }
+    }
+
+    return 0;
+}
+
+/** Record time spent by a job. A count of 0 records the time of the job run,
+ * otherwise the time spent on the rows of a table is recorded. */
+static
+void add_job_cost(
+    ecs_array_t **costs,
+    EcsColSystem *system_data,
+    uint32_t table_index,
+    float time_spent,
+    uint32_t count)
+{
+    ecs_job_cost_t *elem = ecs_array_add(costs, &job_cost_arr_params);
+    *elem = (ecs_job_cost_t){
+        .system_data = system_data,
+        .table_index = table_index,
+        .time_spent = time_spent,
+        .count = count
+    };
+}
+
+/** Add time of a run to the time spent by a system. Jobs of the same system
+ * run at the same time, so they record their time instead. */
+static
+void add_time_spent(
+    EcsColSystem *system_data,
+    ecs_array_t **costs,
+    float time_spent)
+{
+    if (costs) {
+        add_job_cost(costs, system_data, 0, time_spent, 0);
+    } else {
+        system_data->base.time_spent += time_spent;
+    }
+}
+
+/** Run a column system. The pipeline and the job scheduler store pointers to
+ * system data, so that running a system does not require an entity lookup.
+ * Jobs pass an array in which the time spent per table is recorded, which the
+ * main thread adds to the row costs once all jobs have finished. */
+ecs_entity_t ecs_col_system_run(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    float delta_time,
+    uint32_t offset,
+    uint32_t limit,
+    ecs_type_t filter,
+    void *param,
+    ecs_array_t **costs)
+{
+    ecs_world_t *real_world = world;
+
+    if (world->magic == ECS_THREAD_MAGIC) {
+        real_world = ((ecs_thread_t*)world)->world; /* dispel the magic */
+    }
+
+    if (!system_data->base.enabled) {
+        return 0;
+    }
+
+    ecs_entity_t system = system_data->entity;
+    ecs_stage_t *stage = ecs_get_stage(&real_world);
+
+    float system_delta_time = delta_time + system_data->time_passed;
+    float period = system_data->period;
+    bool measure_time = real_world->measure_system_time;
+
+    ecs_array_t *tables = system_data->tables;
+    uint32_t tables_size = system_data->table_params.element_size;
+    int32_t *table_first = ecs_array_buffer(tables);
+    int32_t *table_last = ECS_OFFSET(table_first, tables_size * ecs_array_count(tables));
+
+    if (table_first == table_last) {
+        return 0;
+    }
+
+    if (period) {
+        if (!should_run(system_data, period, delta_time)) {
+            return 0;
+        }
+    }
+
+    bool main_thread = world->magic != ECS_THREAD_MAGIC;
+
+    /* Row costs are owned by the main thread */
+    bool measure_rows = measure_time && (costs || main_thread);
+
+    /* Time sliced systems run a part of their rows, unless a range is given,
+     * which is the case for jobs of workers */
+    if (system_data->slice_frames && main_thread && !offset && !limit) {
+        if (!ecs_system_next_slice(real_world, system_data, &offset, &limit)) {
+            return 0;
+        }
+    }
+
+    ecs_time_t time_start;
+    if (measure_time) {
+        ecs_os_get_time(&time_start);
     }
 
     uint32_t column_count = ecs_array_count(system_data->base.columns);
-    uint32_t components_size = system_data->component_params.element_size;
-    char *components = ecs_array_buffer(system_data->components);
     ecs_entity_t interrupted_by = 0;
-    ecs_system_action_t action = system_data->base.action;
     bool offset_limit = (offset | limit) != 0;
     bool limit_set = limit != 0;
     void **ref_ptrs = ecs_os_alloca(void*, column_count);
@@ -940,8 +2514,38 @@ ecs_entity_t _ecs_run_w_filter(
         .ref_ptrs = ref_ptrs
     };
 
+    /* Workers run sorted systems in the order computed by the main thread when
+     * the jobs were handed out */
+    if (system_data->sort_on) {
+        if (main_thread) {
+            ecs_system_sort_tables(real_world, system_data);
+        }
+
+        interrupted_by = run_sorted(
+            real_world, stage, system_data, &info, offset, limit, filter);
+
+        if (main_thread) {
+            ecs_system_mark_changed(real_world, system_data);
+        }
+
+        if (measure_time) {
+            add_time_spent(
+                system_data, costs, ecs_time_measure(&time_start));
+        }
+
+        return interrupted_by;
+    }
+
+    uint32_t level = 0, level_count = 1;
+    if (system_data->base.cascade_by) {
+        level_count = cascade_level_count(
+            real_world, table_first, table_last, tables_size);
+    }
+
     int32_t *table = table_first;
-    for (; table < table_last; table = ECS_OFFSET(table, tables_size)) {
+    for (; table < table_last; table = next_table(
+        table, tables_size, table_first, table_last, &level, level_count)) 
+    {
         int32_t table_index = table[TABLE_INDEX];
 
         /* A system may introduce a new table if in the main thread. Make sure
@@ -951,6 +2555,12 @@ ecs_entity_t _ecs_run_w_filter(
         ecs_table_column_t *table_columns = w_table->columns;
         uint32_t first = 0, count = ecs_table_count(w_table);
 
+        if (level_count > 1 && 
+            !table_level_range(w_table, table, level, &first, &count)) 
+        {
+            continue;
+        }
+
         if (filter) {
             if (!ecs_type_contains(
                 real_world, stage, w_table->type_id, filter, true, true))
@@ -959,77 +2569,61 @@ ecs_entity_t _ecs_run_w_filter(
             }
         }
 
-        if (offset_limit) {
-            if (offset) {
-                if (offset > count) {
-                    offset -= count;
-                    continue;
-                } else {
-                    first += offset;
-                    count -= offset;
-                    offset = 0;
-                }
-            }
-
-            if (limit) {
-                if (limit > count) {
-                    limit -= count;
-                } else {
-                    count = limit;
-                    limit = 0;
-                }
-            } else if (limit_set) {
-                break;
-            }
+        if (offset_limit && !offset_limit_range(
+            &first, &count, &offset, &limit, limit_set))
+        {
+            break;
         }
 
         if (!count) {
             continue;
         }
 
-        uint32_t ref_index = table[REFS_INDEX];
+        init_table_rows(real_world, system_data, &info, w_table, table);
+        ecs_entity_t *entity_buffer = ecs_array_buffer(table_columns[0].data);
 
-        if (ref_index) {
-            info.references = ecs_array_get(
-                system_data->refs, &system_data->ref_params, ref_index - 1);
+        uint32_t frame_offset = info.frame_offset;
 
-            /* Resolve references */
-            int i, ref_count = table[REFS_COUNT];
+        ecs_time_t time_table;
+        if (measure_rows) {
+            ecs_os_get_time(&time_table);
+        }
 
-            for (i = 0; i < ref_count; i ++) {
-                ecs_entity_info_t entity_info = {0};
+        if (w_table->disabled_count) {
+            /* Table has disabled rows. Invoke action for each run of enabled
+             * rows, so systems never see disabled entities. */
+            uint32_t run_first = first, run_count, end = first + count;
 
-                ecs_reference_t ref = info.references[i];
+            while ((run_count = ecs_table_enabled_run(
+                w_table, &run_first, end)))
+            {
+                invoke_rows(real_world, system_data, &info, w_table, table, 
+                    entity_buffer, run_first, run_count, 
+                    frame_offset + run_first - first);
 
-                if (ref.entity != ECS_INVALID_ENTITY) {
-                    info.ref_ptrs[i] = get_ptr(real_world, &real_world->main_stage,
-                        info.references[i].entity, info.references[i].component, 
-                        false, true, &entity_info);
-                        
-                    ecs_assert(info.ref_ptrs[i] != NULL, 
-                        ECS_UNRESOLVED_REFERENCE, ecs_id(world, system));
-                } else {
-                    info.ref_ptrs[i] = NULL;
+                if (info.interrupted_by) {
+                    break;
                 }
+
+                run_first += run_count;
             }
         } else {
-            info.references = NULL;
+            invoke_rows(real_world, system_data, &info, w_table, table, 
+                entity_buffer, first, count, frame_offset);
         }
 
-        info.columns =  &table[COLUMNS_INDEX];
-        info.table_columns = table_columns;
-        info.components = ECS_OFFSET(components,
-            components_size * table[COMPONENTS_INDEX]);
-        info.offset = first;
-        info.count = count;
-
-        ecs_entity_t *entity_buffer = 
-                ecs_array_buffer(((ecs_table_column_t*)info.table_columns)[0].data);
-        info.entities = &entity_buffer[first];
-        
-        action(&info);
+        if (measure_rows) {
+            float time_spent = ecs_time_measure(&time_table);
+            if (costs) {
+                add_job_cost(
+                    costs, system_data, table_index, time_spent, count);
+            } else {
+                ecs_system_measure_rows(
+                    system_data, table_index, time_spent, count);
+            }
+        }
 
-        info.frame_offset += count;
+        info.frame_offset = frame_offset + count;
 
         if (info.interrupted_by) {
             interrupted_by = info.interrupted_by;
@@ -1037,13 +2631,53 @@ ecs_entity_t _ecs_run_w_filter(
         }
     }
 
+    /* Jobs of workers are registered when they are handed out */
+    if (main_thread) {
+        ecs_system_mark_changed(real_world, system_data);
+    }
+
+    /* Tables that are visited once per hierarchy level are updated once */
+    if (measure_rows && !costs) {
+        update_row_costs(system_data);
+    }
+
     if (measure_time) {
-        system_data->base.time_spent += ecs_time_measure(&time_start);
+        add_time_spent(system_data, costs, ecs_time_measure(&time_start));
     }
 
     return interrupted_by;
 }
 
+ecs_entity_t _ecs_run_w_filter(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    float delta_time,
+    uint32_t offset,
+    uint32_t limit,
+    ecs_type_t filter,
+    void *param)
+{
+    ecs_world_t *real_world = world;
+
+    if (world->magic == ECS_THREAD_MAGIC) {
+        real_world = ((ecs_thread_t*)world)->world; /* dispel the magic */
+    }
+
+    /* Tables are sorted by ecs_progress before running a phase. If the system
+     * is ran manually outside of a frame, make sure tables are sorted. Sorting
+     * can move the system itself, so this happens before the lookup. */
+    if (!real_world->in_progress) {
+        ecs_hierarchy_sort(real_world);
+    }
+
+    ecs_entity_info_t entity_info = {0};
+    EcsColSystem *system_data = get_ptr(real_world, &real_world->main_stage, system, EEcsColSystem, false, false, &entity_info);
+    assert(system_data != NULL);
+
+    return ecs_col_system_run(
+        world, system_data, delta_time, offset, limit, filter, param, NULL);
+}
+
 ecs_entity_t ecs_run(
     ecs_world_t *world,
     ecs_entity_t system,
@@ -1052,3 +2686,271 @@ ecs_entity_t ecs_run(
 {
     return ecs_run_w_filter(world, system, delta_time, 0, 0, 0, param);
 }
+
+ecs_query_t* ecs_query_new(
+    ecs_world_t *world,
+    const char *sig)
+{
+    ecs_assert(world != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(world->magic == ECS_WORLD_MAGIC, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(sig != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    ecs_query_t *result = ecs_os_malloc(sizeof(ecs_query_t));
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    result->world = world;
+    init_system_data(world, &result->system, 0, EcsManual, sig, NULL);
+
+    /* A query has no entity to resolve SYSTEM columns from */
+    ecs_assert(!result->system.base.and_from_system, 
+        ECS_INVALID_COMPONENT_EXPRESSION, sig);
+
+    uint32_t column_count = ecs_array_count(result->system.base.columns);
+    result->ref_ptrs = ecs_os_malloc(sizeof(void*) * column_count);
+    result->references = ecs_os_malloc(sizeof(ecs_reference_t) * column_count);
+    ecs_assert(result->ref_ptrs != NULL, ECS_OUT_OF_MEMORY, NULL);
+    ecs_assert(result->references != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    match_tables(world, 0, &result->system);
+
+    ecs_query_t **elem = ecs_array_add(&world->queries, &ptr_arr_params);
+    *elem = result;
+
+    return result;
+}
+
+void ecs_query_free(
+    ecs_query_t *query)
+{
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    ecs_world_t *world = query->world;
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    ecs_query_t **buffer = ecs_array_buffer(world->queries);
+    uint32_t i, count = ecs_array_count(world->queries);
+
+    for (i = 0; i < count; i ++) {
+        if (buffer[i] == query) {
+            ecs_array_remove_index(world->queries, &ptr_arr_params, i);
+            break;
+        }
+    }
+
+    ecs_assert(i != count, ECS_INVALID_PARAMETERS, NULL);
+
+    if (query->system.sort_on) {
+        ecs_world_update_sorted_tables(world);
+    }
+
+    EcsColSystem *system_data = &query->system;
+    ecs_array_free(system_data->base.columns);
+    ecs_array_free(system_data->components);
+    ecs_array_free(system_data->inactive_tables);
+    ecs_array_free(system_data->jobs);
+    ecs_array_free(system_data->level_rows);
+    ecs_array_free(system_data->row_costs);
+    ecs_array_free(system_data->tables);
+    ecs_array_free(system_data->refs);
+    ecs_array_free(system_data->sorted_slices);
+
+    ecs_os_free(query->ref_ptrs);
+    ecs_os_free(query->references);
+    ecs_os_free(query);
+}
+
+void _ecs_query_order_by(
+    ecs_query_t *query,
+    ecs_entity_t component,
+    ecs_compare_action_t compare)
+{
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!component || compare != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(!query->system.base.cascade_by, ECS_INVALID_PARAMETERS, NULL);
+
+    bool was_sorted = query->system.sort_on != 0;
+
+    query->system.sort_on = component;
+    query->system.compare = compare;
+    query->system.valid_order = false;
+
+    /* Tables that are no longer sorted by any system can be defragmented */
+    if (was_sorted && !component) {
+        ecs_world_update_sorted_tables(query->world);
+    }
+}
+
+ecs_query_iter_t ecs_query_iter(
+    ecs_query_t *query)
+{
+    ecs_assert(query != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    ecs_world_t *world = query->world;
+
+    /* Tables are sorted by ecs_progress before running a phase. If the query is
+     * iterated outside of a frame, make sure tables are sorted. In progress,
+     * systems on worker threads may iterate the query, so the world is left
+     * as is, and the order of the last sort is used if it is still valid. */
+    if (!world->in_progress) {
+        ecs_hierarchy_sort(world);
+        ecs_system_sort_tables(world, &query->system);
+
+        /* The application may write to the columns of the query */
+        ecs_system_mark_changed(world, &query->system);
+    }
+
+    bool sorted = query->system.sort_on && 
+        valid_sort_order(world, &query->system);
+
+    return (ecs_query_iter_t){
+        .query = query,
+        .sorted = sorted,
+        .rows = {
+            .world = world,
+            .column_count = ecs_array_count(query->system.base.columns),
+            .ref_ptrs = query->ref_ptrs
+        }
+    };
+}
+
+/** Move iterator to the next table, or to the next slice of a sorted query */
+static
+bool query_next_range(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    ecs_query_iter_t *it)
+{
+    if (it->sorted) {
+        if (it->table >= ecs_array_count(system_data->sorted_slices)) {
+            return false;
+        }
+
+        ecs_sorted_slice_t *slice = ecs_array_get(
+            system_data->sorted_slices, &slice_arr_params, it->table ++);
+        it->row = slice->offset;
+        it->end = slice->offset + slice->count;
+    } else {
+        if (it->table >= ecs_array_count(system_data->tables)) {
+            return false;
+        }
+
+        int32_t *table = ecs_array_get(
+            system_data->tables, &system_data->table_params, it->table ++);
+        ecs_table_t *w_table = ecs_array_get(
+            world->main_stage.tables, &table_arr_params, table[TABLE_INDEX]);
+        it->row = 0;
+        it->end = ecs_table_count(w_table);
+    }
+
+    return true;
+}
+
+/** Get the matched table of the current range of the iterator */
+static
+int32_t* query_table(
+    EcsColSystem *system_data,
+    ecs_query_iter_t *it)
+{
+    uint32_t index = it->table - 1;
+
+    if (it->sorted) {
+        ecs_sorted_slice_t *slice = ecs_array_get(
+            system_data->sorted_slices, &slice_arr_params, index);
+        index = slice->table;
+    }
+
+    return ecs_array_get(
+        system_data->tables, &system_data->table_params, index);
+}
+
+bool ecs_query_next(
+    ecs_query_iter_t *it)
+{
+    ecs_assert(it != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    ecs_query_t *query = it->query;
+    ecs_world_t *world = query->world;
+    EcsColSystem *system_data = &query->system;
+    ecs_rows_t *rows = &it->rows;
+
+    /* Rows of the previous result count towards the frame offset */
+    rows->frame_offset += rows->count;
+    rows->count = 0;
+
+    while (true) {
+        bool new_range = false;
+
+        if (it->row >= it->end) {
+            if (!query_next_range(world, system_data, it)) {
+                return false;
+            }
+
+            /* Empty tables stay matched with a query, skip them here */
+            if (it->row >= it->end) {
+                continue;
+            }
+
+            new_range = true;
+        }
+
+        int32_t *table = query_table(system_data, it);
+        ecs_table_t *w_table = ecs_array_get(
+            world->main_stage.tables, &table_arr_params, table[TABLE_INDEX]);
+
+        if (new_range) {
+            init_table_rows(world, system_data, rows, w_table, table);
+        }
+
+        uint32_t first = it->row, count = it->end - first;
+
+        /* Never yield disabled entities */
+        if (w_table->disabled_count) {
+            count = ecs_table_enabled_run(w_table, &first, it->end);
+            if (!count) {
+                it->row = it->end;
+                continue;
+            }
+        }
+
+        it->row = first + count;
+
+        /* If the table stores parents in a column, yield runs of rows that
+         * share the same parent, with the container references of the run */
+        int16_t parent_column = w_table->parent_column;
+        if (parent_column && table[REFS_INDEX]) {
+            ecs_reference_t *references = ecs_array_get(system_data->refs, 
+                &system_data->ref_params, table[REFS_INDEX] - 1);
+            EcsParent *parents = ecs_array_buffer(
+                w_table->columns[parent_column].data);
+            ecs_entity_t parent = parents[first].entity;
+            uint32_t end = first + count;
+
+            count = 1;
+            while (first + count < end && 
+                parents[first + count].entity == parent) 
+            {
+                count ++;
+            }
+
+            it->row = first + count;
+
+            memcpy(query->references, references, 
+                sizeof(ecs_reference_t) * table[REFS_COUNT]);
+            rows->references = query->references;
+
+            if (!resolve_parent_refs(world, system_data, rows, table, 
+                references, parent)) 
+            {
+                continue;
+            }
+        }
+
+        ecs_entity_t *entity_buffer = ecs_array_buffer(w_table->columns[0].data);
+        rows->offset = first;
+        rows->count = count;
+        rows->entities = &entity_buffer[first];
+
+        return true;
+    }
+}
@@ -1,4 +1,5 @@
 #include "include/private/flecs.h"
+#include "include/util/time.h"
 #include <assert.h>
 #include <math.h>
 
@@ -10,12 +11,78 @@ const ecs_array_params_t job_arr_params = {
     .element_size = sizeof(ecs_job_t)
 };
 
+const ecs_array_params_t job_cost_arr_params = {
+    .element_size = sizeof(ecs_job_cost_t)
+};
+
+/** Run a job. Jobs either run a task or a range of rows of a column system */
+static
+void run_job(
+    ecs_world_t *world,
+    ecs_thread_t *thread,
+    ecs_job_t *job,
+    float delta_time,
+    void *param)
+{
+    if (job->is_task) {
+        ecs_run_task(world, job->system, job->task_data);
+    } else {
+        ecs_col_system_run(world, job->system_data, delta_time, job->offset, 
+            job->limit, 0, param, &thread->costs);
+    }
+}
+
+/** Run the jobs assigned to a thread. Thread 0 has no stage, its jobs are ran
+ * with the world so that changes are written to the stage of the main thread */
+static
+void run_thread_jobs(
+    ecs_world_t *world,
+    ecs_thread_t *thread)
+{
+    ecs_world_t *job_world = thread->stage 
+        ? (ecs_world_t*)thread /* magic */ 
+        : world;
+    ecs_job_t **jobs = thread->jobs;
+    uint32_t i, job_count = thread->job_count;
+    bool measure_time = world->measure_system_time;
+
+    ecs_time_t time_start;
+    if (measure_time) {
+        ecs_os_get_time(&time_start);
+    }
+
+    for (i = 0; i < job_count; i ++) {
+        run_job(job_world, thread, jobs[i], world->job_delta_time, 
+            world->job_param);
+    }
+
+    if (measure_time) {
+        thread->time_spent = ecs_time_measure(&time_start);
+    }
+
+    thread->job_count = 0;
+}
+
+/** Number of threads that signal when they have finished their jobs. With the
+ * builtin worker threads, the jobs of thread 0 run on the calling thread. */
+static
+uint32_t jobs_expected(
+    ecs_world_t *world)
+{
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+    if (world->scheduler.submit) {
+        return thread_count;
+    } else {
+        return thread_count - 1;
+    }
+}
+
 /** Worker thread code. Processes a job for one system */
 static
 void* ecs_worker(void *arg) {
     ecs_thread_t *thread = arg;
     ecs_world_t *world = thread->world;
-    uint32_t i;
+    uint32_t index = thread->index;
 
     ecs_os_mutex_lock(world->thread_mutex);
     world->threads_running ++;
@@ -26,27 +93,23 @@ void* ecs_worker(void *arg) {
             break;
         }
 
-        ecs_job_t **jobs = thread->jobs;
-        uint32_t job_count = thread->job_count;
+        /* Parked threads are not scheduled. The thread array may have been
+         * reallocated while the pool grew, so look up the thread each time. */
+        if (index >= ecs_array_count(world->worker_threads)) {
+            continue;
+        }
+
+        thread = ecs_array_get(world->worker_threads, &thread_arr_params, index);
+
         ecs_os_mutex_unlock(world->thread_mutex);
 
-        for (i = 0; i < job_count; i ++) {
-            ecs_run_w_filter(
-                (ecs_world_t*)thread, /* magic */
-                jobs[i]->system, 
-                world->delta_time, 
-                jobs[i]->offset, 
-                jobs[i]->limit, 
-                0, 
-                NULL);
-        }
+        run_thread_jobs(world, thread);
 
         ecs_os_mutex_lock(world->thread_mutex);
-        thread->job_count = 0;
 
         ecs_os_mutex_lock(world->job_mutex);
         world->jobs_finished ++;
-        if (world->jobs_finished == world->threads_running) {
+        if (world->jobs_finished == jobs_expected(world)) {
             ecs_os_cond_signal(world->job_cond);
         }
         ecs_os_mutex_unlock(world->job_mutex);
@@ -62,7 +125,7 @@ static
 void wait_for_threads(
     ecs_world_t *world)
 {
-    uint32_t thread_count = ecs_array_count(world->worker_threads) - 1;
+    uint32_t thread_count = world->threads_created - 1;
     bool wait = true;
 
     do {
@@ -79,108 +142,286 @@ static
 void wait_for_jobs(
     ecs_world_t *world)
 {
-    uint32_t thread_count = ecs_array_count(world->worker_threads) - 1;
+    if (world->scheduler.wait) {
+        world->scheduler.wait(world, world->scheduler.ctx);
+        return;
+    }
+
+    uint32_t expected = jobs_expected(world);
 
     ecs_os_mutex_lock(world->job_mutex);
-    if (world->jobs_finished != thread_count) {
+    if (world->jobs_finished != expected) {
         do {
             ecs_os_cond_wait(world->job_cond, world->job_mutex);
-        } while (world->jobs_finished != thread_count);
+        } while (world->jobs_finished != expected);
     }
     ecs_os_mutex_unlock(world->job_mutex);
 }
 
-/** Stop worker threads */
+/** Add the time that jobs spent per table to the row costs of the systems, and
+ * the time of job runs to the time spent by the systems. This runs after all
+ * jobs have finished, so that systems are only written by the main thread, and
+ * the cost of a table of which the rows were split over jobs is updated once */
+static
+void update_job_costs(
+    ecs_world_t *world)
+{
+    ecs_thread_t *threads = ecs_array_buffer(world->worker_threads);
+    uint32_t i, thread_count = ecs_array_count(world->worker_threads);
+
+    for (i = 0; i < thread_count; i ++) {
+        ecs_job_cost_t *costs = ecs_array_buffer(threads[i].costs);
+        uint32_t c, count = ecs_array_count(threads[i].costs);
+
+        for (c = 0; c < count; c ++) {
+            EcsColSystem *system_data = costs[c].system_data;
+            if (costs[c].count) {
+                ecs_system_measure_rows(system_data, costs[c].table_index, 
+                    costs[c].time_spent, costs[c].count);
+            } else {
+                system_data->base.time_spent += costs[c].time_spent;
+            }
+        }
+    }
+
+    for (i = 0; i < thread_count; i ++) {
+        ecs_job_cost_t *costs = ecs_array_buffer(threads[i].costs);
+        uint32_t c, count = ecs_array_count(threads[i].costs);
+
+        for (c = 0; c < count; c ++) {
+            if (costs[c].count) {
+                ecs_system_update_row_cost(
+                    costs[c].system_data, costs[c].table_index);
+            }
+        }
+
+        if (count) {
+            ecs_array_clear(threads[i].costs);
+        }
+    }
+}
+
+/** Start running the jobs assigned to the threads. The builtin worker threads
+ * are signalled, after which the jobs of thread 0 are ran on the calling
+ * thread. An external scheduler receives all threads. */
+static
+void submit_jobs(
+    ecs_world_t *world)
+{
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+
+    if (world->scheduler.submit) {
+        /* Jobs of the scheduler report back under the job mutex */
+        ecs_os_mutex_lock(world->job_mutex);
+        world->jobs_finished = 0;
+        ecs_os_mutex_unlock(world->job_mutex);
+
+        world->scheduler.submit(world, thread_count, world->scheduler.ctx);
+    } else {
+        /* Make sure threads are ready to accept jobs */
+        wait_for_threads(world);
+
+        ecs_os_mutex_lock(world->thread_mutex);
+        world->jobs_finished = 0;
+        ecs_os_cond_broadcast(world->thread_cond);
+        ecs_os_mutex_unlock(world->thread_mutex);
+
+        run_thread_jobs(world, ecs_array_buffer(world->worker_threads));
+    }
+}
+
+/** Create thread administration and stages for threads. Existing threads keep
+ * their data, but as the arrays may be reallocated, stage pointers of all
+ * threads are updated. */
 static
+void add_threads(
+    ecs_world_t *world,
+    uint32_t threads)
+{
+    uint32_t i, created = world->threads_created;
+
+    if (!created) {
+        world->worker_threads = ecs_array_new(&thread_arr_params, threads);
+        world->worker_stages = ecs_array_new(&stage_arr_params, threads - 1);
+        world->job_cond = ecs_os_cond_new();
+        world->job_mutex = ecs_os_mutex_new();
+    }
+
+    ecs_array_set_count(&world->worker_threads, &thread_arr_params, threads);
+    ecs_array_set_count(&world->worker_stages, &stage_arr_params, threads - 1);
+
+    ecs_thread_t *buffer = ecs_array_buffer(world->worker_threads);
+    ecs_stage_t *stages = ecs_array_buffer(world->worker_stages);
+
+    for (i = 0; i < threads; i ++) {
+        ecs_thread_t *thread = &buffer[i];
+
+        if (i >= created) {
+            thread->magic = ECS_THREAD_MAGIC;
+            thread->world = world;
+            thread->index = i;
+            thread->thread = 0;
+            thread->job_count = 0;
+            thread->time_spent = 0;
+            thread->costs = NULL;
+
+            if (i != 0) {
+                ecs_stage_init(world, &stages[i - 1]);
+            }
+        }
+
+        thread->stage = i ? &stages[i - 1] : NULL;
+    }
+
+    world->threads_created = threads;
+}
+
+/** Stop worker threads, or detach from the external scheduler */
 void ecs_stop_threads(
     ecs_world_t *world)
 {
-    ecs_os_mutex_lock(world->thread_mutex);
-    world->quit_workers = true;
-    ecs_os_cond_broadcast(world->thread_cond);
-    ecs_os_mutex_unlock(world->thread_mutex);
+    ecs_wait_for_async(world);
+
+    /* Parked threads are stored after the active threads */
+    uint32_t i, count = world->threads_created;
+    ecs_array_set_count(&world->worker_threads, &thread_arr_params, count);
+    ecs_array_set_count(&world->worker_stages, &stage_arr_params, count - 1);
 
     ecs_thread_t *buffer = ecs_array_buffer(world->worker_threads);
-    uint32_t i, count = ecs_array_count(world->worker_threads);
-    for (i = 1; i < count; i ++) {
-        ecs_os_thread_join(buffer[i].thread);
-        ecs_stage_deinit(world, buffer[i].stage);
+
+    if (!world->scheduler.submit) {
+        ecs_os_mutex_lock(world->thread_mutex);
+        world->quit_workers = true;
+        ecs_os_cond_broadcast(world->thread_cond);
+        ecs_os_mutex_unlock(world->thread_mutex);
+
+        for (i = 1; i < count; i ++) {
+            ecs_os_thread_join(buffer[i].thread);
+        }
+
+        ecs_os_cond_free(world->thread_cond);
+        ecs_os_mutex_free(world->thread_mutex);
     }
 
+    for (i = 0; i < count; i ++) {
+        if (i) {
+            ecs_stage_deinit(world, buffer[i].stage);
+        }
+
+        ecs_array_free(buffer[i].costs);
+    }
+
+    ecs_os_cond_free(world->job_cond);
+    ecs_os_mutex_free(world->job_mutex);
+
     ecs_array_free(world->worker_threads);
     ecs_array_free(world->worker_stages);
     world->worker_stages = NULL;
     world->worker_threads = NULL;
     world->quit_workers = false;
     world->threads_running = 0;
+    world->threads_created = 0;
+    world->scheduler = (ecs_scheduler_t){0};
+    world->valid_schedule = false;
 }
 
-/** Start worker threads, wait until they are running */
+/** Grow the pool of worker threads, wait until new threads are running */
+static
 void start_threads(
     ecs_world_t *world,
     uint32_t threads)
 {
-    ecs_assert(world->worker_threads == NULL, ECS_INTERNAL_ERROR, NULL);
+    uint32_t i, created = world->threads_created;
 
-    world->worker_threads = ecs_array_new(&thread_arr_params, threads);
-    world->worker_stages = ecs_array_new(&stage_arr_params, threads - 1);
+    if (!created) {
+        world->thread_cond = ecs_os_cond_new();
+        world->thread_mutex = ecs_os_mutex_new();
+        created = 1; /* Thread 0 is the main thread */
+    }
 
-    uint32_t i;
-    for (i = 0; i < threads; i ++) {
-        ecs_thread_t *thread =
-            ecs_array_add(&world->worker_threads, &thread_arr_params);
-
-        thread->magic = ECS_THREAD_MAGIC;
-        thread->world = world;
-        thread->thread = 0;
-        thread->job_count = 0;
-
-        if (i != 0) {
-            thread->stage = ecs_array_add(&world->worker_stages, &stage_arr_params);
-            ecs_stage_init(world, thread->stage);
-            thread->thread = ecs_os_thread_new(ecs_worker, thread);
-            if (!thread->thread) {
-                ecs_abort(ECS_THREAD_ERROR, NULL);
-            }
-        } else {
-            thread->stage = NULL;
+    /* Workers are parked while the pool grows, so they don't access the
+     * thread array while it is reallocated */
+    add_threads(world, threads);
+
+    ecs_thread_t *buffer = ecs_array_buffer(world->worker_threads);
+
+    for (i = created; i < threads; i ++) {
+        ecs_thread_t *thread = &buffer[i];
+        thread->thread = ecs_os_thread_new(ecs_worker, thread);
+        if (!thread->thread) {
+            ecs_abort(ECS_THREAD_ERROR, NULL);
         }
+
+        /* Let the OS API pin the worker to a core, if it sets the hook */
+        ecs_os_thread_affinity(thread->thread, i);
     }
+
+    /* New threads must have read their thread data before the array can be
+     * reallocated again */
+    wait_for_threads(world);
 }
 
-/** Create jobs for system */
+/** Change the number of threads that receive jobs. Threads that are no longer
+ * used are parked: they keep waiting for work, and keep their stage, so they
+ * can be used again without creating a new thread. */
 static
-void create_jobs(
-    EcsColSystem *system_data,
-    uint32_t thread_count)
+void resize_threads(
+    ecs_world_t *world,
+    uint32_t threads)
 {
-    if (system_data->jobs) {
-        ecs_array_free(system_data->jobs);
-    }
+    uint32_t i, count = ecs_array_count(world->worker_threads);
 
-    system_data->jobs = ecs_array_new(&job_arr_params, thread_count);
+    if (threads > world->threads_created) {
+        start_threads(world, threads);
+    }
 
-    uint32_t i;
-    for (i = 0; i < thread_count; i ++) {
-        ecs_array_add(&system_data->jobs, &job_arr_params);
+    /* Changes staged by threads that are parked must not wait until the
+     * threads are used again */
+    if (count && threads < count) {
+        ecs_stage_t *stages = ecs_array_buffer(world->worker_stages);
+        for (i = threads ? threads - 1 : 0; i < count - 1; i ++) {
+            ecs_stage_merge(world, &stages[i]);
+        }
     }
+
+    ecs_array_set_count(&world->worker_threads, &thread_arr_params, threads);
+    ecs_array_set_count(
+        &world->worker_stages, &stage_arr_params, threads ? threads - 1 : 0);
 }
 
+/** Add time spent by threads on the last run of jobs to phase statistics */
+static
+void record_phase_time(
+    ecs_world_t *world,
+    ecs_phase_time_t *phase_time)
+{
+    ecs_thread_t *buffer = ecs_array_buffer(world->worker_threads);
+    uint32_t i, count = ecs_array_count(world->worker_threads);
+    float max = 0;
+
+    for (i = 0; i < count; i ++) {
+        float time_spent = buffer[i].time_spent;
+        if (time_spent > max) {
+            max = time_spent;
+        }
 
-/* -- Private functions -- */
+        phase_time->total += time_spent;
+        buffer[i].time_spent = 0;
+    }
 
-/** Create a job per available thread for system */
-void ecs_schedule_jobs(
+    phase_time->max += max;
+}
+
+/** Count rows in the tables of a system */
+static
+uint32_t count_rows(
     ecs_world_t *world,
-    ecs_entity_t system)
+    EcsColSystem *system_data)
 {
-    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
-    uint32_t thread_count = ecs_array_count(world->worker_threads);
-    uint32_t total_rows = 0;
-
     void *ptr = ecs_array_buffer(system_data->tables);
     uint32_t i, count = ecs_array_count(system_data->tables);
     size_t size = system_data->table_params.element_size;
+    uint32_t total_rows = 0;
 
     for (i = 0; i < count; i ++, ptr = ECS_OFFSET(ptr, size)) {
         uint32_t table_index = *(uint32_t*)ptr;
@@ -189,23 +430,59 @@ void ecs_schedule_jobs(
         total_rows += ecs_array_count(table->columns[0].data);
     }
 
+    return total_rows;
+}
+
+/** Create jobs for system */
+static
+void create_jobs(
+    ecs_array_t **jobs,
+    uint32_t thread_count)
+{
+    if (*jobs) {
+        ecs_array_free(*jobs);
+    }
+
+    *jobs = ecs_array_new(&job_arr_params, thread_count);
+
+    uint32_t i;
+    for (i = 0; i < thread_count; i ++) {
+        ecs_array_add(jobs, &job_arr_params);
+    }
+}
+
+
+/** Split a range of rows of a system evenly over the worker threads. If the
+ * range is open, the last job runs until the last row of the system, so that
+ * the jobs include rows that are added after scheduling. */
+static
+void schedule_range(
+    EcsColSystem *system_data,
+    ecs_array_t **jobs,
+    uint32_t thread_count,
+    uint32_t offset,
+    uint32_t total_rows,
+    bool open)
+{
+    uint32_t i;
+
     if (total_rows < thread_count) {
         thread_count = total_rows;
     }
 
-    if (ecs_array_count(system_data->jobs) != thread_count) {
-        create_jobs(system_data, thread_count);
+    if (ecs_array_count(*jobs) != thread_count) {
+        create_jobs(jobs, thread_count);
     }
 
     float rows_per_thread = (float)total_rows / (float)thread_count;
     float residual = 0;
     int32_t rows_per_thread_i = rows_per_thread;
 
-    uint32_t start_index = 0;
+    uint32_t start_index = offset;
 
     ecs_job_t *job = NULL;
     for (i = 0; i < thread_count; i ++) {
-        job = ecs_array_get(system_data->jobs, &job_arr_params, i);
+        job = ecs_array_get(*jobs, &job_arr_params, i);
         int32_t rows_per_job = rows_per_thread_i;
         residual += rows_per_thread - rows_per_job;
         if (residual > 1) {
@@ -213,35 +490,216 @@ void ecs_schedule_jobs(
             residual --;
         }
 
-        job->system = system;
+        job->system = system_data->entity;
         job->system_data = system_data;
         job->offset = start_index;
         job->limit = rows_per_job;
+        job->is_task = false;
 
         start_index += rows_per_job;
     }
 
-    if (residual >= 0.9) {
+    if (open && job) {
+        job->limit = 0;
+    } else if (residual >= 0.9) {
         job->limit ++;
     }
 }
 
-/** Assign jobs to worker threads, signal workers */
+
+/** Split the rows of a system over the worker threads so that each thread gets
+ * the same estimated amount of work. Tables for which no cost was measured yet
+ * are assumed to have the average cost of the measured tables. Returns false if
+ * no costs are known, in which case rows should be split evenly. */
+static
+bool schedule_by_cost(
+    ecs_world_t *world,
+    EcsColSystem *system_data,
+    uint32_t thread_count,
+    uint32_t total_rows)
+{
+    void *first = ecs_array_buffer(system_data->tables);
+    uint32_t i, count = ecs_array_count(system_data->tables);
+    size_t size = system_data->table_params.element_size;
+    float measured_cost = 0, total_cost = 0;
+    uint32_t measured_rows = 0;
+    void *ptr;
+
+    for (i = 0, ptr = first; i < count; i ++, ptr = ECS_OFFSET(ptr, size)) {
+        float cost = ecs_system_row_cost(system_data, *(uint32_t*)ptr);
+        if (cost) {
+            ecs_table_t *table = ecs_array_get(
+                world->main_stage.tables, &table_arr_params, *(uint32_t*)ptr);
+            uint32_t rows = ecs_table_count(table);
+            measured_cost += cost * rows;
+            measured_rows += rows;
+        }
+    }
+
+    if (!measured_rows || !measured_cost) {
+        return false;
+    }
+
+    float default_cost = measured_cost / measured_rows;
+    total_cost = measured_cost + default_cost * (total_rows - measured_rows);
+
+    if (total_rows < thread_count) {
+        thread_count = total_rows;
+    }
+
+    /* Find the row at which each job ends. Each job gets at least one row, as
+     * a limit of 0 would make a job run until the last row. */
+    uint32_t *job_end = ecs_os_alloca(uint32_t, thread_count);
+    float cost_per_job = total_cost / thread_count;
+    float job_cost = 0;
+    uint32_t job = 0, row = 0;
+
+    for (i = 0, ptr = first; i < count; i ++, ptr = ECS_OFFSET(ptr, size)) {
+        ecs_table_t *table = ecs_array_get(
+            world->main_stage.tables, &table_arr_params, *(uint32_t*)ptr);
+        uint32_t rows = ecs_table_count(table);
+        float cost = ecs_system_row_cost(system_data, *(uint32_t*)ptr);
+        if (!cost) {
+            cost = default_cost;
+        }
+
+        while (rows && job < thread_count - 1) {
+            float remaining = cost_per_job - job_cost;
+            uint32_t job_rows = 0;
+            if (remaining > 0) {
+                job_rows = remaining / cost + 0.5f;
+            }
+
+            if (!job_rows && !job_cost) {
+                job_rows = 1;
+            }
+
+            if (job_rows >= rows) {
+                job_cost += rows * cost;
+                row += rows;
+                rows = 0;
+            } else {
+                row += job_rows;
+                rows -= job_rows;
+                job_end[job ++] = row;
+                job_cost = 0;
+            }
+        }
+
+        row += rows;
+    }
+
+    thread_count = job + 1;
+
+    if (ecs_array_count(system_data->jobs) != thread_count) {
+        create_jobs(&system_data->jobs, thread_count);
+    }
+
+    uint32_t start_index = 0;
+    for (i = 0; i < thread_count; i ++) {
+        ecs_job_t *job_ptr = ecs_array_get(
+            system_data->jobs, &job_arr_params, i);
+        job_ptr->system = system_data->entity;
+        job_ptr->system_data = system_data;
+        job_ptr->offset = start_index;
+        job_ptr->is_task = false;
+
+        /* Last job runs until the last row */
+        if (i == thread_count - 1) {
+            job_ptr->limit = 0;
+        } else {
+            job_ptr->limit = job_end[i] - start_index;
+            start_index = job_end[i];
+        }
+    }
+
+    return true;
+}
+
+
+/* -- Private functions -- */
+
+/** Create a job per available thread for system. Jobs always cover all rows
+ * of the system, as the last job runs until the last row. Adding or removing
+ * rows therefore only affects how evenly rows are distributed over the jobs.
+ * Jobs are kept until the rows added or removed since they were created could
+ * have changed the size of a job by more than ECS_SCHEDULE_TOLERANCE, or until
+ * the tables of the system change.
+ *
+ * When system time is measured, rows are split by their measured cost instead.
+ * As the cost estimates change over time, these jobs are recreated every
+ * ECS_COST_SCHEDULE_INTERVAL frames. */
+void ecs_schedule_jobs(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+    uint32_t total_rows;
+    bool measure_time = world->measure_system_time;
+
+    /* The slice of a time sliced system moves every frame, so its jobs are
+     * not kept */
+    if (system_data->slice_frames) {
+        uint32_t offset, limit;
+        if (ecs_system_next_slice(world, system_data, &offset, &limit)) {
+            schedule_range(system_data, &system_data->jobs, thread_count, 
+                offset, limit, false);
+        } else {
+            create_jobs(&system_data->jobs, 0);
+        }
+
+        system_data->valid_schedule = false;
+        return;
+    }
+
+    if (world->valid_schedule && system_data->valid_schedule) {
+        uint32_t changes = world->row_changes - system_data->schedule_changes;
+        uint32_t frames = world->frame_count - system_data->schedule_frame;
+
+        if (changes <= system_data->schedule_rows * ECS_SCHEDULE_TOLERANCE &&
+            (!measure_time || frames < ECS_COST_SCHEDULE_INTERVAL))
+        {
+            return;
+        }
+    }
+
+    total_rows = count_rows(world, system_data);
+
+    if (!measure_time || !total_rows || !schedule_by_cost(
+        world, system_data, thread_count, total_rows))
+    {
+        schedule_range(
+            system_data, &system_data->jobs, thread_count, 0, total_rows, true);
+    }
+
+    system_data->schedule_changes = world->row_changes;
+    system_data->schedule_rows = total_rows / thread_count;
+    system_data->schedule_frame = world->frame_count;
+    system_data->valid_schedule = true;
+}
+
+/** Assign jobs to worker threads, signal workers. Jobs are kept for multiple
+ * frames, during which the system data may have moved, so the pointer to the
+ * system data is updated before the jobs are handed out. Workers can't update
+ * the tables, so the columns the jobs access are registered as changed here. */
 void ecs_prepare_jobs(
     ecs_world_t *world,
-    ecs_entity_t system)
+    EcsColSystem *system_data)
 {
-    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
     ecs_array_t *threads = world->worker_threads;
     ecs_array_t *jobs = system_data->jobs;
     uint32_t i;
 
+    ecs_system_mark_changed(world, system_data);
+
     uint32_t thread_count = ecs_array_count(jobs);
 
     for (i = 0; i < thread_count; i++) {
         ecs_thread_t *thr = ecs_array_get(threads, &thread_arr_params, i);
+        ecs_job_t *job = ecs_array_get(jobs, &job_arr_params, i);
         uint32_t job_count = thr->job_count;
-        thr->jobs[job_count] = ecs_array_get(jobs, &job_arr_params, i);
+        job->system_data = system_data;
+        thr->jobs[job_count] = job;
         thr->job_count = job_count + 1;
     }
 }
@@ -249,27 +707,138 @@ void ecs_prepare_jobs(
 void ecs_run_jobs(
     ecs_world_t *world)
 {
-    /* Make sure threads are ready to accept jobs */
-    wait_for_threads(world);
+    /* Workers can only run one set of jobs at a time */
+    ecs_wait_for_async(world);
 
-    ecs_os_mutex_lock(world->thread_mutex);
-    world->jobs_finished = 0;
-    ecs_os_cond_broadcast(world->thread_cond);
-    ecs_os_mutex_unlock(world->thread_mutex);
+    world->job_delta_time = world->delta_time;
+    world->job_param = NULL;
 
-    /* Run job for thread 0 in main thread */
-    ecs_thread_t *thread = ecs_array_buffer(world->worker_threads);
-    ecs_job_t **jobs = thread->jobs;
-    uint32_t i, job_count = thread->job_count;
+    submit_jobs(world);
+    wait_for_jobs(world);
+    update_job_costs(world);
+
+    if (world->measure_system_time && world->phase_time) {
+        record_phase_time(world, world->phase_time);
+    }
+}
+
+/** Run a system with a CASCADE column level by level. The rows of a level are
+ * split over the worker threads, and all workers must have finished a level
+ * before the next level starts, so that parents are always processed before
+ * their children. Jobs are rescheduled every frame, as the number of rows per
+ * level is not tracked by the regular schedule. */
+void ecs_run_cascade_jobs(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+    uint32_t level, level_count = ecs_system_level_rows(
+        world, system_data, &system_data->level_rows);
+    uint32_t *level_rows = ecs_array_buffer(system_data->level_rows);
+    uint32_t offset = 0;
+
+    for (level = 0; level < level_count; level ++) {
+        uint32_t rows = level_rows[level];
+        if (!rows) {
+            continue;
+        }
+
+        schedule_range(system_data, &system_data->jobs, thread_count, offset, 
+            rows, false);
+        ecs_prepare_jobs(world, system_data);
+        ecs_run_jobs(world);
+
+        offset += rows;
+    }
+}
+
+/** Test if a task conflicts with one of the tasks scheduled on workers */
+static
+bool task_conflicts(
+    ecs_world_t *world,
+    EcsRowSystem *task_data)
+{
+    ecs_entity_t *conflicts = ecs_array_buffer(task_data->conflicts);
+    uint32_t c, conflict_count = ecs_array_count(task_data->conflicts);
+
+    ecs_job_t *jobs = ecs_array_buffer(world->task_jobs);
+    uint32_t i, job_count = ecs_array_count(world->task_jobs);
+
+    for (c = 0; c < conflict_count; c ++) {
+        for (i = 0; i < job_count; i ++) {
+            if (jobs[i].system == conflicts[c]) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/** Add a task to the tasks that run concurrently on the worker threads. If the
+ * task conflicts with a scheduled task, or if the workers have no room for more
+ * jobs, the scheduled tasks are ran first. */
+void ecs_schedule_task(
+    ecs_world_t *world,
+    ecs_entity_t task,
+    EcsRowSystem *task_data)
+{
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+    uint32_t job_count = ecs_array_count(world->task_jobs);
+
+    if (job_count == thread_count * ECS_MAX_JOBS_PER_WORKER ||
+        task_conflicts(world, task_data))
+    {
+        ecs_run_task_jobs(world);
+    }
+
+    ecs_job_t *job = ecs_array_add(&world->task_jobs, &job_arr_params);
+    *job = (ecs_job_t){
+        .system = task,
+        .task_data = task_data,
+        .is_task = true
+    };
+}
+
+/** Run the scheduled tasks, distributed round robin over the worker threads.
+ * Jobs are only assigned to threads here, as adding to the task_jobs array may
+ * reallocate it. */
+void ecs_run_task_jobs(
+    ecs_world_t *world)
+{
+    uint32_t i, job_count = ecs_array_count(world->task_jobs);
+    if (!job_count) {
+        return;
+    }
+
+    ecs_thread_t *threads = ecs_array_buffer(world->worker_threads);
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+    ecs_job_t *jobs = ecs_array_buffer(world->task_jobs);
 
     for (i = 0; i < job_count; i ++) {
-        ecs_run_w_filter(
-            world, jobs[i]->system, world->delta_time, jobs[i]->offset, jobs[i]->limit, 0, NULL);
+        ecs_thread_t *thr = &threads[i % thread_count];
+        thr->jobs[thr->job_count] = &jobs[i];
+        thr->job_count ++;
     }
-    thread->job_count = 0;
 
-    if (world->jobs_finished != ecs_array_count(world->worker_threads) - 1) {
+    ecs_run_jobs(world);
+    ecs_array_clear(world->task_jobs);
+}
+
+/** Wait until the jobs of an async run have finished. The results stay in the
+ * worker stages until the next merge. */
+void ecs_wait_for_async(
+    ecs_world_t *world)
+{
+    if (world->async_pending) {
         wait_for_jobs(world);
+        update_job_costs(world);
+        world->async_pending = false;
+    }
+
+    if (world->async_staged) {
+        world->in_progress = false;
+        world->async_staged = false;
     }
 }
 
@@ -281,22 +850,173 @@ void ecs_set_threads(
     uint32_t threads)
 {
     if (!world->arg_threads) {
-        if (ecs_array_count(world->worker_threads)) {
+        ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+        /* The builtin threads replace an external scheduler */
+        if (world->scheduler.submit) {
             ecs_stop_threads(world);
-            ecs_os_cond_free(world->thread_cond);
-            ecs_os_mutex_free(world->thread_mutex);
-            ecs_os_cond_free(world->job_cond);
-            ecs_os_mutex_free(world->job_mutex);
         }
 
-        if (threads > 1) {
-            world->thread_cond = ecs_os_cond_new();
-            world->thread_mutex = ecs_os_mutex_new();
-            world->job_cond = ecs_os_cond_new();
-            world->job_mutex = ecs_os_mutex_new();
-            start_threads(world, threads);
+        ecs_wait_for_async(world);
+
+        if (threads < 2) {
+            threads = 0;
+        }
+
+        if (threads || world->threads_created) {
+            resize_threads(world, threads);
         }
 
         world->valid_schedule = false;
     }
 }
+
+void ecs_set_scheduler(
+    ecs_world_t *world,
+    uint32_t threads,
+    const ecs_scheduler_t *scheduler)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!scheduler || scheduler->submit != NULL, 
+        ECS_INVALID_PARAMETERS, NULL);
+
+    if (world->threads_created) {
+        ecs_stop_threads(world);
+    }
+
+    if (scheduler && threads > 1) {
+        world->scheduler = *scheduler;
+        add_threads(world, threads);
+
+        /* Stages of threads are used while threads are running */
+        world->threads_running = threads - 1;
+    }
+
+    world->valid_schedule = false;
+}
+
+void ecs_run_scheduled(
+    ecs_world_t *world,
+    uint32_t thread)
+{
+    ecs_assert(world->scheduler.submit != NULL, ECS_INVALID_PARAMETERS, NULL);
+    ecs_assert(thread < ecs_array_count(world->worker_threads), 
+        ECS_INVALID_PARAMETERS, NULL);
+
+    run_thread_jobs(world, ecs_array_get(
+        world->worker_threads, &thread_arr_params, thread));
+
+    ecs_os_mutex_lock(world->job_mutex);
+    world->jobs_finished ++;
+    if (world->jobs_finished == jobs_expected(world)) {
+        ecs_os_cond_signal(world->job_cond);
+    }
+    ecs_os_mutex_unlock(world->job_mutex);
+}
+
+ecs_async_t ecs_run_async(
+    ecs_world_t *world,
+    ecs_entity_t system,
+    float delta_time,
+    void *param)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+
+    ecs_wait_for_async(world);
+    world->async_id ++;
+
+    uint32_t thread_count = ecs_array_count(world->worker_threads);
+    if (thread_count < 2) {
+        ecs_run(world, system, delta_time, param);
+        return world->async_id;
+    }
+
+    /* Until the system has finished, the world is staged as if it were in
+     * progress, so that the main thread does not modify the storage that the
+     * workers read from. */
+    if (!world->in_progress) {
+        ecs_hierarchy_sort(world);
+        world->in_progress = true;
+        world->async_staged = true;
+    }
+
+    /* Sorting may have moved the system. Workers that notify row systems use
+     * the stored system pointers, which can't be refreshed while they run. */
+    ecs_world_sync_systems(world);
+
+    EcsColSystem *system_data = ecs_get_ptr(world, system, EcsColSystem);
+    ecs_assert(system_data != NULL, ECS_INVALID_PARAMETERS, NULL);
+
+    ecs_system_sort_tables(world, system_data);
+    ecs_system_mark_changed(world, system_data);
+
+    /* The main thread does not run jobs, so it is free to continue */
+    uint32_t worker_count = thread_count - 1;
+    uint32_t offset = 0, row_count = count_rows(world, system_data);
+    bool open = true;
+
+    /* Time sliced systems run their next slice, as they do with ecs_run */
+    if (system_data->slice_frames && 
+        ecs_system_next_slice(world, system_data, &offset, &row_count)) 
+    {
+        open = false;
+    }
+
+    /* The jobs of the system are kept by the regular schedule, so the async
+     * run has its own jobs */
+    schedule_range(system_data, &world->async_jobs, worker_count, offset, 
+        row_count, open);
+
+    ecs_thread_t *threads = ecs_array_buffer(world->worker_threads);
+    ecs_job_t *jobs = ecs_array_buffer(world->async_jobs);
+    uint32_t i, job_count = ecs_array_count(world->async_jobs);
+
+    for (i = 0; i < job_count; i ++) {
+        ecs_thread_t *thr = &threads[i + 1];
+        thr->jobs[thr->job_count] = &jobs[i];
+        thr->job_count ++;
+    }
+
+    world->job_delta_time = delta_time;
+    world->job_param = param;
+    world->async_pending = true;
+    submit_jobs(world);
+
+    return world->async_id;
+}
+
+bool ecs_async_done(
+    ecs_world_t *world,
+    ecs_async_t handle)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+
+    if (!world->async_pending || handle != world->async_id) {
+        return true;
+    }
+
+    ecs_os_mutex_lock(world->job_mutex);
+    bool done = world->jobs_finished == jobs_expected(world);
+    ecs_os_mutex_unlock(world->job_mutex);
+
+    return done;
+}
+
+void ecs_async_wait(
+    ecs_world_t *world,
+    ecs_async_t handle)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+
+    if (handle == world->async_id) {
+        ecs_wait_for_async(world);
+    }
+
+    /* Outside of a frame results are merged right away. Inside a frame they
+     * are merged with the rest of the phase. */
+    if (world->auto_merge && !world->in_progress && !world->is_merging) {
+        ecs_merge(world);
+    }
+}
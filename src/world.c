@@ -23,6 +23,23 @@ const ecs_array_params_t char_arr_params = {
     .element_size = sizeof(char)
 };
 
+const ecs_array_params_t ptr_arr_params = {
+    .element_size = sizeof(void*)
+};
+
+const ecs_array_params_t row_system_arr_params = {
+    .element_size = sizeof(ecs_row_system_ref_t)
+};
+
+const ecs_array_params_t reference_arr_params = {
+    .element_size = sizeof(ecs_reference_t)
+};
+
+static
+const ecs_array_params_t snapshot_arr_params = {
+    .element_size = sizeof(ecs_snapshot_system_t)
+};
+
 
 /* -- Global variables -- */
 
@@ -89,6 +106,20 @@ ecs_table_t* bootstrap_component_table(
     result->type_id = world->t_component;
     result->type = type;
     result->frame_systems = NULL;
+    result->disabled = NULL;
+    result->disabled_count = 0;
+    result->last_modified = 0;
+    result->depth_offsets = NULL;
+    result->parent_column = 0;
+    result->hierarchy_dirty = false;
+    result->is_sorted = false;
+    result->has_systems = false;
+    result->is_prefab = false;
+    result->prefab_cache = NULL;
+    result->column_versions = ecs_os_calloc(
+        ecs_array_count(type) + 1, sizeof(uint32_t));
+    result->instantiate_plans = NULL;
+    result->prefab_cache_version = 0;
     result->columns = ecs_os_malloc(sizeof(ecs_table_column_t) * 3);
     ecs_assert(result->columns != NULL, ECS_OUT_OF_MEMORY, NULL);
 
@@ -121,7 +152,7 @@ void bootstrap_component(
     ecs_stage_t *stage = &world->main_stage;
 
     /* Insert row into table to store EcsComponent itself */
-    int32_t index = ecs_table_insert(world, table, table->columns, entity);
+    int32_t index = ecs_table_insert(world, stage, table, table->columns, entity);
 
     /* Create record in entity index */
     ecs_row_t row = {.type_id = world->t_component, .index = index};
@@ -164,6 +195,12 @@ void notify_systems_of_table(
     notify_create_table(world, world->on_update_systems, table);
     notify_create_table(world, world->inactive_systems, table);
     notify_create_table(world, world->on_demand_systems, table);
+
+    ecs_query_t **queries = ecs_array_buffer(world->queries);
+    uint32_t i, count = ecs_array_count(world->queries);
+    for (i = 0; i < count; i ++) {
+        ecs_query_notify_of_table(world, queries[i], table);
+    }
 }
 
 /** Create a new table and register it with the world and systems. A table in
@@ -304,6 +341,120 @@ void ecs_world_activate_system(
         qsort(src_array, ecs_array_count(src_array) + 1,
           sizeof(ecs_entity_t), compare_handle);
     }
+
+    world->system_version ++;
+}
+
+/** Store pointer to the data of each system in a system array */
+static
+void sync_system_ptrs(
+    ecs_world_t *world,
+    ecs_array_t *systems,
+    ecs_array_t **ptrs,
+    ecs_entity_t component)
+{
+    uint32_t i, count = ecs_array_count(systems);
+    ecs_entity_t *buffer = ecs_array_buffer(systems);
+
+    ecs_array_set_count(ptrs, &ptr_arr_params, count);
+    void **ptr_buffer = ecs_array_buffer(*ptrs);
+
+    for (i = 0; i < count; i ++) {
+        ecs_entity_info_t info = {0};
+        ptr_buffer[i] = get_ptr(world, &world->main_stage, buffer[i], 
+            component, false, false, &info);
+        ecs_assert(ptr_buffer[i] != NULL, ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/** Store pointer to the data of each row system in a type-rowsys index */
+static
+void sync_row_system_index(
+    ecs_world_t *world,
+    ecs_map_t *index)
+{
+    EcsIter it = ecs_map_iter(index);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_array_t *systems = ecs_iter_next(&it);
+        ecs_row_system_ref_t *buffer = ecs_array_buffer(systems);
+        uint32_t i, count = ecs_array_count(systems);
+
+        for (i = 0; i < count; i ++) {
+            ecs_entity_info_t info = {0};
+            buffer[i].data = get_ptr(world, &world->main_stage, 
+                buffer[i].system, EEcsRowSystem, false, false, &info);
+            ecs_assert(buffer[i].data != NULL, ECS_INTERNAL_ERROR, NULL);
+        }
+    }
+}
+
+/** Refresh the pointers to system data that the pipeline and the row system
+ * indexes use to run systems. System data is stored in tables, and moves when
+ * rows are added to or removed from these tables. Such changes, as well as
+ * changes to the pipeline, increase world::system_version. */
+void ecs_world_sync_systems(
+    ecs_world_t *world)
+{
+    if (world->system_ptrs_version == world->system_version) {
+        return;
+    }
+
+    uint32_t kind;
+    for (kind = 0; kind < ECS_PHASE_COUNT; kind ++) {
+        sync_system_ptrs(world, *frame_system_array(world, kind), 
+            &world->phase_ptrs[kind], EEcsColSystem);
+    }
+
+    sync_system_ptrs(world, world->tasks, &world->task_ptrs, EEcsRowSystem);
+
+    sync_row_system_index(world, world->type_sys_add_index);
+    sync_row_system_index(world, world->type_sys_remove_index);
+    sync_row_system_index(world, world->type_sys_set_index);
+
+    world->system_ptrs_version = world->system_version;
+}
+
+static
+void mark_sorted_systems(
+    ecs_world_t *world,
+    ecs_array_t *systems)
+{
+    uint32_t i, count = ecs_array_count(systems);
+    ecs_entity_t *buffer = ecs_array_buffer(systems);
+
+    for (i = 0; i < count; i ++) {
+        EcsColSystem *ptr = ecs_get_ptr(world, buffer[i], EcsColSystem);
+        ecs_system_mark_sorted(world, ptr);
+    }
+}
+
+void ecs_world_update_sorted_tables(
+    ecs_world_t *world)
+{
+    ecs_table_t *tables = ecs_array_buffer(world->main_stage.tables);
+    uint32_t i, count = ecs_array_count(world->main_stage.tables);
+
+    for (i = 0; i < count; i ++) {
+        tables[i].is_sorted = false;
+    }
+
+    mark_sorted_systems(world, world->on_load_systems);
+    mark_sorted_systems(world, world->post_load_systems);
+    mark_sorted_systems(world, world->pre_update_systems);
+    mark_sorted_systems(world, world->on_update_systems);
+    mark_sorted_systems(world, world->on_validate_systems);
+    mark_sorted_systems(world, world->post_update_systems);
+    mark_sorted_systems(world, world->pre_store_systems);
+    mark_sorted_systems(world, world->on_store_systems);
+    mark_sorted_systems(world, world->on_demand_systems);
+    mark_sorted_systems(world, world->inactive_systems);
+
+    ecs_query_t **queries = ecs_array_buffer(world->queries);
+    count = ecs_array_count(world->queries);
+
+    for (i = 0; i < count; i ++) {
+        ecs_system_mark_sorted(world, &queries[i]->system);
+    }
 }
 
 union RowUnion {
@@ -403,9 +554,49 @@ void col_systems_deinit(
         ecs_array_free(ptr->components);
         ecs_array_free(ptr->inactive_tables);
         ecs_array_free(ptr->jobs);
+        ecs_array_free(ptr->level_rows);
+        ecs_array_free(ptr->row_costs);
         ecs_array_free(ptr->tables);
         ecs_array_free(ptr->refs);
+        ecs_array_free(ptr->sorted_slices);
+    }
+}
+
+static
+void row_systems_deinit(
+    ecs_world_t *world,
+    ecs_array_t *systems)
+{
+    uint32_t i, count = ecs_array_count(systems);
+    ecs_entity_t *buffer = ecs_array_buffer(systems);
+
+    for (i = 0; i < count; i ++) {
+        EcsRowSystem *ptr = ecs_get_ptr(world, buffer[i], EcsRowSystem);
+        ecs_array_free(ptr->base.columns);
+        ecs_array_free(ptr->components);
+        ecs_array_free(ptr->conflicts);
+        ecs_array_free(ptr->refs);
+    }
+}
+
+static
+void row_system_index_free(
+    ecs_map_t *index)
+{
+    EcsIter it = ecs_map_iter(index);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_array_t *systems = ecs_iter_next(&it);
+        ecs_row_system_ref_t *buffer = ecs_array_buffer(systems);
+        uint32_t i, count = ecs_array_count(systems);
+
+        for (i = 0; i < count; i ++) {
+            ecs_os_free(buffer[i].columns);
+        }
+
+        ecs_array_free(systems);
     }
+
+    ecs_map_free(index);
 }
 
 /* Spoof EcsAdnin type (needed until we have proper reflection) */
@@ -462,6 +653,162 @@ void load_admin(
 #endif
 }
 
+/** Entry point of the thread that runs the store phases of a frame. Systems
+ * get the thread object as world, which has no stage, so that they don't read
+ * the state of the world that the main thread modifies. The thread is created
+ * when pipelining is enabled, and waits for the snapshots of each frame. */
+static
+void* store_thread(
+    void *arg)
+{
+    ecs_thread_t *thread = arg;
+    ecs_world_t *world = thread->world;
+
+    ecs_os_mutex_lock(world->store_mutex);
+
+    while (true) {
+        while (!world->store_pending && !world->store_quit) {
+            ecs_os_cond_wait(world->store_cond, world->store_mutex);
+        }
+
+        if (!world->store_pending) {
+            break;
+        }
+
+        ecs_os_mutex_unlock(world->store_mutex);
+
+        ecs_snapshot_system_t *buffer = ecs_array_buffer(world->store_snapshot);
+        uint32_t i, count = ecs_array_count(world->store_snapshot);
+
+        for (i = 0; i < count; i ++) {
+            ecs_snapshot_run((ecs_world_t*)thread, &buffer[i]);
+        }
+
+        ecs_os_mutex_lock(world->store_mutex);
+        world->store_pending = false;
+        ecs_os_cond_broadcast(world->store_cond);
+    }
+
+    ecs_os_mutex_unlock(world->store_mutex);
+
+    return NULL;
+}
+
+/** Wait until the store phases of the previous frame have finished */
+static
+void wait_for_store(
+    ecs_world_t *world)
+{
+    if (!ecs_array_count(world->store_snapshot)) {
+        return;
+    }
+
+    ecs_os_mutex_lock(world->store_mutex);
+    while (world->store_pending) {
+        ecs_os_cond_wait(world->store_cond, world->store_mutex);
+    }
+    ecs_os_mutex_unlock(world->store_mutex);
+
+    ecs_snapshot_system_t *buffer = ecs_array_buffer(world->store_snapshot);
+    uint32_t i, count = ecs_array_count(world->store_snapshot);
+
+    for (i = 0; i < count; i ++) {
+        ecs_snapshot_free(&buffer[i]);
+    }
+
+    ecs_array_clear(world->store_snapshot);
+}
+
+/** Create the thread that runs the store phases */
+static
+void start_store_thread(
+    ecs_world_t *world)
+{
+    if (world->store_thread.thread) {
+        return;
+    }
+
+    world->store_cond = ecs_os_cond_new();
+    world->store_mutex = ecs_os_mutex_new();
+    world->store_thread.thread = ecs_os_thread_new(
+        store_thread, &world->store_thread);
+    if (!world->store_thread.thread) {
+        ecs_abort(ECS_THREAD_ERROR, NULL);
+    }
+}
+
+/** Wait for the store phases to finish, and join the store thread */
+static
+void stop_store_thread(
+    ecs_world_t *world)
+{
+    if (!world->store_thread.thread) {
+        return;
+    }
+
+    wait_for_store(world);
+
+    ecs_os_mutex_lock(world->store_mutex);
+    world->store_quit = true;
+    ecs_os_cond_broadcast(world->store_cond);
+    ecs_os_mutex_unlock(world->store_mutex);
+
+    ecs_os_thread_join(world->store_thread.thread);
+    ecs_os_cond_free(world->store_cond);
+    ecs_os_mutex_free(world->store_mutex);
+
+    world->store_thread.thread = 0;
+    world->store_quit = false;
+}
+
+/** Copy the data read by the systems of the store phases, and run them on the
+ * store thread while the next frame runs. Returns false if a system can't run
+ * from a copy, in which case the store phases run on the main thread. */
+static
+bool start_store(
+    ecs_world_t *world)
+{
+    EcsSystemKind kinds[] = {EcsPreStore, EcsOnStore};
+    uint32_t k, i;
+
+    ecs_hierarchy_sort(world);
+    ecs_world_sync_systems(world);
+
+    for (k = 0; k < 2; k ++) {
+        EcsColSystem **buffer = ecs_array_buffer(world->phase_ptrs[kinds[k]]);
+        uint32_t count = ecs_array_count(*frame_system_array(world, kinds[k]));
+
+        for (i = 0; i < count; i ++) {
+            if (!ecs_system_can_snapshot(buffer[i])) {
+                return false;
+            }
+        }
+    }
+
+    for (k = 0; k < 2; k ++) {
+        EcsColSystem **buffer = ecs_array_buffer(world->phase_ptrs[kinds[k]]);
+        uint32_t count = ecs_array_count(*frame_system_array(world, kinds[k]));
+
+        for (i = 0; i < count; i ++) {
+            ecs_snapshot_system_t snapshot;
+            if (ecs_system_snapshot(world, buffer[i], &snapshot)) {
+                ecs_snapshot_system_t *elem = ecs_array_add(
+                    &world->store_snapshot, &snapshot_arr_params);
+                *elem = snapshot;
+            }
+        }
+    }
+
+    if (ecs_array_count(world->store_snapshot)) {
+        ecs_os_mutex_lock(world->store_mutex);
+        world->store_pending = true;
+        ecs_os_cond_broadcast(world->store_cond);
+        ecs_os_mutex_unlock(world->store_mutex);
+    }
+
+    return true;
+}
+
 /* -- Public functions -- */
 
 ecs_world_t *ecs_init(void) {
@@ -469,6 +816,7 @@ ecs_world_t *ecs_init(void) {
 
     ecs_world_t *world = ecs_os_malloc(sizeof(ecs_world_t));
     ecs_assert(world != NULL, ECS_OUT_OF_MEMORY, NULL);
+    uint32_t i;
 
     world->magic = ECS_WORLD_MAGIC;
 
@@ -483,10 +831,21 @@ ecs_world_t *ecs_init(void) {
     world->inactive_systems = ecs_array_new(&handle_arr_params, 0);
     world->on_demand_systems = ecs_array_new(&handle_arr_params, 0);
 
+    for (i = 0; i < ECS_PHASE_COUNT; i ++) {
+        world->phase_ptrs[i] = ecs_array_new(&ptr_arr_params, 0);
+    }
+
+    world->system_version = 0;
+    world->prefab_version = 0;
+    world->system_ptrs_version = 0;
+
     world->add_systems = ecs_array_new(&handle_arr_params, 0);
     world->remove_systems = ecs_array_new(&handle_arr_params, 0);
     world->set_systems = ecs_array_new(&handle_arr_params, 0);
     world->tasks = ecs_array_new(&handle_arr_params, 0);
+    world->task_ptrs = ecs_array_new(&ptr_arr_params, 0);
+    world->task_jobs = NULL;
+    world->async_jobs = NULL;
     world->fini_tasks = ecs_array_new(&handle_arr_params, 0);
 
     world->type_sys_add_index = ecs_map_new(0);
@@ -494,6 +853,16 @@ ecs_world_t *ecs_init(void) {
     world->type_sys_set_index = ecs_map_new(0);
     world->type_handles = ecs_map_new(0);
     world->prefab_index = ecs_map_new(0);
+    world->child_index = ecs_map_new(0);
+    world->changed_containers = ecs_map_new(0);
+    world->changed_components = ecs_map_new(0);
+    world->singletons = ecs_array_new(&ptr_arr_params, 0);
+    world->singleton_slots = false;
+    world->queries = ecs_array_new(&ptr_arr_params, 0);
+    ecs_event_queue_init(&world->add_events, world->type_sys_add_index);
+    ecs_event_queue_init(&world->set_events, world->type_sys_set_index);
+    world->e_parent = 0;
+    world->t_parent = 0;
 
     world->worker_stages = NULL;
     world->worker_threads = NULL;
@@ -504,25 +873,57 @@ ecs_world_t *ecs_init(void) {
     world->in_progress = false;
     world->is_merging = false;
     world->auto_merge = true;
+    world->defer_events = false;
     world->measure_frame_time = false;
     world->measure_system_time = false;
     world->last_handle = 0;
     world->should_quit = false;
     world->should_match = false;
+    world->hierarchy_dirty = false;
 
     world->frame_start = (ecs_time_t){0, 0};
     world->frame_time = 0;
     world->merge_time = 0;
+    world->pre_update_time = (ecs_phase_time_t){0, 0};
+    world->on_update_time = (ecs_phase_time_t){0, 0};
+    world->on_validate_time = (ecs_phase_time_t){0, 0};
+    world->post_update_time = (ecs_phase_time_t){0, 0};
+    world->phase_time = NULL;
     world->system_time = 0;
     world->target_fps = 0;
-    world->fps_sleep = 0;
+    world->frame_deadline = 0;
+    world->frame_budget = 0;
     world->tick = 0;
+    world->frame_count = 0;
+    world->row_changes = 0;
+    world->async_id = 0;
+    world->async_pending = false;
+    world->async_staged = false;
+    world->store_snapshot = ecs_array_new(&snapshot_arr_params, 0);
+    world->store_thread = (ecs_thread_t){
+        .magic = ECS_THREAD_MAGIC,
+        .world = world
+    };
+    world->store_pending = false;
+    world->store_quit = false;
+    world->pipelined = false;
+    world->scheduler = (ecs_scheduler_t){0};
+    world->threads_created = 0;
+    world->job_delta_time = 0;
+    world->job_param = NULL;
 
     world->context = NULL;
 
     world->arg_fps = 0;
     world->arg_threads = 0;
 
+    world->gc_frames = 0;
+
+    world->defrag_budget = 0;
+    world->defrag_cursor = 0;
+    world->defrag_component = 0;
+    world->defrag_compare = NULL;
+
     ecs_stage_init(world, &world->main_stage);
     ecs_stage_init(world, &world->temp_stage);
 
@@ -609,16 +1010,22 @@ int ecs_fini(
     assert(!world->in_progress);
     assert(!world->is_merging);
 
+    stop_store_thread(world);
+    ecs_array_free(world->store_snapshot);
+
+    ecs_flush_events(world);
+
     uint32_t i, system_count = ecs_array_count(world->fini_tasks);
     if (system_count) {
         ecs_entity_t *buffer = ecs_array_buffer(world->fini_tasks);
         for (i = 0; i < system_count; i ++) {
-            ecs_run_task(world, buffer[i]);
+            ecs_run_task(world, buffer[i], 
+                ecs_get_ptr(world, buffer[i], EcsRowSystem));
         }
     }
 
-    if (world->worker_threads) {
-        ecs_set_threads(world, 0);
+    if (world->threads_created) {
+        ecs_stop_threads(world);
     }
 
     col_systems_deinit(world, world->on_update_systems);
@@ -632,6 +1039,19 @@ int ecs_fini(
     col_systems_deinit(world, world->on_demand_systems);
     col_systems_deinit(world, world->inactive_systems);
 
+    /* Freeing a query removes it from the query array */
+    while (ecs_array_count(world->queries)) {
+        ecs_query_free(*(ecs_query_t**)ecs_array_get(world->queries, 
+            &ptr_arr_params, ecs_array_count(world->queries) - 1));
+    }
+
+    ecs_array_free(world->queries);
+    row_systems_deinit(world, world->tasks);
+    row_systems_deinit(world, world->fini_tasks);
+    row_systems_deinit(world, world->add_systems);
+    row_systems_deinit(world, world->remove_systems);
+    row_systems_deinit(world, world->set_systems);
+
     ecs_stage_deinit(world, &world->main_stage);
     ecs_stage_deinit(world, &world->temp_stage);
 
@@ -644,9 +1064,16 @@ int ecs_fini(
     ecs_array_free(world->pre_store_systems);
     ecs_array_free(world->on_store_systems);
 
+    for (i = 0; i < ECS_PHASE_COUNT; i ++) {
+        ecs_array_free(world->phase_ptrs[i]);
+    }
+
     ecs_array_free(world->inactive_systems);
     ecs_array_free(world->on_demand_systems);
     ecs_array_free(world->tasks);
+    ecs_array_free(world->task_ptrs);
+    ecs_array_free(world->task_jobs);
+    ecs_array_free(world->async_jobs);
     ecs_array_free(world->fini_tasks);
 
     ecs_array_free(world->add_systems);
@@ -654,10 +1081,23 @@ int ecs_fini(
     ecs_array_free(world->set_systems);
 
     ecs_map_free(world->prefab_index);
-    ecs_map_free(world->type_sys_add_index);
-    ecs_map_free(world->type_sys_remove_index);
-    ecs_map_free(world->type_sys_set_index);
+    row_system_index_free(world->type_sys_add_index);
+    row_system_index_free(world->type_sys_remove_index);
+    row_system_index_free(world->type_sys_set_index);
     ecs_map_free(world->type_handles);
+    ecs_singleton_fini(world);
+    ecs_event_queue_deinit(&world->add_events);
+    ecs_event_queue_deinit(&world->set_events);
+
+    EcsIter it = ecs_map_iter(world->child_index);
+    while (ecs_iter_hasnext(&it)) {
+        ecs_array_t *children = ecs_iter_next(&it);
+        ecs_array_free(children);
+    }
+
+    ecs_map_free(world->child_index);
+    ecs_map_free(world->changed_containers);
+    ecs_map_free(world->changed_components);
 
     world->magic = 0;
 
@@ -683,7 +1123,7 @@ void _ecs_dim_type(
     if (type) {
         ecs_table_t *table = ecs_world_get_table(world, &world->main_stage, type);
         if (table) {
-            ecs_table_dim(table, entity_count);
+            ecs_table_dim(world, table, entity_count);
         }
     }
 }
@@ -753,27 +1193,140 @@ void rematch_systems(
     rematch_system_array(world, world->pre_store_systems);
     rematch_system_array(world, world->on_store_systems);    
     rematch_system_array(world, world->inactive_systems);   
+
+    ecs_query_t **queries = ecs_array_buffer(world->queries);
+    uint32_t i, count = ecs_array_count(world->queries);
+    for (i = 0; i < count; i ++) {
+        ecs_query_rematch(world, queries[i]);
+    }
+}
+
+/** Delete an empty table. The last table in the table array is moved to the
+ * index of the deleted table, so systems that matched with it are updated. */
+static
+void gc_delete_table(
+    ecs_world_t *world,
+    uint32_t index)
+{
+    ecs_stage_t *stage = &world->main_stage;
+    uint32_t i, last = ecs_array_count(stage->tables) - 1;
+    ecs_table_t *table = ecs_array_get(stage->tables, &table_arr_params, index);
+
+    ecs_entity_t *systems = ecs_array_buffer(table->frame_systems);
+    uint32_t count = ecs_array_count(table->frame_systems);
+    for (i = 0; i < count; i ++) {
+        ecs_system_remove_table(world, systems[i], index);
+    }
+
+    /* Queries are not registered with tables, so check all of them */
+    ecs_query_t **queries = ecs_array_buffer(world->queries);
+    uint32_t query_count = ecs_array_count(world->queries);
+    for (i = 0; i < query_count; i ++) {
+        ecs_query_remove_table(world, queries[i], index);
+    }
+
+    ecs_map_remove(stage->table_index, table->type_id);
+    ecs_table_free(world, table);
+
+    if (index != last) {
+        ecs_table_t *moved = ecs_array_get(
+            stage->tables, &table_arr_params, last);
+
+        systems = ecs_array_buffer(moved->frame_systems);
+        count = ecs_array_count(moved->frame_systems);
+        for (i = 0; i < count; i ++) {
+            ecs_system_move_table(world, systems[i], last, index);
+        }
+
+        for (i = 0; i < query_count; i ++) {
+            ecs_query_move_table(queries[i], last, index);
+        }
+
+        ecs_map_set64(stage->table_index, moved->type_id, index + 1);
+    }
+
+    ecs_array_remove_index(stage->tables, &table_arr_params, index);
+}
+
+/** Delete tables that have been empty, and release unused column memory of
+ * tables that have not changed for at least gc_frames frames. */
+static
+void gc_tables(
+    ecs_world_t *world,
+    bool force)
+{
+    ecs_stage_t *stage = &world->main_stage;
+    uint32_t frame_count = world->frame_count;
+    uint32_t gc_frames = world->gc_frames;
+    bool deleted = false;
+
+    /* Walk backwards, so that tables moved by a delete are already visited.
+     * The first table stores the components and is never collected. */
+    int32_t i;
+    for (i = ecs_array_count(stage->tables) - 1; i > 0; i --) {
+        ecs_table_t *table = ecs_array_get(stage->tables, &table_arr_params, i);
+
+        if (!force && (frame_count - table->last_modified) < gc_frames) {
+            continue;
+        }
+
+        if (!ecs_table_count(table)) {
+            gc_delete_table(world, i);
+            deleted = true;
+        } else {
+            ecs_table_reclaim(world, table);
+        }
+    }
+
+    if (deleted) {
+        world->valid_schedule = false;
+    }
+}
+
+/** Check if a deferrable system must be skipped because the time spent on the
+ * current frame exceeds the frame budget */
+static
+bool skip_deferrable(
+    ecs_world_t *world,
+    EcsColSystem *system_data)
+{
+    if (!system_data->deferrable || !world->frame_budget) {
+        return false;
+    }
+
+    ecs_time_t t = world->frame_start;
+    return ecs_time_measure(&t) >= world->frame_budget;
 }
 
 static
 void run_single_thread_stage(
     ecs_world_t *world,
-    ecs_array_t *systems)
+    EcsSystemKind kind)
 {
-    uint32_t i, system_count = ecs_array_count(systems);
+    uint32_t i, system_count = ecs_array_count(*frame_system_array(world, kind));
 
     if (system_count) {
-        ecs_entity_t *buffer = ecs_array_buffer(systems);
+        /* Sort tables with parent columns changed by the previous merge */
+        ecs_hierarchy_sort(world);
+        ecs_world_sync_systems(world);
+
+        EcsColSystem **buffer = ecs_array_buffer(world->phase_ptrs[kind]);
 
         world->in_progress = true;
 
         for (i = 0; i < system_count; i ++) {
-            ecs_run(world, buffer[i], world->delta_time, NULL);
+            if (skip_deferrable(world, buffer[i])) {
+                continue;
+            }
+
+            ecs_col_system_run(
+                world, buffer[i], world->delta_time, 0, 0, 0, NULL, NULL);
         }
 
         if (world->auto_merge) {
             world->in_progress = false;
             ecs_merge(world);
+            ecs_flush_events(world);
             world->in_progress = true;
         }
     }
@@ -782,27 +1335,58 @@ void run_single_thread_stage(
 static
 void run_multi_thread_stage(
     ecs_world_t *world,
-    ecs_array_t *systems)
+    EcsSystemKind kind,
+    ecs_phase_time_t *phase_time)
 {
     /* Run periodic table systems */
-    uint32_t i, system_count = ecs_array_count(systems);
+    uint32_t i, system_count = ecs_array_count(*frame_system_array(world, kind));
     if (system_count) {
-        bool valid_schedule = world->valid_schedule;
-        ecs_entity_t *buffer = ecs_array_buffer(systems);
+        /* Sort tables with parent columns changed by the previous merge */
+        ecs_hierarchy_sort(world);
+        ecs_world_sync_systems(world);
+
+        EcsColSystem **buffer = ecs_array_buffer(world->phase_ptrs[kind]);
 
         world->in_progress = true;
+        world->phase_time = phase_time;
 
         for (i = 0; i < system_count; i ++) {
-            if (!valid_schedule) {
-                ecs_schedule_jobs(world, buffer[i]);
+            EcsColSystem *system_data = buffer[i];
+
+            /* The budget is checked when jobs are handed out, so a deferrable
+             * system is either ran by all workers or skipped */
+            if (skip_deferrable(world, system_data)) {
+                continue;
             }
-            ecs_prepare_jobs(world, buffer[i]);
+
+            /* Systems with a CASCADE column run one hierarchy level at a time,
+             * after the jobs of the systems that precede it have finished */
+            if (system_data->base.cascade_by) {
+                ecs_thread_t *thread = ecs_array_buffer(world->worker_threads);
+                if (thread->job_count) {
+                    ecs_run_jobs(world);
+                }
+
+                ecs_run_cascade_jobs(world, system_data);
+                continue;
+            }
+
+            /* Rows are sorted before jobs are handed out, as workers only
+             * read the sorted order */
+            ecs_system_sort_tables(world, system_data);
+            ecs_schedule_jobs(world, system_data);
+            ecs_prepare_jobs(world, system_data);
+        }
+
+        ecs_thread_t *thread = ecs_array_buffer(world->worker_threads);
+        if (thread->job_count) {
+            ecs_run_jobs(world);
         }
-        ecs_run_jobs(world);
 
         if (world->auto_merge) {
             world->in_progress = false;
             ecs_merge(world);
+            ecs_flush_events(world);
             world->in_progress = true;
         }
     }
@@ -810,16 +1394,39 @@ void run_multi_thread_stage(
 
 static
 void run_tasks(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    bool has_threads)
 {
     /* Run periodic row systems (not matched to any entity) */
     uint32_t i, system_count = ecs_array_count(world->tasks);
     if (system_count) {
+        ecs_world_sync_systems(world);
+
         world->in_progress = true;
+        world->phase_time = NULL;
 
         ecs_entity_t *buffer = ecs_array_buffer(world->tasks);
+        EcsRowSystem **task_ptrs = ecs_array_buffer(world->task_ptrs);
         for (i = 0; i < system_count; i ++) {
-            ecs_run_task(world, buffer[i]);
+            EcsRowSystem *task_data = task_ptrs[i];
+
+            /* Tasks that are not parallel run in the main thread after the
+             * tasks that precede it have finished */
+            if (has_threads && task_data->parallel) {
+                ecs_schedule_task(world, buffer[i], task_data);
+            } else {
+                ecs_run_task_jobs(world);
+                ecs_run_task(world, buffer[i], task_data);
+            }
+        }
+
+        ecs_run_task_jobs(world);
+
+        if (world->auto_merge) {
+            world->in_progress = false;
+            ecs_merge(world);
+            ecs_flush_events(world);
+            world->in_progress = true;
         }
     }
 }
@@ -847,28 +1454,65 @@ float start_measure_frame(
     return delta_time;
 }
 
+/** Get current time in seconds */
 static
-void stop_measure_frame(
+double time_now(void)
+{
+    ecs_time_t t;
+    ecs_os_get_time(&t);
+    return ecs_time_to_double(t);
+}
+
+/** Wait until the frame deadline of the target fps. Each deadline is one period
+ * after the previous one, so that time the application spends in between calls
+ * to ecs_progress counts towards the frame. When a frame overruns, deadlines
+ * restart from the current time, instead of running frames back to back to
+ * catch up. Sleeping is not precise enough for high frame rates, so the thread
+ * sleeps until shortly before the deadline, and spins for the remaining time. */
+static
+void wait_for_deadline(
     ecs_world_t *world,
-    float delta_time)
+    float target_fps)
+{
+    double frame_period = 1.0 / target_fps;
+    double deadline = world->frame_deadline;
+    double now = time_now();
+
+    if (deadline) {
+        deadline += frame_period;
+    } else {
+        deadline = ecs_time_to_double(world->frame_start) + frame_period;
+    }
+
+    if (deadline < now) {
+        deadline = now;
+    }
+
+    world->frame_deadline = deadline;
+
+    double remaining = deadline - now;
+    if (remaining > ECS_FRAME_SPIN_TIME) {
+        ecs_sleepf(remaining - ECS_FRAME_SPIN_TIME);
+    }
+
+    do {
+        now = time_now();
+    } while (now < deadline);
+}
+
+static
+void stop_measure_frame(
+    ecs_world_t *world)
 {
     if (world->measure_frame_time) {
         ecs_time_t t = world->frame_start;
         world->frame_time += ecs_time_measure(&t);
         world->tick ++;
 
-        /* Sleep if processing faster than target FPS */
+        /* Wait if processing faster than target FPS */
         float target_fps = world->target_fps;
         if (target_fps) {
-            float sleep = (1.0 / target_fps) - delta_time + world->fps_sleep;
-            if (sleep < 0) {
-                sleep = 0;
-            }
-            world->fps_sleep = sleep;
-
-            if (sleep > 0.005) {
-                ecs_sleepf(sleep);
-            }
+            wait_for_deadline(world, target_fps);
         }
     }
 }
@@ -879,6 +1523,9 @@ bool ecs_progress(
 {
     assert(world->magic == ECS_WORLD_MAGIC);
 
+    /* Workers of an async run read the world state that is updated below */
+    ecs_wait_for_async(world);
+
     /* Start measuring total frame time */
     float delta_time = start_measure_frame(world, user_delta_time);
 
@@ -888,45 +1535,74 @@ bool ecs_progress(
 
     world->delta_time = user_delta_time;
     world->merge_time = 0;
+    world->frame_count ++;
 
     bool has_threads = ecs_array_count(world->worker_threads) != 0;
 
+    /* Deliver notifications deferred since the last frame, so that systems
+     * see the results of OnAdd and OnSet systems */
+    ecs_flush_events(world);
+
     if (world->should_match) {
         rematch_systems(world);
+        ecs_map_clear(world->changed_containers);
+        ecs_map_clear(world->changed_components);
         world->should_match = false;
     }
 
     /* -- System execution starts here -- */
 
-    run_single_thread_stage(world, world->on_load_systems);
-    run_single_thread_stage(world, world->post_load_systems);
+    run_single_thread_stage(world, EcsOnLoad);
+    run_single_thread_stage(world, EcsPostLoad);
 
     if (has_threads) {
-        run_multi_thread_stage(world, world->pre_update_systems);
-        run_multi_thread_stage(world, world->on_update_systems);
-        run_multi_thread_stage(world, world->on_validate_systems);
-        run_multi_thread_stage(world, world->post_update_systems);
+        run_multi_thread_stage(
+            world, EcsPreUpdate, &world->pre_update_time);
+        run_multi_thread_stage(
+            world, EcsOnUpdate, &world->on_update_time);
+        run_multi_thread_stage(
+            world, EcsOnValidate, &world->on_validate_time);
+        run_multi_thread_stage(
+            world, EcsPostUpdate, &world->post_update_time);
+
+        /* Jobs are kept until tables or row counts of a system change */
+        world->valid_schedule = true;
     } else {
-        run_single_thread_stage(world, world->pre_update_systems);
-        run_single_thread_stage(world, world->on_update_systems);
-        run_single_thread_stage(world, world->on_validate_systems);
-        run_single_thread_stage(world, world->post_update_systems);
+        run_single_thread_stage(world, EcsPreUpdate);
+        run_single_thread_stage(world, EcsOnUpdate);
+        run_single_thread_stage(world, EcsOnValidate);
+        run_single_thread_stage(world, EcsPostUpdate);
     }
 
-    run_tasks(world);
+    run_tasks(world, has_threads);
 
-    run_single_thread_stage(world, world->pre_store_systems);
-    run_single_thread_stage(world, world->on_store_systems);
+    /* The store phases of the previous frame read from a copy of its data,
+     * which is replaced by the data of this frame */
+    wait_for_store(world);
+
+    if (!world->pipelined || !start_store(world)) {
+        run_single_thread_stage(world, EcsPreStore);
+        run_single_thread_stage(world, EcsOnStore);
+    }
 
     /* -- System execution stops here -- */
 
-    stop_measure_frame(world, delta_time);
+    stop_measure_frame(world);
 
     /* Time spent on systems is time spent on frame minus merge time */
     world->system_time = world->frame_time - world->merge_time;
 
     world->in_progress = false;
 
+    uint32_t gc_frames = world->gc_frames;
+    if (gc_frames && !(world->frame_count % gc_frames)) {
+        gc_tables(world, false);
+    }
+
+    if (world->defrag_budget && !world->async_pending) {
+        ecs_defragment(world, world->defrag_budget);
+    }
+
     return !world->should_quit;
 }
 
@@ -948,6 +1624,9 @@ void ecs_merge(
     assert(world->magic == ECS_WORLD_MAGIC);
     assert(world->is_merging == false);
 
+    /* Worker stages can't be merged while workers write to them */
+    ecs_wait_for_async(world);
+
     world->is_merging = true;
 
     ecs_time_t t_start;
@@ -966,6 +1645,23 @@ void ecs_merge(
     world->is_merging = false;
 }
 
+void ecs_set_table_gc(
+    ecs_world_t *world,
+    uint32_t frames)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    world->gc_frames = frames;
+}
+
+void ecs_gc(
+    ecs_world_t *world)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+    ecs_assert(!world->is_merging, ECS_INVALID_WHILE_MERGING, NULL);
+    gc_tables(world, true);
+}
+
 void ecs_set_automerge(
     ecs_world_t *world,
     bool auto_merge)
@@ -979,7 +1675,7 @@ void ecs_measure_frame_time(
     bool enable)
 {
     assert(world->magic == ECS_WORLD_MAGIC);
-    if (!world->target_fps || enable) {
+    if ((!world->target_fps && !world->frame_budget) || enable) {
         world->measure_frame_time = enable;
     }
 }
@@ -992,6 +1688,37 @@ void ecs_measure_system_time(
     world->measure_system_time = enable;
 }
 
+void ecs_set_pipelined(
+    ecs_world_t *world,
+    bool enable)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(!world->in_progress, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    if (enable) {
+        start_store_thread(world);
+    } else {
+        stop_store_thread(world);
+    }
+
+    world->pipelined = enable;
+}
+
+void ecs_set_frame_budget(
+    ecs_world_t *world,
+    float budget)
+{
+    assert(world->magic == ECS_WORLD_MAGIC);
+    ecs_assert(budget >= 0, ECS_INVALID_PARAMETERS, NULL);
+
+    /* Budget is measured from the start of the frame */
+    if (budget) {
+        ecs_measure_frame_time(world, true);
+    }
+
+    world->frame_budget = budget;
+}
+
 void ecs_set_target_fps(
     ecs_world_t *world,
     float fps)
@@ -1001,6 +1728,7 @@ void ecs_set_target_fps(
     if (!world->arg_fps) {
         ecs_measure_frame_time(world, true);
         world->target_fps = fps;
+        world->frame_deadline = 0;
     }
 }
 
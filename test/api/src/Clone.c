@@ -355,3 +355,94 @@ void Clone_1_tag_1_component_w_value() {
 
     ecs_fini(world);
 }
+
+void Clone_w_count() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_ENTITY(world, e_1, Position, Velocity, Tag);
+
+    ecs_set(world, e_1, Position, {10, 20});
+    ecs_set(world, e_1, Velocity, {1, 2});
+
+    ecs_entity_t e = ecs_clone_w_count(world, e_1, 7, false);
+    test_assert(e != 0);
+    test_assert(e != e_1);
+
+    int i;
+    for (i = 0; i < 7; i ++) {
+        test_assert(ecs_get_type(world, e + i) == ecs_get_type(world, e_1));
+    }
+
+    /* Handles of clones are not reused */
+    test_int(ecs_new(world, 0), e + 7);
+
+    ecs_fini(world);
+}
+
+void Clone_w_count_w_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_ENTITY(world, e_1, Position, Velocity, Tag);
+
+    ecs_set(world, e_1, Position, {10, 20});
+    ecs_set(world, e_1, Velocity, {1, 2});
+
+    ecs_entity_t e = ecs_clone_w_count(world, e_1, 7, true);
+    test_assert(e != 0);
+
+    int i;
+    for (i = 0; i < 7; i ++) {
+        test_assert(ecs_has(world, e + i, Tag));
+
+        Position *p = ecs_get_ptr(world, e + i, Position);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+
+        Velocity *v = ecs_get_ptr(world, e + i, Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, 1);
+        test_int(v->y, 2);
+    }
+
+    /* Source is not modified */
+    test_int(ecs_get(world, e_1, Position).x, 10);
+
+    ecs_fini(world);
+}
+
+static
+void OnSet_clone(ecs_rows_t *rows) {
+    ProbeSystem(rows);
+}
+
+void Clone_w_count_w_value_on_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_ENTITY(world, e_1, Position);
+
+    ECS_SYSTEM(world, OnSet_clone, EcsOnSet, Position);
+
+    ecs_set(world, e_1, Position, {10, 20});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_entity_t e = ecs_clone_w_count(world, e_1, 50, true);
+
+    /* OnSet systems are invoked once for all clones */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 50);
+    test_int(ctx.e[0], e);
+
+    test_int(ecs_get(world, e + 49, Position).x, 10);
+
+    ecs_fini(world);
+}
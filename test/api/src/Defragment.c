@@ -0,0 +1,215 @@
+#include <include/api.h>
+
+static
+int compare_position(
+    ecs_entity_t e1,
+    void *ptr1,
+    ecs_entity_t e2,
+    void *ptr2)
+{
+    Position *p1 = ptr1;
+    Position *p2 = ptr2;
+    return (p1->x > p2->x) - (p1->x < p2->x);
+}
+
+static
+void Iter(ecs_rows_t *rows) {
+    ProbeSystem(rows);
+}
+
+/* Create entities, and delete some of them so that the last rows are moved to
+ * the front of the table */
+static
+void scramble(
+    ecs_world_t *world,
+    ecs_type_t TPosition,
+    ecs_entity_t *entities,
+    uint32_t count)
+{
+    uint32_t i;
+    for (i = 0; i < count; i ++) {
+        entities[i] = ecs_new(world, Position);
+        ecs_set(world, entities[i], Position, {count - i, entities[i]});
+    }
+
+    for (i = 0; i < count; i += 3) {
+        ecs_delete(world, entities[i]);
+        entities[i] = 0;
+    }
+}
+
+static
+bool query_is_ordered(
+    ecs_query_t *q)
+{
+    ecs_entity_t last = 0;
+    ecs_query_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        uint32_t i;
+        for (i = 0; i < it.rows.count; i ++) {
+            if (it.rows.entities[i] < last) {
+                return false;
+            }
+            last = it.rows.entities[i];
+        }
+    }
+
+    return true;
+}
+
+void Defragment_entity_order() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t entities[10];
+    scramble(world, TPosition, entities, 10);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(!query_is_ordered(q));
+
+    test_assert(ecs_defragment(world, 0) != 0);
+    test_assert(query_is_ordered(q));
+
+    /* Entity index points to the moved rows */
+    uint32_t i;
+    for (i = 0; i < 10; i ++) {
+        if (entities[i]) {
+            Position *p = ecs_get_ptr(world, entities[i], Position);
+            test_assert(p != NULL);
+            test_int(p->y, entities[i]);
+        }
+    }
+
+    /* Tables are in order, nothing to do */
+    test_int(ecs_defragment(world, 0), 0);
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
+
+void Defragment_order_by_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_defragment_order(world, Position, compare_position);
+
+    ecs_entity_t entities[10];
+    scramble(world, TPosition, entities, 10);
+
+    ecs_defragment(world, 0);
+
+    float last = 0;
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it.rows, Position, 1);
+        uint32_t i;
+        for (i = 0; i < it.rows.count; i ++) {
+            test_assert(p[i].x > last);
+            test_int(p[i].y, it.rows.entities[i]);
+            last = p[i].x;
+        }
+    }
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
+
+void Defragment_w_sorted_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_order_by(world, Iter, Position, compare_position);
+
+    ecs_entity_t entities[6];
+    scramble(world, TPosition, entities, 6);
+
+    ecs_progress(world, 1);
+
+    /* Rows are ordered by the system, which is not undone */
+    test_int(ecs_defragment(world, 0), 0);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 4);
+    test_int(ctx.e[0], entities[5]);
+    test_int(ctx.e[1], entities[4]);
+    test_int(ctx.e[2], entities[2]);
+    test_int(ctx.e[3], entities[1]);
+
+    ecs_fini(world);
+}
+
+void Defragment_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_defragment(world, 1);
+
+    ecs_entity_t entities[10];
+    scramble(world, TPosition, entities, 10);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(!query_is_ordered(q));
+
+    ecs_progress(world, 1);
+    test_assert(query_is_ordered(q));
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
+
+void Defragment_unset_order_by() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_order_by(world, Iter, Position, compare_position);
+
+    ecs_entity_t entities[6];
+    scramble(world, TPosition, entities, 6);
+
+    ecs_progress(world, 1);
+    test_int(ecs_defragment(world, 0), 0);
+
+    /* Rows are no longer ordered by a system, so they can be defragmented */
+    _ecs_set_order_by(world, Iter, 0, NULL);
+    test_assert(ecs_defragment(world, 0) != 0);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(query_is_ordered(q));
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
+
+void Defragment_free_sorted_query() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t entities[6];
+    scramble(world, TPosition, entities, 6);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by(q, Position, compare_position);
+    ecs_query_iter(q);
+
+    test_int(ecs_defragment(world, 0), 0);
+
+    ecs_query_free(q);
+    test_assert(ecs_defragment(world, 0) != 0);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,196 @@
+#include <include/api.h>
+
+static
+void Iter(ecs_rows_t *rows) {
+    Position *p = ecs_column(rows, Position, 1);
+
+    ProbeSystem(rows);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+void Disable(ecs_rows_t *rows) {
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_enable_entity(rows->world, rows->entities[i], false);
+        test_assert(!ecs_is_entity_enabled(rows->world, rows->entities[i]));
+    }
+}
+
+void EnableEntity_disable() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_enable_entity(world, e_2, false);
+    test_assert(ecs_is_entity_enabled(world, e_1));
+    test_assert(!ecs_is_entity_enabled(world, e_2));
+    test_assert(ecs_is_entity_enabled(world, e_3));
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 2);
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_3);
+
+    test_int(ecs_get(world, e_1, Position).x, 1);
+    test_int(ecs_get(world, e_2, Position).x, 0);
+    test_int(ecs_get(world, e_3, Position).x, 1);
+
+    ecs_fini(world);
+}
+
+void EnableEntity_enable() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_enable_entity(world, e_1, false);
+    ecs_enable_entity(world, e_1, true);
+    test_assert(ecs_is_entity_enabled(world, e_1));
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+
+    ecs_fini(world);
+}
+
+void EnableEntity_disable_all() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e = ecs_new_w_count(world, Position, 40);
+    test_assert(e != 0);
+
+    int i;
+    for (i = 0; i < 40; i ++) {
+        ecs_enable_entity(world, e + i, false);
+    }
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 0);
+    test_int(ctx.count, 0);
+
+    ecs_enable_entity(world, e + 35, true);
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.e[0], e + 35);
+
+    ecs_fini(world);
+}
+
+void EnableEntity_disable_after_add() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_enable_entity(world, e_1, false);
+    ecs_add(world, e_1, Velocity);
+    test_assert(!ecs_is_entity_enabled(world, e_1));
+
+    ecs_remove(world, e_1, Velocity);
+    test_assert(!ecs_is_entity_enabled(world, e_1));
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.e[0], e_2);
+
+    ecs_fini(world);
+}
+
+void EnableEntity_delete_disabled() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {0, 0});
+
+    /* Deleting e_1 moves e_3 into its row, which must remain disabled */
+    ecs_enable_entity(world, e_3, false);
+    ecs_delete(world, e_1);
+    test_assert(!ecs_is_entity_enabled(world, e_3));
+    test_assert(ecs_is_entity_enabled(world, e_2));
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.e[0], e_2);
+
+    ecs_fini(world);
+}
+
+void EnableEntity_disable_in_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Disable, EcsPreUpdate, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {0, 0});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    /* Disabling is staged, and applied when the stage is merged after the
+     * PreUpdate phase */
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 0);
+    test_int(ctx.count, 0);
+    test_assert(!ecs_is_entity_enabled(world, e_1));
+    test_assert(!ecs_is_entity_enabled(world, e_2));
+    test_int(ecs_get(world, e_1, Position).x, 0);
+    test_int(ecs_get(world, e_2, Position).x, 0);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,130 @@
+#include <include/api.h>
+
+static
+void Slow(ecs_rows_t *rows) {
+    ecs_sleepf(0.005);
+}
+
+static
+void Iter(ecs_rows_t *rows) {
+    ProbeSystem(rows);
+}
+
+void FrameBudget_skip_deferrable() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Slow, EcsOnLoad, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_deferrable(world, Iter, true);
+    ecs_set_frame_budget(world, 0.001);
+
+    ecs_new(world, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    /* Without a budget the system runs again */
+    ecs_set_frame_budget(world, 0);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 1);
+
+    ecs_fini(world);
+}
+
+void FrameBudget_run_mandatory() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Slow, EcsOnLoad, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_frame_budget(world, 0.001);
+
+    ecs_new(world, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 1);
+
+    ecs_fini(world);
+}
+
+void FrameBudget_skip_deferrable_w_threads() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Slow, EcsOnLoad, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_deferrable(world, Iter, true);
+    ecs_set_frame_budget(world, 0.001);
+    ecs_set_threads(world, 2);
+
+    ecs_new(world, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 0);
+
+    ecs_set_frame_budget(world, 1);
+
+    ecs_progress(world, 1);
+    test_int(ctx.invoked, 1);
+
+    ecs_fini(world);
+}
+
+void FrameBudget_target_fps() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_set_target_fps(world, 100);
+
+    ecs_time_t t;
+    ecs_os_get_time(&t);
+
+    int i;
+    for (i = 0; i < 3; i ++) {
+        ecs_progress(world, 0);
+    }
+
+    /* The first frame starts when ecs_progress is first called, so the wait
+     * covers at least the first two frames */
+    test_assert(ecs_time_measure(&t) >= 0.02);
+
+    ecs_fini(world);
+}
+
+void FrameBudget_target_fps_w_app_time() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_set_target_fps(world, 100);
+
+    ecs_progress(world, 0);
+
+    ecs_time_t t;
+    ecs_os_get_time(&t);
+
+    /* Time spent in between frames counts towards the frame, so frames don't
+     * take the period plus the time of the application */
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_sleepf(0.005);
+        ecs_progress(world, 0);
+    }
+
+    double elapsed = ecs_time_measure(&t);
+    test_assert(elapsed >= 0.09);
+    test_assert(elapsed < 0.14);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,403 @@
+#include <include/api.h>
+
+static
+void Iter_container(ecs_rows_t *rows) {
+    Mass *m_ptr = ecs_shared_test(rows, Mass, 1);
+    Position *p = ecs_column(rows, Position, 2);
+
+    ProbeSystem(rows);
+
+    test_assert(m_ptr != NULL);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x += *m_ptr;
+    }
+}
+
+static
+void Iter_cascade(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+    ECS_SHARED_TEST(rows, Position, p_parent, 2);
+
+    ProbeSystem(rows);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x ++;
+        p[i].y ++;
+
+        if (p_parent) {
+            p[i].x += p_parent->x;
+            p[i].y += p_parent->y;
+        }
+    }
+}
+
+static
+void Clone(ecs_rows_t *rows) {
+    ecs_entity_t *clone = ecs_get_context(rows->world);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        *clone = ecs_clone(rows->world, rows->entities[i], true);
+    }
+}
+
+void Hierarchy_set_parent() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child_1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t child_2 = ecs_set(world, 0, Position, {30, 40});
+
+    ecs_set_parent(world, child_1, parent);
+    ecs_set_parent(world, child_2, parent);
+
+    test_int(ecs_parent_of(world, child_1), parent);
+    test_int(ecs_parent_of(world, child_2), parent);
+    test_int(ecs_parent_of(world, parent), 0);
+
+    uint32_t count;
+    ecs_entity_t *children = ecs_children_of(world, parent, &count);
+    test_int(count, 2);
+    test_int(children[0], child_1);
+    test_int(children[1], child_2);
+
+    test_assert(ecs_has(world, child_1, Position));
+    test_int(ecs_get(world, child_1, Position).x, 10);
+    test_int(ecs_get(world, child_2, Position).x, 30);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_children_share_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t parent_2 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t child_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t child_2 = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_set_parent(world, child_1, parent_1);
+    ecs_set_parent(world, child_2, parent_2);
+
+    /* Parent is not part of the type, so children of different parents are
+     * stored in the same table */
+    test_assert(ecs_get_type(world, child_1) == ecs_get_type(world, child_2));
+    test_assert(!ecs_contains(world, parent_1, child_1));
+
+    ecs_fini(world);
+}
+
+void Hierarchy_change_parent() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t parent_1 = ecs_new(world, 0);
+    ecs_entity_t parent_2 = ecs_new(world, 0);
+    ecs_entity_t child = ecs_new(world, 0);
+
+    ecs_set_parent(world, child, parent_1);
+    ecs_set_parent(world, child, parent_2);
+
+    test_int(ecs_parent_of(world, child), parent_2);
+
+    uint32_t count;
+    test_assert(ecs_children_of(world, parent_1, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_entity_t *children = ecs_children_of(world, parent_2, &count);
+    test_int(count, 1);
+    test_int(children[0], child);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_remove_parent() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_set_parent(world, child, parent);
+    ecs_set_parent(world, child, 0);
+
+    test_int(ecs_parent_of(world, child), 0);
+    test_assert(ecs_get_type(world, child) == ecs_to_type(Position));
+
+    uint32_t count;
+    test_assert(ecs_children_of(world, parent, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_delete_child() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child_1 = ecs_new(world, 0);
+    ecs_entity_t child_2 = ecs_new(world, 0);
+
+    ecs_set_parent(world, child_1, parent);
+    ecs_set_parent(world, child_2, parent);
+
+    ecs_delete(world, child_1);
+
+    uint32_t count;
+    ecs_entity_t *children = ecs_children_of(world, parent, &count);
+    test_int(count, 1);
+    test_int(children[0], child_2);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_delete_parent() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t child_1 = ecs_new(world, 0);
+    ecs_entity_t child_2 = ecs_new(world, 0);
+
+    ecs_set_parent(world, child_1, parent);
+    ecs_set_parent(world, child_2, parent);
+
+    ecs_delete(world, parent);
+
+    test_int(ecs_parent_of(world, child_1), 0);
+    test_int(ecs_parent_of(world, child_2), 0);
+
+    uint32_t count;
+    test_assert(ecs_children_of(world, parent, &count) == NULL);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_delete_parent_wo_components() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child = ecs_new(world, 0);
+
+    ecs_set_parent(world, child, parent);
+
+    ecs_delete(world, parent);
+
+    test_int(ecs_parent_of(world, child), 0);
+
+    uint32_t count;
+    test_assert(ecs_children_of(world, parent, &count) == NULL);
+    test_int(count, 0);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_clone_child() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_set_parent(world, child, parent);
+
+    ecs_entity_t clone_1 = ecs_clone(world, child, false);
+    ecs_entity_t clone_2 = ecs_clone(world, child, true);
+
+    test_int(ecs_parent_of(world, clone_1), parent);
+    test_int(ecs_parent_of(world, clone_2), parent);
+
+    uint32_t count;
+    ecs_children_of(world, parent, &count);
+    test_int(count, 3);
+
+    ecs_delete(world, parent);
+
+    test_int(ecs_parent_of(world, child), 0);
+    test_int(ecs_parent_of(world, clone_1), 0);
+    test_int(ecs_parent_of(world, clone_2), 0);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_clone_child_w_count() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_set_parent(world, child, parent);
+
+    ecs_entity_t clones = ecs_clone_w_count(world, child, 2, false);
+    test_assert(clones != 0);
+
+    test_int(ecs_parent_of(world, clones), parent);
+    test_int(ecs_parent_of(world, clones + 1), parent);
+
+    uint32_t count;
+    ecs_children_of(world, parent, &count);
+    test_int(count, 3);
+
+    ecs_delete(world, parent);
+
+    test_int(ecs_parent_of(world, clones), 0);
+    test_int(ecs_parent_of(world, clones + 1), 0);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_clone_child_in_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Clone, EcsManual, Position);
+
+    ecs_entity_t parent = ecs_new(world, 0);
+    ecs_entity_t child = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_set_parent(world, child, parent);
+
+    ecs_entity_t clone = 0;
+    ecs_set_context(world, &clone);
+
+    /* Clone is added to the children of the parent when it is merged */
+    ecs_run(world, Clone, 1, NULL);
+    test_assert(clone != 0);
+    test_int(ecs_parent_of(world, clone), parent);
+
+    uint32_t count;
+    ecs_children_of(world, parent, &count);
+    test_int(count, 2);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_container_column() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_SYSTEM(world, Iter_container, EcsOnUpdate, CONTAINER.Mass, Position);
+
+    ecs_entity_t parent_1 = ecs_set(world, 0, Mass, {2});
+    ecs_entity_t parent_2 = ecs_set(world, 0, Mass, {3});
+    ecs_entity_t parent_3 = ecs_set(world, 0, Velocity, {0, 0});
+
+    /* Interleave children of different parents */
+    ecs_entity_t child_1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t child_2 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t child_3 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t child_4 = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_set_parent(world, child_1, parent_1);
+    ecs_set_parent(world, child_2, parent_2);
+    ecs_set_parent(world, child_3, parent_1);
+    ecs_set_parent(world, child_4, parent_3);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    /* Invoked once for each parent that has Mass */
+    test_int(ctx.count, 3);
+    test_int(ctx.invoked, 2);
+    test_int(ctx.s[0][0], parent_1);
+    test_int(ctx.s[1][0], parent_2);
+
+    test_int(ecs_get(world, child_1, Position).x, 2);
+    test_int(ecs_get(world, child_2, Position).x, 3);
+    test_int(ecs_get(world, child_3, Position).x, 2);
+    test_int(ecs_get(world, child_4, Position).x, 0);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_cascade() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Iter_cascade, EcsOnUpdate, Position, CASCADE.Position);
+
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {1, 2});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {1, 2});
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {1, 2});
+
+    /* Insert grandchild in table before child */
+    ecs_set_parent(world, e_3, e_2);
+    ecs_set_parent(world, e_2, e_1);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 3);
+    test_int(ctx.invoked, 3);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+    test_int(ctx.e[2], e_3);
+
+    Position *p = ecs_get_ptr(world, e_1, Position);
+    test_int(p->x, 2);
+    test_int(p->y, 3);
+
+    p = ecs_get_ptr(world, e_2, Position);
+    test_int(p->x, 4);
+    test_int(p->y, 6);
+
+    p = ecs_get_ptr(world, e_3, Position);
+    test_int(p->x, 6);
+    test_int(p->y, 9);
+
+    ecs_fini(world);
+}
+
+void Hierarchy_sort_keeps_data() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_SYSTEM(world, Iter_container, EcsOnUpdate, CONTAINER.Mass, Position);
+
+    ecs_entity_t parent_1 = ecs_set(world, 0, Mass, {1});
+    ecs_entity_t parent_2 = ecs_set(world, 0, Mass, {1});
+
+    ecs_entity_t e[6];
+    int i;
+    for (i = 0; i < 6; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i * 10, i});
+        ecs_set_parent(world, e[i], i % 2 ? parent_1 : parent_2);
+    }
+
+    ecs_enable_entity(world, e[3], false);
+
+    ecs_progress(world, 1);
+
+    for (i = 0; i < 6; i ++) {
+        Position *p = ecs_get_ptr(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i * 10 + (i != 3));
+        test_int(p->y, i);
+        test_int(ecs_parent_of(world, e[i]), i % 2 ? parent_1 : parent_2);
+    }
+
+    test_assert(!ecs_is_entity_enabled(world, e[3]));
+
+    ecs_fini(world);
+}
@@ -131,3 +131,89 @@ void Internals_activate_deactivate_activate_other() {
 
     ecs_fini(world);
 }
+
+static
+void Inc(ecs_rows_t *rows) {
+    Position *p = ecs_column(rows, Position, 1);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+void CountAdd(ecs_rows_t *rows) {
+    int *count = ecs_get_context(rows->world);
+    *count += rows->count;
+}
+
+static
+const char *system_names[] = {
+    "S0", "S1", "S2", "S3", "S4", "S5", "S6", "S7",
+    "S8", "S9", "S10", "S11", "S12", "S13", "S14", "S15"
+};
+
+void Internals_systems_move_in_storage() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t system = ecs_new_system(
+        world, "Inc", EcsOnUpdate, "Position", Inc);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_progress(world, 1);
+    test_int(ecs_get(world, e, Position).x, 1);
+
+    /* Adding systems grows the table that stores the system data */
+    int i;
+    for (i = 0; i < 16; i ++) {
+        ecs_new_system(world, system_names[i], EcsOnUpdate, "Position", Inc);
+    }
+
+    ecs_progress(world, 1);
+    test_int(ecs_get(world, e, Position).x, 18);
+
+    /* Adding a component to a system moves it to another table, and moves the
+     * last system of the table into its row */
+    ecs_add(world, system, Tag);
+
+    ecs_progress(world, 1);
+    test_int(ecs_get(world, e, Position).x, 35);
+
+    ecs_fini(world);
+}
+
+void Internals_row_systems_move_in_storage() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t system = ecs_new_system(
+        world, "CountAdd", EcsOnAdd, "Position", CountAdd);
+
+    int count = 0;
+    ecs_set_context(world, &count);
+
+    ecs_new(world, Position);
+    test_int(count, 1);
+
+    int i;
+    for (i = 0; i < 16; i ++) {
+        ecs_new_system(world, system_names[i], EcsOnAdd, "Position", CountAdd);
+    }
+
+    ecs_new(world, Position);
+    test_int(count, 18);
+
+    ecs_add(world, system, Tag);
+
+    ecs_new(world, Position);
+    test_int(count, 35);
+
+    ecs_fini(world);
+}
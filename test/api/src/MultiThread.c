@@ -930,3 +930,552 @@ void MultiThread_6_thread_test_combs_100_entity_2_types() {
 
     ecs_fini(world);
 }
+
+static
+void Cascade(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+    ECS_SHARED_TEST(rows, Position, p_parent, 2);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x = 1;
+        if (p_parent) {
+            p[i].x += p_parent->x;
+        }
+    }
+}
+
+void MultiThread_4_thread_cascade_parent_column() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Cascade, EcsOnUpdate, Position, CASCADE.Position);
+
+    int i, j, ROOTS = 10, CHILDREN = 5;
+    ecs_entity_t roots[10], children[10][5], grandchildren[10][5];
+
+    /* Create grandchildren first, so that rows of deeper levels are stored
+     * before rows of their parents */
+    for (i = 0; i < ROOTS; i ++) {
+        for (j = 0; j < CHILDREN; j ++) {
+            grandchildren[i][j] = ecs_set(world, 0, Position, {0, 0});
+        }
+    }
+
+    for (i = 0; i < ROOTS; i ++) {
+        roots[i] = ecs_set(world, 0, Position, {0, 0});
+        for (j = 0; j < CHILDREN; j ++) {
+            children[i][j] = ecs_set(world, 0, Position, {0, 0});
+            ecs_set_parent(world, children[i][j], roots[i]);
+            ecs_set_parent(world, grandchildren[i][j], children[i][j]);
+        }
+    }
+
+    ecs_set_threads(world, 4);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ROOTS; i ++) {
+        test_int(ecs_get(world, roots[i], Position).x, 1);
+        for (j = 0; j < CHILDREN; j ++) {
+            test_int(ecs_get(world, children[i][j], Position).x, 2);
+            test_int(ecs_get(world, grandchildren[i][j], Position).x, 3);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_cascade_container() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Cascade, EcsOnUpdate, Position, CASCADE.Position);
+
+    ecs_entity_t root = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t child = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t grandchild = ecs_set(world, 0, Position, {0, 0});
+
+    ecs_adopt(world, child, root);
+    ecs_adopt(world, grandchild, child);
+
+    /* Add more entities to each level so every level is split over threads */
+    ecs_entity_t e[3][4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[2][i] = ecs_set(world, 0, Position, {0, 0});
+        ecs_adopt(world, e[2][i], child);
+        e[1][i] = ecs_set(world, 0, Position, {0, 0});
+        ecs_adopt(world, e[1][i], root);
+        e[0][i] = ecs_set(world, 0, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 4);
+    ecs_progress(world, 0);
+
+    test_int(ecs_get(world, root, Position).x, 1);
+    test_int(ecs_get(world, child, Position).x, 2);
+    test_int(ecs_get(world, grandchild, Position).x, 3);
+
+    for (i = 0; i < 4; i ++) {
+        test_int(ecs_get(world, e[0][i], Position).x, 1);
+        test_int(ecs_get(world, e[1][i], Position).x, 2);
+        test_int(ecs_get(world, e[2][i], Position).x, 3);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_add_after_schedule() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    ecs_entity_t e = ecs_new_w_count(world, Position, 100);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 4);
+    ecs_progress(world, 0);
+
+    /* The schedule is not recomputed for a small number of new rows, but the
+     * new rows must still be processed. A new table does cause a reschedule. */
+    ecs_entity_t e_2 = ecs_new_w_count(world, Position, 3);
+    ecs_entity_t e_3 = ecs_new_w_count(world, Position, 2);
+    ecs_add(world, e_3, Velocity);
+    ecs_add(world, e_3 + 1, Velocity);
+
+    for (i = 0; i < 3; i ++) {
+        ecs_set(world, e_2 + i, Position, {0, 0});
+    }
+
+    for (i = 0; i < 2; i ++) {
+        ecs_set(world, e_3 + i, Position, {0, 0});
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < 100; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 2);
+    }
+
+    for (i = 0; i < 3; i ++) {
+        test_int(ecs_get(world, e_2 + i, Position).x, 1);
+    }
+
+    for (i = 0; i < 2; i ++) {
+        test_int(ecs_get(world, e_3 + i, Position).x, 1);
+    }
+
+    /* Adding many rows redistributes the rows over the jobs */
+    ecs_entity_t e_4 = ecs_new_w_count(world, Position, 200);
+    for (i = 0; i < 200; i ++) {
+        ecs_set(world, e_4 + i, Position, {0, 0});
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < 100; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 3);
+    }
+
+    for (i = 0; i < 200; i ++) {
+        test_int(ecs_get(world, e_4 + i, Position).x, 1);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_delete_after_schedule() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    ecs_entity_t e = ecs_new_w_count(world, Position, 100);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 4);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < 100; i += 20) {
+        ecs_delete(world, e + i);
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < 100; i ++) {
+        if (i % 20) {
+            test_int(ecs_get(world, e + i, Position).x, 2);
+        } else {
+            test_assert(!ecs_has(world, e + i, Position));
+        }
+    }
+
+    ecs_fini(world);
+}
+
+static
+void ProgressSlow(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+    Velocity *v = ecs_column_test(rows, Velocity, 2);
+
+    int row;
+    for (row = 0; row < rows->count; row ++) {
+        /* Rows with a velocity are much more expensive than rows without */
+        if (v) {
+            volatile int i, sum = 0;
+            for (i = 0; i < 10000; i ++) {
+                sum += i;
+            }
+        }
+
+        p[row].x ++;
+    }
+}
+
+void MultiThread_4_thread_cost_schedule() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, ProgressSlow, EcsOnUpdate, Position, ?Velocity);
+
+    ecs_entity_t e_1 = ecs_new_w_count(world, Position, 100);
+    ecs_entity_t e_2 = ecs_new_w_count(world, Position, 10);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, e_1 + i, Position, {0, 0});
+    }
+
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, e_2 + i, Position, {0, 0});
+        ecs_set(world, e_2 + i, Velocity, {0, 0});
+    }
+
+    ecs_measure_system_time(world, true);
+    ecs_set_threads(world, 4);
+
+    /* Run enough frames for the jobs to be recreated with measured costs */
+    int f, FRAMES = 40;
+    for (f = 0; f < FRAMES; f ++) {
+        ecs_progress(world, 0);
+    }
+
+    for (i = 0; i < 100; i ++) {
+        test_int(ecs_get(world, e_1 + i, Position).x, FRAMES);
+    }
+
+    for (i = 0; i < 10; i ++) {
+        test_int(ecs_get(world, e_2 + i, Position).x, FRAMES);
+    }
+
+    ecs_world_stats_t stats = {0};
+    ecs_get_stats(world, &stats);
+    test_assert(stats.on_update_imbalance >= 1);
+    test_assert(stats.pre_update_imbalance == 0);
+    ecs_free_stats(&stats);
+
+    ecs_fini(world);
+}
+
+static
+void AddVelocity(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+    ECS_COLUMN_COMPONENT(rows, Velocity, 2);
+
+    int *param = rows->param;
+
+    int row;
+    for (row = 0; row < rows->count; row ++) {
+        p[row].x += *param;
+        ecs_set(rows->world, rows->entities[row], Velocity, {p[row].x, 0});
+    }
+}
+
+void MultiThread_4_thread_async() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, AddVelocity, EcsManual, Position, ID.Velocity);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t e = ecs_new_w_count(world, Position, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, e + i, Position, {i, 0});
+    }
+
+    ecs_set_threads(world, 4);
+
+    int param = 10;
+    ecs_async_t handle = ecs_run_async(world, AddVelocity, 1, &param);
+    ecs_async_wait(world, handle);
+    test_assert(ecs_async_done(world, handle));
+
+    /* Components set by the workers are merged by ecs_async_wait */
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, i + 10);
+        test_assert(ecs_has(world, e + i, Velocity));
+        test_int(ecs_get(world, e + i, Velocity).x, i + 10);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_async_w_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, AddVelocity, EcsManual, Position, ID.Velocity);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t e = ecs_new_w_count(world, Position, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 4);
+
+    /* ecs_progress waits for the async system before running its phases */
+    int param = 1;
+    ecs_run_async(world, AddVelocity, 1, &param);
+    ecs_progress(world, 1);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 2);
+        test_assert(ecs_has(world, e + i, Velocity));
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_async_no_threads() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, AddVelocity, EcsManual, Position, ID.Velocity);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+
+    int param = 5;
+    ecs_async_t handle = ecs_run_async(world, AddVelocity, 1, &param);
+    test_assert(ecs_async_done(world, handle));
+    ecs_async_wait(world, handle);
+
+    test_int(ecs_get(world, e, Position).x, 5);
+    test_int(ecs_get(world, e, Velocity).x, 5);
+
+    ecs_fini(world);
+}
+
+static
+void SubmitInline(
+    ecs_world_t *world,
+    uint32_t thread_count,
+    void *ctx)
+{
+    int *submitted = ctx;
+    (*submitted) ++;
+
+    /* Run threads in reverse order to check they don't depend on each other */
+    int i;
+    for (i = thread_count - 1; i >= 0; i --) {
+        ecs_run_scheduled(world, i);
+    }
+}
+
+void MultiThread_external_scheduler() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, AddVelocity, EcsManual, Position, ID.Velocity);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t e = ecs_new_w_count(world, Position, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    int submitted = 0;
+    ecs_set_scheduler(world, 4, &(ecs_scheduler_t){
+        .submit = SubmitInline,
+        .ctx = &submitted
+    });
+
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+    test_int(submitted, 2);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 2);
+    }
+
+    /* Changes written to the stages of the scheduler threads are merged */
+    int param = 1;
+    ecs_async_wait(world, ecs_run_async(world, AddVelocity, 1, &param));
+    test_int(submitted, 3);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 3);
+        test_assert(ecs_has(world, e + i, Velocity));
+    }
+
+    ecs_fini(world);
+}
+
+typedef struct SchedulerThreads {
+    ecs_world_t *world;
+    uint32_t index;
+    ecs_os_thread_t thread;
+} SchedulerThreads;
+
+static SchedulerThreads scheduler_threads[4];
+
+static
+void* RunScheduled(void *arg) {
+    SchedulerThreads *thr = arg;
+    ecs_run_scheduled(thr->world, thr->index);
+    return NULL;
+}
+
+static
+void SubmitThreads(
+    ecs_world_t *world,
+    uint32_t thread_count,
+    void *ctx)
+{
+    uint32_t i;
+    for (i = 0; i < thread_count; i ++) {
+        scheduler_threads[i].world = world;
+        scheduler_threads[i].index = i;
+        scheduler_threads[i].thread = ecs_os_thread_new(
+            RunScheduled, &scheduler_threads[i]);
+    }
+}
+
+static
+void WaitThreads(
+    ecs_world_t *world,
+    void *ctx)
+{
+    int i;
+    for (i = 0; i < 4; i ++) {
+        ecs_os_thread_join(scheduler_threads[i].thread);
+    }
+}
+
+void MultiThread_external_scheduler_threads() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t e = ecs_new_w_count(world, Position, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    ecs_set_scheduler(world, 4, &(ecs_scheduler_t){
+        .submit = SubmitThreads,
+        .wait = WaitThreads
+    });
+
+    int f;
+    for (f = 0; f < 10; f ++) {
+        ecs_progress(world, 1);
+    }
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 10);
+    }
+
+    /* Removing the scheduler runs jobs on the main thread again */
+    ecs_set_scheduler(world, 0, NULL);
+    ecs_progress(world, 1);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 11);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_resize_threads() {
+    ecs_world_t *world = ecs_init();
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, AddVelocity, EcsManual, Position, ID.Velocity);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t e = ecs_new_w_count(world, Position, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    /* Grow, shrink, park all threads and reuse parked threads */
+    int threads[] = {4, 2, 8, 0, 3, 8};
+    int t, THREAD_COUNTS = sizeof(threads) / sizeof(int);
+
+    for (t = 0; t < THREAD_COUNTS; t ++) {
+        ecs_set_threads(world, threads[t]);
+        ecs_progress(world, 1);
+
+        for (i = 0; i < ENTITIES; i ++) {
+            test_int(ecs_get(world, e + i, Position).x, t + 1);
+        }
+    }
+
+    /* Stages of threads added after the pool grew are merged */
+    int param = 1;
+    ecs_async_wait(world, ecs_run_async(world, AddVelocity, 1, &param));
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, THREAD_COUNTS + 1);
+        test_assert(ecs_has(world, e + i, Velocity));
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_4_thread_async_keeps_schedule() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Progress, EcsOnUpdate, Position);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t e = ecs_new_w_count(world, Position, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    ecs_set_threads(world, 4);
+    ecs_progress(world, 1);
+
+    /* The async run splits rows over the workers only, which must not replace
+     * the jobs that ecs_progress keeps for the system */
+    ecs_async_wait(world, ecs_run_async(world, Progress, 1, NULL));
+
+    ecs_progress(world, 1);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, e + i, Position).x, 3);
+    }
+
+    ecs_fini(world);
+}
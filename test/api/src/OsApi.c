@@ -0,0 +1,130 @@
+#include <include/api.h>
+
+typedef struct Large {
+    char value[4096];
+} Large;
+
+static bool advise_worker[4];
+static size_t advise_size[4];
+
+static
+void advise_large(
+    void *ptr,
+    size_t size,
+    uint32_t worker)
+{
+    test_assert(ptr != NULL);
+    test_assert(worker < 4);
+    advise_worker[worker] = true;
+    advise_size[worker] = size;
+}
+
+static
+void set_advise_hook(void)
+{
+    ecs_set_os_api_defaults();
+    ecs_os_api_t os_api = ecs_os_api;
+    os_api.advise_large = advise_large;
+    ecs_set_os_api(&os_api);
+
+    memset(advise_worker, 0, sizeof(advise_worker));
+    memset(advise_size, 0, sizeof(advise_size));
+}
+
+void OsApi_advise_large_column() {
+    set_advise_hook();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Large);
+
+    ecs_entity_t e = ecs_new_w_count(world, Large, 1000);
+    test_assert(e != 0);
+
+    /* Columns of the main stage are owned by the main thread */
+    test_assert(advise_worker[0]);
+    test_assert(advise_size[0] >= 1000 * sizeof(Large));
+
+    ecs_fini(world);
+}
+
+void OsApi_advise_small_column() {
+    set_advise_hook();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new_w_count(world, Position, 1000);
+    test_assert(e != 0);
+
+    test_assert(!advise_worker[0]);
+
+    ecs_fini(world);
+}
+
+static
+void AddLarge(ecs_rows_t *rows) {
+    ECS_COLUMN_COMPONENT(rows, Large, 2);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_add(rows->world, rows->entities[i], Large);
+    }
+}
+
+void OsApi_advise_large_column_worker() {
+    set_advise_hook();
+
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Large);
+
+    ECS_SYSTEM(world, AddLarge, EcsOnUpdate, Position, ID.Large);
+
+    ecs_new_w_count(world, Position, 2000);
+
+    ecs_set_threads(world, 3);
+
+    ecs_progress(world, 1);
+
+    /* Columns of a worker stage are passed with the index of the worker */
+    test_assert(advise_worker[1]);
+    test_assert(advise_worker[2]);
+    test_assert(!advise_worker[3]);
+
+    ecs_fini(world);
+}
+
+static int affinity_invoked = 0;
+static uint32_t affinity_index[8];
+
+static
+void thread_affinity(
+    ecs_os_thread_t thread,
+    uint32_t index)
+{
+    test_assert(thread != 0);
+    affinity_index[affinity_invoked] = index;
+    affinity_invoked ++;
+}
+
+void OsApi_thread_affinity() {
+    ecs_set_os_api_defaults();
+    ecs_os_api_t os_api = ecs_os_api;
+    os_api.thread_affinity = thread_affinity;
+    ecs_set_os_api(&os_api);
+
+    ecs_world_t *world = ecs_init();
+
+    ecs_set_threads(world, 4);
+
+    /* Main thread is not pinned, only the workers */
+    test_int(affinity_invoked, 3);
+    test_int(affinity_index[0], 1);
+    test_int(affinity_index[1], 2);
+    test_int(affinity_index[2], 3);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,148 @@
+#include <include/api.h>
+
+typedef struct StoreData {
+    uint32_t invoked;
+    uint32_t count;
+    float x[16];
+    float v;
+} StoreData;
+
+static
+void Move(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+void Store(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+    StoreData *data = ecs_get_context(rows->world);
+
+    data->invoked ++;
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        data->x[data->count ++] = p[i].x;
+    }
+}
+
+static
+void StoreShared(ecs_rows_t *rows) {
+    ECS_SHARED(rows, Velocity, v, 2);
+    StoreData *data = ecs_get_context(rows->world);
+    data->invoked ++;
+    data->v = v->x;
+}
+
+void Pipelined_store_copy() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Move, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, Store, EcsOnStore, Position);
+
+    ecs_set_pipelined(world, true);
+
+    ecs_set(world, 0, Position, {0, 0});
+
+    StoreData data = {0};
+    ecs_set_context(world, &data);
+
+    ecs_progress(world, 1);
+    ecs_progress(world, 1);
+
+    /* Waits for the store thread */
+    ecs_set_pipelined(world, false);
+
+    /* Store of the first frame did not see the changes of the second frame */
+    test_int(data.invoked, 2);
+    test_int(data.count, 2);
+    test_int(data.x[0], 1);
+    test_int(data.x[1], 2);
+
+    ecs_fini(world);
+}
+
+void Pipelined_disabled_rows() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Store, EcsOnStore, Position);
+
+    ecs_set_pipelined(world, true);
+
+    ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e = ecs_set(world, 0, Position, {2, 0});
+    ecs_set(world, 0, Position, {3, 0});
+    ecs_enable_entity(world, e, false);
+
+    StoreData data = {0};
+    ecs_set_context(world, &data);
+
+    ecs_progress(world, 1);
+
+    /* Waits for the store thread */
+    ecs_fini(world);
+
+    test_int(data.count, 2);
+    test_int(data.x[0], 1);
+    test_int(data.x[1], 3);
+}
+
+void Pipelined_shared_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_PREFAB(world, Prefab, Velocity);
+    ECS_SYSTEM(world, StoreShared, EcsOnStore, Position, Velocity);
+
+    ecs_set(world, Prefab, Velocity, {5, 0});
+    ecs_entity_t e = ecs_set(world, 0, Position, {0, 0});
+    ecs_add(world, e, Prefab);
+
+    ecs_set_pipelined(world, true);
+
+    StoreData data = {0};
+    ecs_set_context(world, &data);
+
+    ecs_progress(world, 1);
+
+    /* System reads the value of the prefab when the frame was copied */
+    ecs_set(world, Prefab, Velocity, {6, 0});
+
+    ecs_set_pipelined(world, false);
+
+    test_int(data.invoked, 1);
+    test_int(data.v, 5);
+
+    ecs_fini(world);
+}
+
+void Pipelined_container_on_main_thread() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Store, EcsOnStore, Position, ?CONTAINER.Velocity);
+
+    ecs_set_pipelined(world, true);
+
+    ecs_set(world, 0, Position, {1, 0});
+
+    StoreData data = {0};
+    ecs_set_context(world, &data);
+
+    /* Container columns can't be copied, so the frame is stored on the main
+     * thread before ecs_progress returns */
+    ecs_progress(world, 1);
+
+    test_int(data.invoked, 1);
+    test_int(data.x[0], 1);
+
+    ecs_fini(world);
+}
@@ -1001,3 +1001,128 @@ void Prefab_override_2_components_different_size() {
 
     ecs_fini(world);
 }
+
+void Prefab_get_ptr_after_prefab_moves() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_PREFAB(world, Prefab, Position);
+
+    ecs_set(world, Prefab, Position, {10, 20});
+
+    ecs_entity_t e = ecs_new(world, Prefab);
+    Position *p = ecs_get_ptr(world, e, Position);
+    test_assert(p != NULL);
+    test_assert(p == ecs_get_ptr(world, Prefab, Position));
+
+    /* Prefab moves to another table */
+    ecs_set(world, Prefab, Velocity, {1, 2});
+
+    p = ecs_get_ptr(world, e, Position);
+    test_assert(p != NULL);
+    test_assert(p == ecs_get_ptr(world, Prefab, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    /* Value is shared with the prefab */
+    ecs_set(world, Prefab, Position, {30, 40});
+    test_int(ecs_get(world, e, Position).x, 30);
+    test_int(ecs_get(world, e, Velocity).x, 1);
+
+    /* Component is no longer shared when prefab is deleted */
+    ecs_delete(world, Prefab);
+    test_assert(ecs_get_ptr(world, e, Position) == NULL);
+
+    ecs_fini(world);
+}
+
+void Prefab_get_ptr_nested_prefab() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_PREFAB(world, Base, Position);
+    ECS_PREFAB(world, Middle, Base, Velocity);
+    ECS_PREFAB(world, Derived, Middle, Mass);
+
+    ecs_set(world, Base, Position, {10, 20});
+    ecs_set(world, Middle, Velocity, {1, 2});
+    ecs_set(world, Derived, Mass, {50});
+
+    ecs_entity_t e_1 = ecs_new(world, Derived);
+    ecs_entity_t e_2 = ecs_new(world, Derived);
+
+    test_assert(ecs_get_ptr(world, e_1, Position) == 
+        ecs_get_ptr(world, Base, Position));
+    test_assert(ecs_get_ptr(world, e_2, Position) == 
+        ecs_get_ptr(world, Base, Position));
+    test_assert(ecs_get_ptr(world, e_1, Velocity) == 
+        ecs_get_ptr(world, Middle, Velocity));
+
+    test_int(ecs_get(world, e_1, Position).x, 10);
+    test_int(ecs_get(world, e_1, Velocity).x, 1);
+    test_int(ecs_get(world, e_1, Mass), 50);
+
+    /* Base prefab moves to another table */
+    ecs_add(world, Base, Mass);
+
+    test_assert(ecs_get_ptr(world, e_1, Position) == 
+        ecs_get_ptr(world, Base, Position));
+    test_int(ecs_get(world, e_2, Position).x, 10);
+
+    ecs_fini(world);
+}
+
+void Prefab_new_w_count_nested_override() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_PREFAB(world, Base, Position, Mass);
+    ECS_PREFAB(world, Derived, Base, Velocity);
+    ECS_TYPE(world, Type, Derived, Position, Velocity, Mass);
+
+    ecs_set(world, Base, Position, {10, 20});
+    ecs_set(world, Base, Mass, {50});
+    ecs_set(world, Derived, Velocity, {1, 2});
+
+    ecs_entity_t e_1 = ecs_new_w_count(world, Type, 37);
+    test_assert(e_1 != 0);
+
+    ecs_entity_t e;
+    for (e = e_1; e < (e_1 + 37); e ++) {
+        Position *p = ecs_get_ptr(world, e, Position);
+        test_assert(p != NULL);
+        test_assert(p != ecs_get_ptr(world, Base, Position));
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+
+        Velocity *v = ecs_get_ptr(world, e, Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, 1);
+        test_int(v->y, 2);
+
+        test_int(ecs_get(world, e, Mass), 50);
+    }
+
+    /* Instances use the current value of the prefab */
+    ecs_set(world, Base, Position, {30, 40});
+
+    e = ecs_new(world, Type);
+    test_int(ecs_get(world, e, Position).x, 30);
+    test_int(ecs_get(world, e, Velocity).x, 1);
+
+    /* Prefab moves to another table */
+    ecs_set(world, Derived, Mass, {60});
+
+    e_1 = ecs_new_w_count(world, Type, 3);
+    for (e = e_1; e < (e_1 + 3); e ++) {
+        test_int(ecs_get(world, e, Position).x, 30);
+        test_int(ecs_get(world, e, Velocity).x, 1);
+    }
+
+    ecs_fini(world);
+}
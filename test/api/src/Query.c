@@ -0,0 +1,143 @@
+#include <include/api.h>
+
+void Query_iter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e_2, Velocity);
+    ecs_new(world, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    test_assert(q != NULL);
+
+    uint32_t count = 0;
+    ecs_query_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it.rows, Position, 1);
+        test_assert(p != NULL);
+
+        int i;
+        for (i = 0; i < it.rows.count; i ++) {
+            test_assert(it.rows.entities[i] == e_1 ||
+                        it.rows.entities[i] == e_2);
+            p[i].x ++;
+            count ++;
+        }
+    }
+
+    test_int(count, 2);
+
+    Position *p = ecs_get_ptr(world, e_1, Position);
+    test_int(p->x, 11);
+    p = ecs_get_ptr(world, e_2, Position);
+    test_int(p->x, 31);
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
+
+void Query_match_new_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, !Mass");
+
+    ecs_query_iter_t it = ecs_query_iter(q);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_entity_t e_1 = ecs_new(world, Position);
+    ecs_entity_t e_2 = ecs_new(world, Position);
+    ecs_add(world, e_2, Velocity);
+    ecs_entity_t e_3 = ecs_new(world, Position);
+    ecs_add(world, e_3, Mass);
+
+    uint32_t count = 0;
+    it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        int i;
+        for (i = 0; i < it.rows.count; i ++) {
+            test_assert(it.rows.entities[i] == e_1 ||
+                        it.rows.entities[i] == e_2);
+            count ++;
+        }
+    }
+
+    test_int(count, 2);
+
+    ecs_fini(world);
+}
+
+void Query_table_gc() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+
+    ecs_entity_t e_1 = ecs_new(world, Position);
+    ecs_entity_t e_2 = ecs_new(world, Velocity);
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, e_3, Mass);
+
+    /* Delete tables that were created before the table of e_3 */
+    ecs_delete(world, e_1);
+    ecs_delete(world, e_2);
+    ecs_gc(world);
+
+    uint32_t count = 0;
+    ecs_query_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it.rows, Position, 1);
+        test_int(it.rows.count, 1);
+        test_assert(it.rows.entities[0] == e_3);
+        test_int(p[0].x, 10);
+        count ++;
+    }
+
+    test_int(count, 1);
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
+
+void Query_shared_from_prefab() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_PREFAB(world, Prefab, Velocity);
+
+    ecs_set(world, Prefab, Velocity, {1, 2});
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, e, Prefab);
+
+    ecs_query_t *q = ecs_query_new(world, "Position, Velocity");
+
+    uint32_t count = 0;
+    ecs_query_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        Velocity *v = ecs_shared(&it.rows, Velocity, 2);
+        test_assert(v != NULL);
+        test_int(v->x, 1);
+        test_int(v->y, 2);
+        count += it.rows.count;
+    }
+
+    test_int(count, 1);
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
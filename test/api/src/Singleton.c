@@ -65,3 +65,204 @@ void Singleton_system_w_singleton() {
     
     ecs_fini(world);
 }
+
+void Singleton_get_not_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    test_assert(ecs_get_singleton_ptr(world, Position) == NULL);
+
+    ecs_set_singleton(world, Velocity, {1, 2});
+    test_assert(ecs_get_singleton_ptr(world, Position) == NULL);
+    test_assert(ecs_get_singleton_ptr(world, Velocity) != NULL);
+
+    ecs_fini(world);
+}
+
+void Singleton_set_twice() {
+    ecs_world_t *world = ecs_init();
+    ecs_set_singleton_slots(world, true);
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_singleton(world, Position, {10, 20});
+    Position *p = ecs_get_singleton_ptr(world, Position);
+    test_assert(p != NULL);
+
+    /* Singleton values don't move when other singletons or entities are set */
+    ecs_set_singleton(world, Velocity, {1, 2});
+    ecs_set(world, 0, Position, {30, 40});
+    ecs_set_singleton(world, Position, {50, 60});
+
+    test_assert(ecs_get_singleton_ptr(world, Position) == p);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+    test_int(ecs_get_singleton(world, Velocity).x, 1);
+
+    ecs_fini(world);
+}
+
+static
+void Set_singleton(ecs_rows_t *rows) {
+    ECS_COLUMN_COMPONENT(rows, Velocity, 2);
+    Velocity *v = ecs_get_singleton_ptr(rows->world, Velocity);
+    Velocity *v_main = ecs_get_context(rows->world);
+
+    if (v) {
+        ecs_set_singleton(rows->world, Velocity, {v->x + 1, v->y + 1});
+    } else {
+        ecs_set_singleton(rows->world, Velocity, {1, 1});
+    }
+
+    /* Value set while in progress is visible to the stage */
+    Velocity *v_staged = ecs_get_singleton_ptr(rows->world, Velocity);
+    test_assert(v_staged != NULL);
+    test_assert(v_staged != v_main || !v_main);
+}
+
+void Singleton_set_in_progress() {
+    ecs_world_t *world = ecs_init();
+    ecs_set_singleton_slots(world, true);
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Set_singleton, EcsOnUpdate, Position, ID.Velocity);
+
+    ecs_set(world, 0, Position, {10, 20});
+
+    ecs_progress(world, 1);
+
+    Velocity *v = ecs_get_singleton_ptr(world, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 1);
+
+    ecs_set_context(world, v);
+
+    ecs_progress(world, 1);
+
+    /* Value is copied to the existing slot when merged */
+    test_assert(ecs_get_singleton_ptr(world, Velocity) == v);
+    test_int(v->x, 2);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+void Singleton_add() {
+    ecs_world_t *world = ecs_init();
+    ecs_set_singleton_slots(world, true);
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_singleton(world, Velocity, {1, 2});
+
+    /* Adding to entity 0 adds singletons, existing values are kept */
+    ECS_TYPE(world, Type, Position, Velocity);
+    ecs_add(world, 0, Type);
+
+    Position *p = ecs_get_singleton_ptr(world, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 0);
+    test_int(p->y, 0);
+    test_int(ecs_get_singleton(world, Velocity).x, 1);
+
+    ecs_fini(world);
+}
+
+void Singleton_has() {
+    ecs_world_t *world = ecs_init();
+    ecs_set_singleton_slots(world, true);
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Position, Velocity);
+
+    test_assert(!ecs_has(world, 0, Position));
+
+    ecs_set_singleton(world, Position, {10, 20});
+
+    test_assert(ecs_has(world, 0, Position));
+    test_assert(!ecs_has(world, 0, Type));
+    test_assert(ecs_has_any(world, 0, Type));
+
+    ecs_fini(world);
+}
+
+static
+void OnSet(ecs_rows_t *rows) {
+    ProbeSystem(rows);
+}
+
+void Singleton_on_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, OnSet, EcsOnSet, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    /* Singletons stored on entity 0 notify systems like other entities */
+    ecs_set_singleton(world, Position, {10, 20});
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.e[0], 0);
+
+    ecs_fini(world);
+}
+
+void Singleton_remove() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_singleton(world, Position, {10, 20});
+    ecs_set_singleton(world, Velocity, {1, 2});
+
+    ECS_TYPE(world, Type, Position, Velocity);
+    test_assert(ecs_get_type(world, 0) == TType);
+
+    ecs_remove(world, 0, Position);
+
+    test_assert(ecs_get_singleton_ptr(world, Position) == NULL);
+    test_assert(ecs_get_type(world, 0) == TVelocity);
+
+    ecs_fini(world);
+}
+
+void Singleton_slots_system_w_singleton() {
+    ecs_world_t *world = ecs_init();
+    ecs_set_singleton_slots(world, true);
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Iter_w_singleton, EcsOnUpdate, Position, $Velocity);
+    ECS_SYSTEM(world, OnSet, EcsOnSet, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    /* Singletons in slots are not stored in a table */
+    ecs_set_singleton(world, Velocity, {1, 2});
+    test_int(ctx.invoked, 0);
+    test_assert(ecs_get_type(world, 0) == 0);
+    test_assert(ecs_has(world, 0, Velocity));
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_progress(world, 1);
+
+    Position *p = ecs_get_ptr(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 11);
+    test_int(p->y, 22);
+
+    ecs_fini(world);
+}
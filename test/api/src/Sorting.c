@@ -0,0 +1,218 @@
+#include <include/api.h>
+
+static
+int compare_position(
+    ecs_entity_t e1,
+    void *ptr1,
+    ecs_entity_t e2,
+    void *ptr2)
+{
+    Position *p1 = ptr1;
+    Position *p2 = ptr2;
+    return (p1->x > p2->x) - (p1->x < p2->x);
+}
+
+static
+void Iter(ecs_rows_t *rows) {
+    ProbeSystem(rows);
+}
+
+void Sorting_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_order_by(world, Iter, Position, compare_position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {4, 0});
+    ecs_entity_t e_4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_add(world, e_3, Velocity);
+    ecs_add(world, e_4, Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 4);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_4);
+    test_int(ctx.e[2], e_1);
+    test_int(ctx.e[3], e_3);
+
+    /* Rows moved, but entities still point to their own data */
+    Position *p = ecs_get_ptr(world, e_1, Position);
+    test_int(p->x, 3);
+    p = ecs_get_ptr(world, e_2, Position);
+    test_int(p->x, 1);
+
+    ecs_fini(world);
+}
+
+void Sorting_system_after_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_order_by(world, Iter, Position, compare_position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {3, 0});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+    test_int(ctx.e[2], e_3);
+
+    ecs_set(world, e_1, Position, {5, 0});
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 3);
+    test_int(ctx.e[0], e_2);
+    test_int(ctx.e[1], e_3);
+    test_int(ctx.e[2], e_1);
+
+    ecs_fini(world);
+}
+
+void Sorting_system_w_disabled() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_order_by(world, Iter, Position, compare_position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {1, 0});
+
+    ecs_enable_entity(world, e_2, false);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_3);
+    test_int(ctx.e[1], e_1);
+
+    ecs_fini(world);
+}
+
+void Sorting_query() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by(q, Position, compare_position);
+
+    int i;
+    for (i = 0; i < 20; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {(i * 7) % 20, 0});
+        if (i % 3) {
+            ecs_add(world, e, Velocity);
+        }
+    }
+
+    float last = -1;
+    uint32_t count = 0;
+    ecs_query_iter_t it = ecs_query_iter(q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it.rows, Position, 1);
+        uint32_t r;
+        for (r = 0; r < it.rows.count; r ++) {
+            test_assert(p[r].x > last);
+            last = p[r].x;
+            count ++;
+        }
+    }
+
+    test_int(count, 20);
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
+
+typedef struct QueryResult {
+    ecs_query_t *q;
+    uint32_t count;
+    bool ordered;
+} QueryResult;
+
+static
+void IterQuery(ecs_rows_t *rows) {
+    QueryResult *result = ecs_get_context(rows->world);
+    float last = -1;
+
+    result->count = 0;
+    result->ordered = true;
+
+    ecs_query_iter_t it = ecs_query_iter(result->q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_column(&it.rows, Position, 1);
+        uint32_t r;
+        for (r = 0; r < it.rows.count; r ++) {
+            if (p[r].x < last) {
+                result->ordered = false;
+            }
+            last = p[r].x;
+            result->count ++;
+        }
+    }
+}
+
+void Sorting_query_in_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, IterQuery, EcsOnUpdate, Velocity);
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_query_order_by(q, Position, compare_position);
+
+    ecs_entity_t entities[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {(i * 7) % 10, 0});
+    }
+
+    ecs_set(world, 0, Velocity, {0, 0});
+
+    QueryResult result = {.q = q};
+    ecs_set_context(world, &result);
+
+    /* Order computed outside of the frame is used by the system */
+    ecs_query_iter(q);
+    ecs_progress(world, 1);
+    test_int(result.count, 10);
+    test_assert(result.ordered);
+
+    /* Order is out of date, rows are not sorted while in progress */
+    ecs_set(world, entities[0], Position, {20, 0});
+    ecs_progress(world, 1);
+    test_int(result.count, 10);
+    test_assert(!result.ordered);
+
+    ecs_query_free(q);
+
+    ecs_fini(world);
+}
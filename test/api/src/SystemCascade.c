@@ -310,3 +310,83 @@ void SystemCascade_adopt_after_match() {
 
     ecs_fini(world);
 }
+
+void SystemCascade_reparent_container_after_match() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, AddParent, EcsOnUpdate, Position, CASCADE.Position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {1, 2});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {1, 2});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {1, 2});
+
+    ecs_adopt(world, e_3, e_2);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    /* Moving e_2 changes the depth of the table of e_3, which does not have
+     * e_1 in its type */
+    ecs_adopt(world, e_2, e_1);
+
+    ctx = (SysTestData){0};
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 3);
+    test_int(ctx.invoked, 3);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+    test_int(ctx.e[2], e_3);
+
+    Position *p = ecs_get_ptr(world, e_2, Position);
+    test_int(p->x, 2);
+    test_int(p->y, 4);
+
+    p = ecs_get_ptr(world, e_3, Position);
+    test_int(p->x, 4);
+    test_int(p->y, 8);
+
+    ecs_fini(world);
+}
+
+void SystemCascade_add_unrelated_to_container() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, AddParent, EcsOnUpdate, Position, CASCADE.Position);
+
+    ecs_entity_t parent = ecs_set(world, 0, Position, {1, 2});
+    ecs_entity_t child = ecs_set(world, 0, Position, {1, 2});
+
+    ecs_adopt(world, child, parent);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    ecs_set(world, parent, Velocity, {0, 0});
+
+    ctx = (SysTestData){0};
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.count, 2);
+    test_int(ctx.invoked, 2);
+    test_int(ctx.e[0], parent);
+    test_int(ctx.e[1], child);
+    test_int(ctx.s[1][1], parent);
+
+    Position *p = ecs_get_ptr(world, child, Position);
+    test_int(p->x, 3);
+    test_int(p->y, 6);
+
+    ecs_fini(world);
+}
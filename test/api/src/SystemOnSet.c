@@ -340,3 +340,306 @@ void SystemOnSet_set_and_add_system() {
 
     test_assert(set_called);
 }
+
+void SystemOnSet_set_different_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Mass);
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TYPE(world, Type, Mass, Position, Velocity);
+
+    ECS_SYSTEM(world, OnSet, EcsOnSet, Position, ?Velocity);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    /* Columns of the system map to different table columns for each entity */
+    ecs_entity_t e_1 = ecs_new(world, Position);
+    ecs_entity_t e_2 = ecs_new(world, Type);
+    ecs_set(world, e_2, Mass, {50});
+
+    ecs_set(world, e_1, Position, {10, 20});
+    ecs_set(world, e_2, Position, {30, 40});
+
+    test_int(ctx.invoked, 2);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_2);
+
+    Position *p = ecs_get_ptr(world, e_1, Position);
+    test_int(p->x, 11);
+    test_int(p->y, 20);
+
+    p = ecs_get_ptr(world, e_2, Position);
+    test_int(p->x, 31);
+    test_int(p->y, 40);
+
+    Velocity *v = ecs_get_ptr(world, e_2, Velocity);
+    test_int(v->x, 31);
+    test_int(v->y, 40);
+
+    test_int(ecs_get(world, e_2, Mass), 50);
+
+    ecs_fini(world);
+}
+
+void SystemOnSet_defer_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, OnSet, EcsOnSet, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_set_defer_events(world, true);
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i * 10, i});
+    }
+
+    /* Entity is only notified once */
+    ecs_set(world, e[2], Position, {20, 2});
+
+    test_int(ctx.invoked, 0);
+
+    ecs_flush_events(world);
+
+    /* Entities are stored in adjacent rows, and notified in one invocation */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 4);
+
+    for (i = 0; i < 4; i ++) {
+        test_int(ctx.e[i], e[i]);
+
+        Position *p = ecs_get_ptr(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i * 10 + 1);
+        test_int(p->y, i);
+    }
+
+    /* Queue is empty after flush */
+    ecs_flush_events(world);
+    test_int(ctx.invoked, 1);
+
+    ecs_fini(world);
+}
+
+void SystemOnSet_defer_set_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, OnSet, EcsOnSet, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_set_defer_events(world, true);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {50, 60});
+
+    /* Deleted entity is not notified, moved entity is notified in new table */
+    ecs_delete(world, e_2);
+    ecs_add(world, e_3, Velocity);
+
+    ecs_flush_events(world);
+
+    test_int(ctx.invoked, 2);
+    test_int(ctx.count, 2);
+    test_int(ctx.e[0], e_1);
+    test_int(ctx.e[1], e_3);
+
+    test_int(ecs_get(world, e_1, Position).x, 11);
+    test_int(ecs_get(world, e_3, Position).x, 51);
+
+    ecs_fini(world);
+}
+
+void SystemOnSet_defer_set_flush_on_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, OnSet, EcsOnSet, Position);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_set_defer_events(world, true);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {30, 40});
+    test_int(ctx.invoked, 0);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 2);
+    test_int(ecs_get(world, e_1, Position).x, 11);
+    test_int(ecs_get(world, e_2, Position).x, 31);
+
+    /* Disabling deferring delivers queued notifications */
+    ecs_set(world, e_1, Position, {10, 20});
+    test_int(ctx.invoked, 1);
+
+    ecs_set_defer_events(world, false);
+    test_int(ctx.invoked, 2);
+    test_int(ecs_get(world, e_1, Position).x, 11);
+
+    /* Notifications are no longer deferred */
+    ecs_set(world, e_2, Position, {30, 40});
+    test_int(ctx.invoked, 3);
+
+    ecs_fini(world);
+}
+
+void SystemOnSet_defer_clone_w_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, OnSet, EcsOnSet, Position);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_set_defer_events(world, true);
+
+    /* A clone with value is queued like a set */
+    ecs_entity_t clone = ecs_clone(world, e, true);
+    test_int(ctx.invoked, 0);
+
+    Position *p = ecs_get_ptr(world, clone, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 11);
+
+    ecs_flush_events(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.e[0], clone);
+
+    p = ecs_get_ptr(world, clone, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 12);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+static
+void SetVelocity(ecs_rows_t *rows) {
+    Position *p = ecs_column(rows, Position, 1);
+    ECS_COLUMN_COMPONENT(rows, Velocity, 2);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        ecs_set(rows->world, rows->entities[i], Velocity, {p[i].x, p[i].y});
+    }
+}
+
+static
+void OnSetVelocity(ecs_rows_t *rows) {
+    Velocity *v = ecs_column(rows, Velocity, 1);
+
+    ProbeSystem(rows);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        v[i].x ++;
+    }
+}
+
+static int set_velocity_invoked;
+
+static
+void TestInvoked(ecs_rows_t *rows) {
+    SysTestData *ctx = ecs_get_context(rows->world);
+    set_velocity_invoked = ctx->invoked;
+}
+
+void SystemOnSet_defer_set_in_progress() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, SetVelocity, EcsOnUpdate, Position, ID.Velocity);
+    ECS_SYSTEM(world, OnSetVelocity, EcsOnSet, Velocity);
+    ECS_SYSTEM(world, TestInvoked, EcsPostUpdate, Position);
+
+    set_velocity_invoked = -1;
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i * 10, i});
+    }
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_set_defer_events(world, true);
+
+    ecs_progress(world, 1);
+
+    /* Notifications are delivered after the merge of the phase, before the
+     * next phase runs */
+    test_int(set_velocity_invoked, 1);
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 4);
+
+    for (i = 0; i < 4; i ++) {
+        Velocity *v = ecs_get_ptr(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i * 10 + 1);
+        test_int(v->y, i);
+    }
+
+    ecs_fini(world);
+}
+
+void SystemOnSet_defer_set_in_progress_w_threads() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_SYSTEM(world, SetVelocity, EcsOnUpdate, Position, ID.Velocity);
+    ECS_SYSTEM(world, OnSetVelocity, EcsOnSet, Velocity);
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i * 10, i});
+    }
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_set_threads(world, 2);
+    ecs_set_defer_events(world, true);
+
+    ecs_progress(world, 1);
+
+    /* Notifications of both worker stages are delivered by the main thread */
+    test_int(ctx.count, 10);
+
+    for (i = 0; i < 10; i ++) {
+        Velocity *v = ecs_get_ptr(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i * 10 + 1);
+        test_int(v->y, i);
+    }
+
+    ecs_fini(world);
+}
@@ -0,0 +1,209 @@
+#include <include/api.h>
+
+static
+void Iter(ecs_rows_t *rows) {
+    Position *p = ecs_column(rows, Position, 1);
+
+    ProbeSystem(rows);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+void TableGC_delete_empty_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    test_assert(e != 0);
+
+    ecs_delete(world, e);
+    ecs_gc(world);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 0);
+    test_int(ctx.count, 0);
+
+    ecs_fini(world);
+}
+
+void TableGC_delete_moves_last_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e_1 = ecs_new(world, Position);
+    ecs_entity_t e_2 = ecs_new(world, Velocity);
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, e_3, Mass);
+
+    /* Delete tables that were created before the table of e_3 */
+    ecs_delete(world, e_1);
+    ecs_delete(world, e_2);
+    ecs_gc(world);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.e[0], e_3);
+
+    test_assert(ecs_has(world, e_3, Position));
+    test_assert(ecs_has(world, e_3, Mass));
+    test_int(ecs_get(world, e_3, Position).x, 11);
+    test_int(ecs_get(world, e_3, Position).y, 20);
+
+    /* Deleting the last entity of the moved table must still deactivate it */
+    ecs_delete(world, e_3);
+    ctx = (SysTestData){0};
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 0);
+
+    ecs_fini(world);
+}
+
+void TableGC_recreate_deleted_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_entity_t e_1 = ecs_new(world, Position);
+    ecs_delete(world, e_1);
+    ecs_gc(world);
+
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {1, 2});
+    ecs_entity_t e_3 = ecs_new(world, Velocity);
+    test_assert(e_3 != 0);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 1);
+    test_int(ctx.e[0], e_2);
+    test_int(ecs_get(world, e_2, Position).x, 2);
+
+    ecs_fini(world);
+}
+
+void TableGC_collect_after_frames() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_table_gc(world, 2);
+
+    ecs_entity_t e_1 = ecs_new(world, Position);
+    ecs_entity_t e_2 = ecs_new(world, Velocity);
+    ecs_entity_t e_3 = ecs_set(world, 0, Position, {0, 0});
+    ecs_add(world, e_3, Velocity);
+
+    ecs_delete(world, e_1);
+    ecs_delete(world, e_2);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    int i;
+    for (i = 0; i < 5; i ++) {
+        ecs_progress(world, 1);
+    }
+
+    test_int(ctx.invoked, 5);
+    test_int(ctx.count, 5);
+    test_int(ctx.e[0], e_3);
+    test_int(ctx.e[4], e_3);
+    test_int(ecs_get(world, e_3, Position).x, 5);
+
+    /* Tables were collected, make sure they are recreated & rematched */
+    ecs_entity_t e_4 = ecs_new(world, Position);
+
+    ctx = (SysTestData){0};
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 2);
+    test_int(ctx.count, 2);
+    test_assert(ctx.e[0] == e_4 || ctx.e[1] == e_4);
+
+    ecs_fini(world);
+}
+
+void TableGC_keep_recently_used_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_table_gc(world, 100);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    /* Table oscillates around empty */
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {i, 0});
+        ecs_progress(world, 1);
+        test_int(ecs_get(world, e, Position).x, i + 1);
+        ecs_delete(world, e);
+    }
+
+    test_int(ctx.invoked, 10);
+    test_int(ctx.count, 10);
+
+    ecs_fini(world);
+}
+
+void TableGC_reclaim_preserves_data() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TYPE(world, Type, Position);
+
+    ecs_dim_type(world, Type, 1000);
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_gc(world);
+
+    for (i = 0; i < 10; i ++) {
+        test_int(ecs_get(world, e[i], Position).x, i);
+        test_int(ecs_get(world, e[i], Position).y, i * 2);
+    }
+
+    /* Table must be able to grow after it was reclaimed */
+    ecs_entity_t e_11 = ecs_set(world, 0, Position, {10, 20});
+    test_int(ecs_get(world, e_11, Position).x, 10);
+
+    for (i = 0; i < 10; i ++) {
+        test_int(ecs_get(world, e[i], Position).x, i);
+    }
+
+    ecs_fini(world);
+}
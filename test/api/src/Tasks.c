@@ -132,3 +132,88 @@ void Tasks_on_remove_from_system() {
     test_int(ctx.column_count, 1);
     test_int(ctx.c[0][0], ecs_to_entity(Position));
 }
+
+static
+void AddVelocity(ecs_rows_t *rows) {
+    ECS_COLUMN_COMPONENT(rows, Velocity, 1);
+    ecs_set(rows->world, rows->system, Velocity, {1, 2});
+}
+
+void Tasks_parallel() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Velocity);
+
+    const char *ids[] = {"T1", "T2", "T3", "T4", "T5", "T6", "T7", "T8"};
+    ecs_entity_t tasks[8];
+    int i;
+    for (i = 0; i < 8; i ++) {
+        tasks[i] = ecs_new_system(
+            world, ids[i], EcsOnUpdate, "ID.Velocity", AddVelocity);
+        ecs_set_task_parallel(world, tasks[i], true);
+    }
+
+    ecs_set_threads(world, 4);
+
+    ecs_progress(world, 1);
+
+    /* Components set from worker stages are merged after the tasks ran */
+    for (i = 0; i < 8; i ++) {
+        test_assert(ecs_has(world, tasks[i], Velocity));
+        Velocity *v = ecs_get_ptr(world, tasks[i], Velocity);
+        test_int(v->x, 1);
+        test_int(v->y, 2);
+    }
+
+    ecs_fini(world);
+}
+
+static int task_first_ran;
+static int task_second_ran;
+static bool task_order_ok;
+
+static
+void TaskFirst(ecs_rows_t *rows) {
+    task_first_ran ++;
+}
+
+static
+void TaskSecond(ecs_rows_t *rows) {
+    task_order_ok = task_first_ran == task_second_ran + 1;
+    task_second_ran ++;
+}
+
+static
+void TaskSequential(ecs_rows_t *rows) {
+    /* Runs after parallel tasks created before it have finished */
+    task_order_ok = task_order_ok && task_second_ran == task_first_ran;
+}
+
+void Tasks_parallel_conflict() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_SYSTEM(world, TaskFirst, EcsOnUpdate, 0);
+    ECS_SYSTEM(world, TaskSecond, EcsOnUpdate, 0);
+    ECS_SYSTEM(world, TaskSequential, EcsOnUpdate, 0);
+
+    ecs_set_task_parallel(world, TaskFirst, true);
+    ecs_set_task_parallel(world, TaskSecond, true);
+    ecs_set_task_conflict(world, TaskFirst, TaskSecond);
+
+    ecs_set_threads(world, 4);
+
+    task_first_ran = 0;
+    task_second_ran = 0;
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        task_order_ok = false;
+        ecs_progress(world, 1);
+        test_assert(task_order_ok);
+    }
+
+    test_int(task_first_ran, 10);
+    test_int(task_second_ran, 10);
+
+    ecs_fini(world);
+}
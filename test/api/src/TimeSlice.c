@@ -0,0 +1,143 @@
+#include <include/api.h>
+
+static
+void Iter(ecs_rows_t *rows) {
+    ProbeSystem(rows);
+}
+
+static
+void Visit(ecs_rows_t *rows) {
+    ECS_COLUMN(rows, Position, p, 1);
+
+    int i;
+    for (i = 0; i < rows->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+void TimeSlice_visit_once() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_time_slice(world, Iter, 5);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        if (i % 2) {
+            ecs_add(world, e, Velocity);
+        }
+    }
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    for (i = 0; i < 5; i ++) {
+        uint32_t count = ctx.count;
+        ecs_progress(world, 1);
+        test_int(ctx.count - count, 2);
+    }
+
+    /* Each entity is visited once per cycle */
+    int j;
+    for (i = 0; i < 10; i ++) {
+        for (j = i + 1; j < 10; j ++) {
+            test_assert(ctx.e[i] != ctx.e[j]);
+        }
+    }
+
+    /* Next cycle starts from the first row */
+    ecs_progress(world, 1);
+    test_int(ctx.count, 12);
+    test_int(ctx.e[10], ctx.e[0]);
+    test_int(ctx.e[11], ctx.e[1]);
+
+    ecs_fini(world);
+}
+
+void TimeSlice_rows_added() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_time_slice(world, Iter, 3);
+
+    ecs_new_w_count(world, Position, 6);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 2);
+
+    /* Slice grows with the rows of the system */
+    ecs_new_w_count(world, Position, 6);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 6);
+
+    ecs_fini(world);
+}
+
+void TimeSlice_rows_removed() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Iter, EcsOnUpdate, Position);
+
+    ecs_set_time_slice(world, Iter, 2);
+
+    ecs_entity_t e = ecs_new_w_count(world, Position, 8);
+
+    SysTestData ctx = {0};
+    ecs_set_context(world, &ctx);
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 4);
+    test_int(ctx.e[0], e);
+
+    /* Cursor is past the last row, start from the first row */
+    int i;
+    for (i = 4; i < 8; i ++) {
+        ecs_delete(world, e + i);
+    }
+
+    ecs_progress(world, 1);
+    test_int(ctx.count, 6);
+    test_int(ctx.e[4], e);
+    test_int(ctx.e[5], e + 1);
+
+    ecs_fini(world);
+}
+
+void TimeSlice_w_threads() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_SYSTEM(world, Visit, EcsOnUpdate, Position);
+
+    ecs_set_time_slice(world, Visit, 4);
+    ecs_set_threads(world, 2);
+
+    ecs_entity_t e = ecs_new_w_count(world, Position, 20);
+
+    int i;
+    for (i = 0; i < 20; i ++) {
+        ecs_set(world, e + i, Position, {0, 0});
+    }
+
+    for (i = 0; i < 4; i ++) {
+        ecs_progress(world, 1);
+    }
+
+    for (i = 0; i < 20; i ++) {
+        Position *p = ecs_get_ptr(world, e + i, Position);
+        test_int(p->x, 1);
+    }
+
+    ecs_fini(world);
+}
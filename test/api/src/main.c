@@ -137,6 +137,14 @@ void Set_set_and_new(void);
 void Singleton_set(void);
 void Singleton_set_ptr(void);
 void Singleton_system_w_singleton(void);
+void Singleton_get_not_set(void);
+void Singleton_set_twice(void);
+void Singleton_set_in_progress(void);
+void Singleton_add(void);
+void Singleton_has(void);
+void Singleton_on_set(void);
+void Singleton_remove(void);
+void Singleton_slots_system_w_singleton(void);
 
 // Testsuite 'Clone'
 void Clone_empty(void);
@@ -153,6 +161,9 @@ void Clone_tag(void);
 void Clone_tag_w_value(void);
 void Clone_1_tag_1_component(void);
 void Clone_1_tag_1_component_w_value(void);
+void Clone_w_count(void);
+void Clone_w_count_w_value(void);
+void Clone_w_count_w_value_on_set(void);
 
 // Testsuite 'SystemOnAdd'
 void SystemOnAdd_new_match_1_of_1(void);
@@ -202,6 +213,13 @@ void SystemOnSet_clone(void);
 void SystemOnSet_clone_w_value(void);
 void SystemOnSet_set_w_optional(void);
 void SystemOnSet_set_and_add_system(void);
+void SystemOnSet_set_different_tables(void);
+void SystemOnSet_defer_set(void);
+void SystemOnSet_defer_set_delete(void);
+void SystemOnSet_defer_set_flush_on_progress(void);
+void SystemOnSet_defer_clone_w_value(void);
+void SystemOnSet_defer_set_in_progress(void);
+void SystemOnSet_defer_set_in_progress_w_threads(void);
 
 // Testsuite 'SystemOnFrame'
 void SystemOnFrame_1_type_1_component(void);
@@ -232,6 +250,8 @@ void SystemCascade_cascade_depth_1(void);
 void SystemCascade_cascade_depth_2(void);
 void SystemCascade_add_after_match(void);
 void SystemCascade_adopt_after_match(void);
+void SystemCascade_reparent_container_after_match(void);
+void SystemCascade_add_unrelated_to_container(void);
 
 // Testsuite 'SystemManual'
 void SystemManual_1_type_1_component(void);
@@ -243,6 +263,8 @@ void Tasks_from_system(void);
 void Tasks_on_remove_no_components(void);
 void Tasks_on_remove_one_tag(void);
 void Tasks_on_remove_from_system(void);
+void Tasks_parallel(void);
+void Tasks_parallel_conflict(void);
 
 // Testsuite 'Container'
 void Container_child(void);
@@ -287,6 +309,9 @@ void Prefab_prefab_in_system_expr(void);
 void Prefab_dont_match_prefab(void);
 void Prefab_new_w_count_w_override(void);
 void Prefab_override_2_components_different_size(void);
+void Prefab_get_ptr_after_prefab_moves(void);
+void Prefab_get_ptr_nested_prefab(void);
+void Prefab_new_w_count_nested_override(void);
 
 // Testsuite 'System_w_FromContainer'
 void System_w_FromContainer_1_column_from_container(void);
@@ -381,6 +406,18 @@ void MultiThread_3_thread_test_combs_100_entity_2_types(void);
 void MultiThread_4_thread_test_combs_100_entity_2_types(void);
 void MultiThread_5_thread_test_combs_100_entity_2_types(void);
 void MultiThread_6_thread_test_combs_100_entity_2_types(void);
+void MultiThread_4_thread_cascade_parent_column(void);
+void MultiThread_4_thread_cascade_container(void);
+void MultiThread_4_thread_add_after_schedule(void);
+void MultiThread_4_thread_delete_after_schedule(void);
+void MultiThread_4_thread_cost_schedule(void);
+void MultiThread_4_thread_async(void);
+void MultiThread_4_thread_async_w_progress(void);
+void MultiThread_async_no_threads(void);
+void MultiThread_external_scheduler(void);
+void MultiThread_external_scheduler_threads(void);
+void MultiThread_resize_threads(void);
+void MultiThread_4_thread_async_keeps_schedule(void);
 
 // Testsuite 'SingleThreadStaging'
 void SingleThreadStaging_new_empty(void);
@@ -463,6 +500,85 @@ void Internals_activate_table(void);
 void Internals_activate_deactivate_table(void);
 void Internals_activate_deactivate_reactive(void);
 void Internals_activate_deactivate_activate_other(void);
+void Internals_systems_move_in_storage(void);
+void Internals_row_systems_move_in_storage(void);
+
+// Testsuite 'OsApi'
+void OsApi_advise_large_column(void);
+void OsApi_advise_small_column(void);
+void OsApi_thread_affinity(void);
+void OsApi_advise_large_column_worker(void);
+
+// Testsuite 'TableGC'
+void TableGC_delete_empty_table(void);
+void TableGC_delete_moves_last_table(void);
+void TableGC_recreate_deleted_table(void);
+void TableGC_collect_after_frames(void);
+void TableGC_keep_recently_used_table(void);
+void TableGC_reclaim_preserves_data(void);
+
+// Testsuite 'EnableEntity'
+void EnableEntity_disable(void);
+void EnableEntity_enable(void);
+void EnableEntity_disable_all(void);
+void EnableEntity_disable_after_add(void);
+void EnableEntity_delete_disabled(void);
+void EnableEntity_disable_in_progress(void);
+
+// Testsuite 'Hierarchy'
+void Hierarchy_set_parent(void);
+void Hierarchy_children_share_table(void);
+void Hierarchy_change_parent(void);
+void Hierarchy_remove_parent(void);
+void Hierarchy_delete_child(void);
+void Hierarchy_delete_parent(void);
+void Hierarchy_container_column(void);
+void Hierarchy_cascade(void);
+void Hierarchy_sort_keeps_data(void);
+void Hierarchy_delete_parent_wo_components(void);
+void Hierarchy_clone_child(void);
+void Hierarchy_clone_child_w_count(void);
+void Hierarchy_clone_child_in_progress(void);
+
+// Testsuite 'Query'
+void Query_iter(void);
+void Query_match_new_table(void);
+void Query_table_gc(void);
+void Query_shared_from_prefab(void);
+
+// Testsuite 'Sorting'
+void Sorting_system(void);
+void Sorting_system_after_set(void);
+void Sorting_system_w_disabled(void);
+void Sorting_query(void);
+void Sorting_query_in_progress(void);
+
+// Testsuite 'Defragment'
+void Defragment_entity_order(void);
+void Defragment_order_by_component(void);
+void Defragment_w_sorted_system(void);
+void Defragment_progress(void);
+void Defragment_unset_order_by(void);
+void Defragment_free_sorted_query(void);
+
+// Testsuite 'TimeSlice'
+void TimeSlice_visit_once(void);
+void TimeSlice_rows_added(void);
+void TimeSlice_rows_removed(void);
+void TimeSlice_w_threads(void);
+
+// Testsuite 'FrameBudget'
+void FrameBudget_skip_deferrable(void);
+void FrameBudget_run_mandatory(void);
+void FrameBudget_skip_deferrable_w_threads(void);
+void FrameBudget_target_fps(void);
+void FrameBudget_target_fps_w_app_time(void);
+
+// Testsuite 'Pipelined'
+void Pipelined_store_copy(void);
+void Pipelined_disabled_rows(void);
+void Pipelined_shared_component(void);
+void Pipelined_container_on_main_thread(void);
 
 static bake_test_suite suites[] = {
     {
@@ -951,7 +1067,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "Singleton",
-        .testcase_count = 3,
+        .testcase_count = 11,
         .testcases = (bake_test_case[]){
             {
                 .id = "set",
@@ -964,12 +1080,44 @@ static bake_test_suite suites[] = {
             {
                 .id = "system_w_singleton",
                 .function = Singleton_system_w_singleton
+            },
+            {
+                .id = "get_not_set",
+                .function = Singleton_get_not_set
+            },
+            {
+                .id = "set_twice",
+                .function = Singleton_set_twice
+            },
+            {
+                .id = "set_in_progress",
+                .function = Singleton_set_in_progress
+            },
+            {
+                .id = "add",
+                .function = Singleton_add
+            },
+            {
+                .id = "has",
+                .function = Singleton_has
+            },
+            {
+                .id = "on_set",
+                .function = Singleton_on_set
+            },
+            {
+                .id = "remove",
+                .function = Singleton_remove
+            },
+            {
+                .id = "slots_system_w_singleton",
+                .function = Singleton_slots_system_w_singleton
             }
         }
     },
     {
         .id = "Clone",
-        .testcase_count = 14,
+        .testcase_count = 17,
         .testcases = (bake_test_case[]){
             {
                 .id = "empty",
@@ -1026,6 +1174,18 @@ static bake_test_suite suites[] = {
             {
                 .id = "1_tag_1_component_w_value",
                 .function = Clone_1_tag_1_component_w_value
+            },
+            {
+                .id = "w_count",
+                .function = Clone_w_count
+            },
+            {
+                .id = "w_count_w_value",
+                .function = Clone_w_count_w_value
+            },
+            {
+                .id = "w_count_w_value_on_set",
+                .function = Clone_w_count_w_value_on_set
             }
         }
     },
@@ -1187,7 +1347,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "SystemOnSet",
-        .testcase_count = 7,
+        .testcase_count = 14,
         .testcases = (bake_test_case[]){
             {
                 .id = "set",
@@ -1216,6 +1376,34 @@ static bake_test_suite suites[] = {
             {
                 .id = "set_and_add_system",
                 .function = SystemOnSet_set_and_add_system
+            },
+            {
+                .id = "set_different_tables",
+                .function = SystemOnSet_set_different_tables
+            },
+            {
+                .id = "defer_set",
+                .function = SystemOnSet_defer_set
+            },
+            {
+                .id = "defer_set_delete",
+                .function = SystemOnSet_defer_set_delete
+            },
+            {
+                .id = "defer_set_flush_on_progress",
+                .function = SystemOnSet_defer_set_flush_on_progress
+            },
+            {
+                .id = "defer_clone_w_value",
+                .function = SystemOnSet_defer_clone_w_value
+            },
+            {
+                .id = "defer_set_in_progress",
+                .function = SystemOnSet_defer_set_in_progress
+            },
+            {
+                .id = "defer_set_in_progress_w_threads",
+                .function = SystemOnSet_defer_set_in_progress_w_threads
             }
         }
     },
@@ -1315,7 +1503,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "SystemCascade",
-        .testcase_count = 4,
+        .testcase_count = 6,
         .testcases = (bake_test_case[]){
             {
                 .id = "cascade_depth_1",
@@ -1332,6 +1520,14 @@ static bake_test_suite suites[] = {
             {
                 .id = "adopt_after_match",
                 .function = SystemCascade_adopt_after_match
+            },
+            {
+                .id = "reparent_container_after_match",
+                .function = SystemCascade_reparent_container_after_match
+            },
+            {
+                .id = "add_unrelated_to_container",
+                .function = SystemCascade_add_unrelated_to_container
             }
         }
     },
@@ -1347,7 +1543,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "Tasks",
-        .testcase_count = 6,
+        .testcase_count = 8,
         .testcases = (bake_test_case[]){
             {
                 .id = "no_components",
@@ -1372,6 +1568,14 @@ static bake_test_suite suites[] = {
             {
                 .id = "on_remove_from_system",
                 .function = Tasks_on_remove_from_system
+            },
+            {
+                .id = "parallel",
+                .function = Tasks_parallel
+            },
+            {
+                .id = "parallel_conflict",
+                .function = Tasks_parallel_conflict
             }
         }
     },
@@ -1455,7 +1659,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "Prefab",
-        .testcase_count = 22,
+        .testcase_count = 25,
         .testcases = (bake_test_case[]){
             {
                 .id = "new_w_prefab",
@@ -1544,6 +1748,18 @@ static bake_test_suite suites[] = {
             {
                 .id = "override_2_components_different_size",
                 .function = Prefab_override_2_components_different_size
+            },
+            {
+                .id = "get_ptr_after_prefab_moves",
+                .function = Prefab_get_ptr_after_prefab_moves
+            },
+            {
+                .id = "get_ptr_nested_prefab",
+                .function = Prefab_get_ptr_nested_prefab
+            },
+            {
+                .id = "new_w_count_nested_override",
+                .function = Prefab_new_w_count_nested_override
             }
         }
     },
@@ -1785,7 +2001,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "MultiThread",
-        .testcase_count = 30,
+        .testcase_count = 42,
         .testcases = (bake_test_case[]){
             {
                 .id = "2_thread_1_entity",
@@ -1906,6 +2122,54 @@ static bake_test_suite suites[] = {
             {
                 .id = "6_thread_test_combs_100_entity_2_types",
                 .function = MultiThread_6_thread_test_combs_100_entity_2_types
+            },
+            {
+                .id = "4_thread_cascade_parent_column",
+                .function = MultiThread_4_thread_cascade_parent_column
+            },
+            {
+                .id = "4_thread_cascade_container",
+                .function = MultiThread_4_thread_cascade_container
+            },
+            {
+                .id = "4_thread_add_after_schedule",
+                .function = MultiThread_4_thread_add_after_schedule
+            },
+            {
+                .id = "4_thread_delete_after_schedule",
+                .function = MultiThread_4_thread_delete_after_schedule
+            },
+            {
+                .id = "4_thread_cost_schedule",
+                .function = MultiThread_4_thread_cost_schedule
+            },
+            {
+                .id = "4_thread_async",
+                .function = MultiThread_4_thread_async
+            },
+            {
+                .id = "4_thread_async_w_progress",
+                .function = MultiThread_4_thread_async_w_progress
+            },
+            {
+                .id = "async_no_threads",
+                .function = MultiThread_async_no_threads
+            },
+            {
+                .id = "external_scheduler",
+                .function = MultiThread_external_scheduler
+            },
+            {
+                .id = "external_scheduler_threads",
+                .function = MultiThread_external_scheduler_threads
+            },
+            {
+                .id = "resize_threads",
+                .function = MultiThread_resize_threads
+            },
+            {
+                .id = "4_thread_async_keeps_schedule",
+                .function = MultiThread_4_thread_async_keeps_schedule
             }
         }
     },
@@ -2205,7 +2469,7 @@ static bake_test_suite suites[] = {
     },
     {
         .id = "Internals",
-        .testcase_count = 5,
+        .testcase_count = 7,
         .testcases = (bake_test_case[]){
             {
                 .id = "deactivate_table",
@@ -2226,6 +2490,302 @@ static bake_test_suite suites[] = {
             {
                 .id = "activate_deactivate_activate_other",
                 .function = Internals_activate_deactivate_activate_other
+            },
+            {
+                .id = "systems_move_in_storage",
+                .function = Internals_systems_move_in_storage
+            },
+            {
+                .id = "row_systems_move_in_storage",
+                .function = Internals_row_systems_move_in_storage
+            }
+        }
+    },
+    {
+        .id = "OsApi",
+        .testcase_count = 4,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "advise_large_column",
+                .function = OsApi_advise_large_column
+            },
+            {
+                .id = "advise_small_column",
+                .function = OsApi_advise_small_column
+            },
+            {
+                .id = "thread_affinity",
+                .function = OsApi_thread_affinity
+            },
+            {
+                .id = "advise_large_column_worker",
+                .function = OsApi_advise_large_column_worker
+            }
+        }
+    },
+    {
+        .id = "TableGC",
+        .testcase_count = 6,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "delete_empty_table",
+                .function = TableGC_delete_empty_table
+            },
+            {
+                .id = "delete_moves_last_table",
+                .function = TableGC_delete_moves_last_table
+            },
+            {
+                .id = "recreate_deleted_table",
+                .function = TableGC_recreate_deleted_table
+            },
+            {
+                .id = "collect_after_frames",
+                .function = TableGC_collect_after_frames
+            },
+            {
+                .id = "keep_recently_used_table",
+                .function = TableGC_keep_recently_used_table
+            },
+            {
+                .id = "reclaim_preserves_data",
+                .function = TableGC_reclaim_preserves_data
+            }
+        }
+    },
+    {
+        .id = "EnableEntity",
+        .testcase_count = 6,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "disable",
+                .function = EnableEntity_disable
+            },
+            {
+                .id = "enable",
+                .function = EnableEntity_enable
+            },
+            {
+                .id = "disable_all",
+                .function = EnableEntity_disable_all
+            },
+            {
+                .id = "disable_after_add",
+                .function = EnableEntity_disable_after_add
+            },
+            {
+                .id = "delete_disabled",
+                .function = EnableEntity_delete_disabled
+            },
+            {
+                .id = "disable_in_progress",
+                .function = EnableEntity_disable_in_progress
+            }
+        }
+    },
+    {
+        .id = "Hierarchy",
+        .testcase_count = 13,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "set_parent",
+                .function = Hierarchy_set_parent
+            },
+            {
+                .id = "children_share_table",
+                .function = Hierarchy_children_share_table
+            },
+            {
+                .id = "change_parent",
+                .function = Hierarchy_change_parent
+            },
+            {
+                .id = "remove_parent",
+                .function = Hierarchy_remove_parent
+            },
+            {
+                .id = "delete_child",
+                .function = Hierarchy_delete_child
+            },
+            {
+                .id = "delete_parent",
+                .function = Hierarchy_delete_parent
+            },
+            {
+                .id = "container_column",
+                .function = Hierarchy_container_column
+            },
+            {
+                .id = "cascade",
+                .function = Hierarchy_cascade
+            },
+            {
+                .id = "sort_keeps_data",
+                .function = Hierarchy_sort_keeps_data
+            },
+            {
+                .id = "delete_parent_wo_components",
+                .function = Hierarchy_delete_parent_wo_components
+            },
+            {
+                .id = "clone_child",
+                .function = Hierarchy_clone_child
+            },
+            {
+                .id = "clone_child_w_count",
+                .function = Hierarchy_clone_child_w_count
+            },
+            {
+                .id = "clone_child_in_progress",
+                .function = Hierarchy_clone_child_in_progress
+            }
+        }
+    },
+    {
+        .id = "Query",
+        .testcase_count = 4,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "iter",
+                .function = Query_iter
+            },
+            {
+                .id = "match_new_table",
+                .function = Query_match_new_table
+            },
+            {
+                .id = "table_gc",
+                .function = Query_table_gc
+            },
+            {
+                .id = "shared_from_prefab",
+                .function = Query_shared_from_prefab
+            }
+        }
+    },
+    {
+        .id = "Sorting",
+        .testcase_count = 5,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "system",
+                .function = Sorting_system
+            },
+            {
+                .id = "system_after_set",
+                .function = Sorting_system_after_set
+            },
+            {
+                .id = "system_w_disabled",
+                .function = Sorting_system_w_disabled
+            },
+            {
+                .id = "query",
+                .function = Sorting_query
+            },
+            {
+                .id = "query_in_progress",
+                .function = Sorting_query_in_progress
+            }
+        }
+    },
+    {
+        .id = "Defragment",
+        .testcase_count = 6,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "entity_order",
+                .function = Defragment_entity_order
+            },
+            {
+                .id = "order_by_component",
+                .function = Defragment_order_by_component
+            },
+            {
+                .id = "w_sorted_system",
+                .function = Defragment_w_sorted_system
+            },
+            {
+                .id = "progress",
+                .function = Defragment_progress
+            },
+            {
+                .id = "unset_order_by",
+                .function = Defragment_unset_order_by
+            },
+            {
+                .id = "free_sorted_query",
+                .function = Defragment_free_sorted_query
+            }
+        }
+    },
+    {
+        .id = "TimeSlice",
+        .testcase_count = 4,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "visit_once",
+                .function = TimeSlice_visit_once
+            },
+            {
+                .id = "rows_added",
+                .function = TimeSlice_rows_added
+            },
+            {
+                .id = "rows_removed",
+                .function = TimeSlice_rows_removed
+            },
+            {
+                .id = "w_threads",
+                .function = TimeSlice_w_threads
+            }
+        }
+    },
+    {
+        .id = "FrameBudget",
+        .testcase_count = 5,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "skip_deferrable",
+                .function = FrameBudget_skip_deferrable
+            },
+            {
+                .id = "run_mandatory",
+                .function = FrameBudget_run_mandatory
+            },
+            {
+                .id = "skip_deferrable_w_threads",
+                .function = FrameBudget_skip_deferrable_w_threads
+            },
+            {
+                .id = "target_fps",
+                .function = FrameBudget_target_fps
+            },
+            {
+                .id = "target_fps_w_app_time",
+                .function = FrameBudget_target_fps_w_app_time
+            }
+        }
+    },
+    {
+        .id = "Pipelined",
+        .testcase_count = 4,
+        .testcases = (bake_test_case[]){
+            {
+                .id = "store_copy",
+                .function = Pipelined_store_copy
+            },
+            {
+                .id = "disabled_rows",
+                .function = Pipelined_disabled_rows
+            },
+            {
+                .id = "shared_component",
+                .function = Pipelined_shared_component
+            },
+            {
+                .id = "container_on_main_thread",
+                .function = Pipelined_container_on_main_thread
             }
         }
     }
@@ -2233,5 +2793,5 @@ static bake_test_suite suites[] = {
 
 int main(int argc, char *argv[]) {
     ut_init(argv[0]);
-    return bake_test_run("api", argc, argv, suites, 30);
+    return bake_test_run("api", argc, argv, suites, 40);
 }